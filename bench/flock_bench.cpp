@@ -0,0 +1,186 @@
+// Banc d'essai de la simulation du troupeau, sans fenêtre : scénarios à graine fixe
+// (1k à 1M boids) mesurés pour plusieurs nombres de threads. Affiche un tableau et
+// écrit un JSON stable, à comparer d'une version à l'autre.
+//
+//   flock_bench [--sizes 1000,10000] [--threads 1,2,4] [--steps 20] [--seed 42] [--output flock_bench.json]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "boid_soa.h"
+#include "flock_simulator.h"
+#include "random.h"
+#include "steering.h"
+#include "thread_pool.h"
+
+namespace {
+
+struct Options {
+    std::vector<std::size_t> sizes   = {1000, 10000, 100000, 1000000};
+    std::vector<unsigned>    threads = {};
+    int                      steps   = 20;
+    unsigned                 seed    = 42;
+    std::string              output  = "flock_bench.json";
+};
+
+struct Result {
+    std::size_t boids;
+    unsigned    threads;
+    int         steps;
+    double      seconds;
+    double      nsPerBoidStep;
+    double      pairsPerSecond; // Paires (boid, voisin candidat) examinées par la passe de voisinage
+    std::size_t memoryBytes;
+    double      speedup; // Par rapport au premier nombre de threads mesuré pour cette taille
+};
+
+template<typename T>
+std::vector<T> parseList(const std::string& text)
+{
+    std::vector<T>     values;
+    std::istringstream stream(text);
+    std::string        item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(static_cast<T>(std::stoull(item)));
+    }
+    return values;
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (argument == "--sizes") {
+            options.sizes = parseList<std::size_t>(value);
+        } else if (argument == "--threads") {
+            options.threads = parseList<unsigned>(value);
+        } else if (argument == "--steps") {
+            options.steps = std::max(1, std::stoi(value));
+        } else if (argument == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(value));
+        } else if (argument == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return false;
+        }
+    }
+    if (options.threads.empty()) {
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned count = 1; count < hardware; count *= 2) {
+            options.threads.push_back(count);
+        }
+        options.threads.push_back(hardware);
+    }
+    return true;
+}
+
+// Troupeau initial, identique pour une graine donnée. Le dôme grandit avec le nombre de
+// boids pour garder la densité de 1000 boids dans le dôme de rayon 2 de l'application.
+FlockParams spawnFlock(FlockSimulator& simulator, std::size_t count, unsigned seed)
+{
+    FlockParams params;
+    params.domeRadius     = 2.0f * std::cbrt(static_cast<float>(count) / 1000.0f);
+    params.cameraPosition = glm::vec3(0.0f, 0.0f, params.domeRadius * 3.0f);
+
+    seedRandom(seed);
+    simulator.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        Boid boid{};
+        boid.position    = glm::vec3(linearRand(-params.domeRadius, params.domeRadius), linearRand(-params.domeRadius, params.domeRadius),
+                                     linearRand(-params.domeRadius, params.domeRadius));
+        boid.velocity    = customSphericalRand(0.5f);
+        boid.isFemale    = (threadRandom().nextUint() % 2 == 0);
+        boid.markovState = 0;
+        boid.lifespan    = generateExp(1.0f / params.meanLifespan);
+        boid.markovTime  = generateStateChangeTime(1);
+        simulator.spawn(boid);
+    }
+    return params;
+}
+
+Result run(std::size_t count, unsigned threads, const Options& options)
+{
+    ThreadPool     pool(threads);
+    FlockSimulator simulator(pool);
+    simulator.params() = spawnFlock(simulator, count, options.seed);
+    simulator.setSeed(options.seed);
+
+    // Un pas d'échauffement : les tampons de travail sont alloués, les caches remplis
+    const float dt = 1.0f / 60.0f;
+    simulator.step(dt);
+
+    std::uint64_t pairs = simulator.candidatePairs();
+    auto          start = std::chrono::steady_clock::now();
+    for (int step = 0; step < options.steps; ++step) {
+        simulator.step(dt);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double boidSteps = static_cast<double>(count) * options.steps;
+    pairs            = simulator.candidatePairs() - pairs;
+    return {count, threads, options.steps, seconds, seconds * 1e9 / boidSteps, static_cast<double>(pairs) / seconds, simulator.memoryBytes(), 1.0};
+}
+
+void writeJson(std::ostream& out, const Options& options, const std::vector<Result>& results)
+{
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"steps\": " << options.steps << ",\n  \"kernels\": \"" << steeringKernels().name
+        << "\",\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i == 0 ? "" : ",") << "\n    {\"boids\": " << r.boids << ", \"threads\": " << r.threads << ", \"seconds\": " << r.seconds
+            << ", \"nsPerBoidStep\": " << r.nsPerBoidStep << ", \"pairsPerSecond\": " << r.pairsPerSecond
+            << ", \"memoryBytes\": " << r.memoryBytes << ", \"speedup\": " << r.speedup << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Steering kernels: %s\n", steeringKernels().name);
+    std::printf("%10s %8s %12s %14s %16s %12s %8s\n", "boids", "threads", "seconds", "ns/boid/step", "pairs/s", "memory (MB)", "speedup");
+    std::vector<Result> results;
+    for (std::size_t count : options.sizes) {
+        double baseline = 0.0;
+        for (unsigned threads : options.threads) {
+            Result result = run(count, threads, options);
+            if (baseline == 0.0) {
+                baseline = result.seconds;
+            }
+            result.speedup = baseline / result.seconds;
+            std::printf("%10zu %8u %12.3f %14.2f %16.0f %12.2f %8.2f\n", result.boids, result.threads, result.seconds, result.nsPerBoidStep,
+                        result.pairsPerSecond, result.memoryBytes / (1024.0 * 1024.0), result.speedup);
+            std::fflush(stdout);
+            results.push_back(result);
+        }
+    }
+
+    std::ofstream file(options.output);
+    writeJson(file, options, results);
+    if (!file) {
+        std::cerr << "Could not write " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::printf("Results written to %s\n", options.output.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+// Rejeu sans fenêtre d'une partie enregistrée avec `Simple-p6-Setup --record <journal>` :
+// refait les mêmes pas aussi vite que possible et compare les empreintes de l'état.
+// Sert à comparer deux versions sur une charge identique et à repérer une optimisation
+// qui change le résultat. Code de sortie 1 si le rejeu diverge.
+//
+//   flock_replay <journal> [--threads N] [--repeat N]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "flock_simulator.h"
+#include "simulation_log.h"
+#include "steering.h"
+#include "thread_pool.h"
+
+int main(int argc, char** argv)
+{
+    std::string path;
+    unsigned    threads = std::max(1u, std::thread::hardware_concurrency());
+    int         repeat  = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc) {
+            threads = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i])));
+        } else if (argument == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (path.empty() && argument.rfind("--", 0) != 0) {
+            path = argument;
+        } else {
+            std::cerr << "Usage: flock_replay <log> [--threads N] [--repeat N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: flock_replay <log> [--threads N] [--repeat N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    SimulationLogReader reader;
+    if (!reader.open(path.c_str())) {
+        std::cerr << "Could not read simulation log " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::printf("Log: seed %llu, %u species, checksum every %u steps, recorded with %s kernels\n",
+                static_cast<unsigned long long>(reader.header().seed), reader.header().speciesCount, reader.header().checksumInterval, reader.header().kernels);
+    if (std::strcmp(reader.header().kernels, steeringKernels().name) != 0) {
+        std::printf("Warning: replaying with %s kernels, checksums are not expected to match\n", steeringKernels().name);
+    }
+
+    ThreadPool pool(threads);
+    bool       ok = true;
+    for (int run = 0; run < repeat; ++run) {
+        if (run > 0 && !reader.open(path.c_str())) {
+            return EXIT_FAILURE;
+        }
+        FlockSimulator simulator(pool);
+        ReplayResult   result = replaySimulation(reader, simulator);
+
+        std::printf("Run %d: %llu steps in %.3f s (%.3f ms/step, %u threads), %llu/%llu checksums match", run + 1,
+                    static_cast<unsigned long long>(result.steps), result.seconds, result.steps > 0 ? result.seconds * 1e3 / result.steps : 0.0,
+                    threads, static_cast<unsigned long long>(result.checksums - result.mismatches), static_cast<unsigned long long>(result.checksums));
+        if (result.firstDivergence != ReplayResult::NO_DIVERGENCE) {
+            std::printf(", first divergence at step %llu", static_cast<unsigned long long>(result.firstDivergence));
+        }
+        std::printf("%s\n", result.truncated ? " (log is truncated)" : "");
+        ok = ok && result.ok();
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
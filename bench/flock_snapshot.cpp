@@ -0,0 +1,196 @@
+// Lecture des exports de l'état du troupeau (`Simple-p6-Setup --snapshot <fichier>`),
+// et mesure du débit d'écriture sur un troupeau synthétique.
+//
+//   flock_snapshot <fichier>                               résumé : frames, pas, compression
+//   flock_snapshot <fichier> --step N [--boids K]          frame du pas N (K premiers boids)
+//   flock_snapshot --benchmark <fichier> [--boids 1000000] [--steps 300] [--rate 60] [--threads 4] [--raw]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "boid_soa.h"
+#include "random.h"
+#include "snapshot_file.h"
+
+namespace {
+
+int printSummary(SnapshotReader& reader)
+{
+    std::printf("%zu frames", reader.frameCount());
+    if (reader.frameCount() > 0) {
+        std::printf(", steps %llu to %llu", static_cast<unsigned long long>(reader.stepAt(0)),
+                    static_cast<unsigned long long>(reader.stepAt(reader.frameCount() - 1)));
+    }
+    std::printf(", keyframe every %u frames, %.2f MB%s\n", reader.header().keyframeInterval, reader.fileSize() / (1024.0 * 1024.0),
+                reader.indexed() ? "" : " (no index: rebuilt by scanning)");
+    if (reader.frameCount() > 0) {
+        const SnapshotFrame* last = reader.read(reader.frameCount() - 1);
+        if (last == nullptr) {
+            std::cerr << "Corrupt frame" << std::endl;
+            return EXIT_FAILURE;
+        }
+        double raw = 0.0;
+        for (const auto& column : last->columns) {
+            raw += static_cast<double>(column.size());
+        }
+        std::printf("Last frame: %u boids, uncompressed %.2f MB per frame, file averages %.2f MB per frame\n", last->boidCount,
+                    raw / (1024.0 * 1024.0), reader.fileSize() / (1024.0 * 1024.0) / reader.frameCount());
+    }
+    return EXIT_SUCCESS;
+}
+
+int printStep(SnapshotReader& reader, std::uint64_t step, std::size_t boids)
+{
+    std::size_t index = reader.findStep(step);
+    if (index == SnapshotReader::NO_FRAME) {
+        std::cerr << "No frame at or before step " << step << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto                 start   = std::chrono::steady_clock::now();
+    const SnapshotFrame* frame   = reader.read(index);
+    double               seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (frame == nullptr) {
+        std::cerr << "Corrupt frame" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const float* px     = frame->column<float>(SnapshotColumn::PositionX);
+    const float* py     = frame->column<float>(SnapshotColumn::PositionY);
+    const float* pz     = frame->column<float>(SnapshotColumn::PositionZ);
+    const float* vx     = frame->column<float>(SnapshotColumn::VelocityX);
+    const float* vy     = frame->column<float>(SnapshotColumn::VelocityY);
+    const float* vz     = frame->column<float>(SnapshotColumn::VelocityZ);
+    const int*   markov = frame->column<int>(SnapshotColumn::MarkovState);
+    const auto*  female = frame->column<std::uint8_t>(SnapshotColumn::IsFemale);
+
+    std::size_t excited = std::count_if(markov, markov + frame->boidCount, [](int state) { return state != 0; });
+    std::printf("Step %llu (frame %zu, decoded in %.2f ms): %u boids, %zu in Markov state 1\n", static_cast<unsigned long long>(frame->step), index,
+                seconds * 1e3, frame->boidCount, excited);
+    std::printf("%8s %10s %10s %10s %10s %10s %10s %6s %6s\n", "boid", "px", "py", "pz", "vx", "vy", "vz", "markov", "female");
+    for (std::size_t i = 0; i < std::min<std::size_t>(boids, frame->boidCount); ++i) {
+        std::printf("%8zu %10.4f %10.4f %10.4f %10.4f %10.4f %10.4f %6d %6u\n", i, px[i], py[i], pz[i], vx[i], vy[i], vz[i], markov[i], female[i]);
+    }
+    return EXIT_SUCCESS;
+}
+
+// Troupeau synthétique en mouvement uniforme, soumis au rythme de la simulation : le
+// débit tient si aucun pas n'est abandonné
+int runBenchmark(const std::string& path, std::size_t count, int steps, float rate, const SnapshotOptions& options)
+{
+    BoidSoA    boids;
+    CounterRng rng(42, 0);
+    boids.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        Boid boid{};
+        boid.position    = glm::vec3(rng.uniform(-20.0f, 20.0f), rng.uniform(-20.0f, 20.0f), rng.uniform(-20.0f, 20.0f));
+        boid.velocity    = rng.onSphere(2.5f);
+        boid.isFemale    = rng.nextUint() % 2 == 0;
+        boid.markovState = static_cast<int>(rng.nextUint() % 2);
+        boids.pushBack(boid);
+    }
+
+    SnapshotWriter writer;
+    if (!writer.open(path, options)) {
+        std::cerr << "Could not write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    const float dt            = 1.0f / rate;
+    const auto  period        = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(dt));
+    auto        deadline      = std::chrono::steady_clock::now();
+    auto        start         = deadline;
+    double      submitSeconds = 0.0;
+    BoidStepBuffer back; // Comme FlockSimulator : intégration dans un tampon échangé avec les boids
+    for (int step = 0; step < steps; ++step) {
+        back.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            back.px[i] = boids.px[i] + boids.vx[i] * dt;
+            back.py[i] = boids.py[i] + boids.vy[i] * dt;
+            back.pz[i] = boids.pz[i] + boids.vz[i] * dt;
+        }
+        std::copy(boids.vx.begin(), boids.vx.end(), back.vx.begin());
+        std::copy(boids.vy.begin(), boids.vy.end(), back.vy.begin());
+        std::copy(boids.vz.begin(), boids.vz.end(), back.vz.begin());
+        std::copy(boids.markovState.begin(), boids.markovState.end(), back.markovState.begin());
+        std::copy(boids.isFemale.begin(), boids.isFemale.end(), back.isFemale.begin());
+        back.swapWith(boids);
+
+        // Le tampon garde l'état d'avant le pas, comme FlockSimulator::previousState
+        auto submitStart = std::chrono::steady_clock::now();
+        writer.submit(static_cast<std::uint64_t>(step), back);
+        submitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - submitStart).count();
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+    if (!writer.close()) {
+        std::cerr << "Write error on " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%zu boids at %.0f steps/s: %llu frames written, %llu dropped, submit %.2f ms/step\n", count, rate,
+                static_cast<unsigned long long>(writer.writtenFrames()), static_cast<unsigned long long>(writer.droppedFrames()),
+                submitSeconds * 1e3 / steps);
+    std::printf("%.1f MB written (%.1f MB uncompressed, ratio %.2f), %.1f MB/s to disk\n", writer.bytesWritten() / 1e6, writer.rawBytes() / 1e6,
+                static_cast<double>(writer.bytesWritten()) / std::max<std::uint64_t>(1, writer.rawBytes()), writer.bytesWritten() / 1e6 / seconds);
+    return writer.droppedFrames() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string     path;
+    bool            benchmark = false;
+    long long       step      = -1;
+    std::size_t     boids     = 0;
+    int             steps     = 300;
+    float           rate      = 60.0f;
+    SnapshotOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--benchmark" && i + 1 < argc) {
+            benchmark = true;
+            path      = argv[++i];
+        } else if (argument == "--step" && i + 1 < argc) {
+            step = std::stoll(argv[++i]);
+        } else if (argument == "--boids" && i + 1 < argc) {
+            boids = static_cast<std::size_t>(std::stoull(argv[++i]));
+        } else if (argument == "--steps" && i + 1 < argc) {
+            steps = std::max(1, std::stoi(argv[++i]));
+        } else if (argument == "--rate" && i + 1 < argc) {
+            rate = std::max(1.0f, std::stof(argv[++i]));
+        } else if (argument == "--threads" && i + 1 < argc) {
+            options.encoderThreads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (argument == "--raw") {
+            options.compress = false;
+        } else if (path.empty() && argument.rfind("--", 0) != 0) {
+            path = argument;
+        } else {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: flock_snapshot <file> [--step N] [--boids K] | --benchmark <file> [--boids N] [--steps N] [--rate R] [--threads N] [--raw]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (benchmark) {
+        return runBenchmark(path, boids > 0 ? boids : 1000000, steps, rate, options);
+    }
+
+    SnapshotReader reader;
+    if (!reader.open(path.c_str())) {
+        std::cerr << "Could not read snapshot file " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (step >= 0) {
+        return printStep(reader, static_cast<std::uint64_t>(step), boids > 0 ? boids : 10);
+    }
+    return printSummary(reader);
+}
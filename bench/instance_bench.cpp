@@ -0,0 +1,124 @@
+// Banc d'essai de la construction des attributs par instance des fantômes, sans fenêtre :
+// compare, pour un même troupeau, l'ancien calcul glm (translate * scale puis inverse
+// générale pour la matrice des normales), la forme close instance par instance, et le
+// constructeur par lots d'instance_transforms.h (positions SoA, ordre quelconque).
+//
+//   instance_bench [--sizes 1000,100000,1000000] [--repeat 20]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "instance_data.h"
+#include "instance_transforms.h"
+#include "random.h"
+
+namespace {
+
+struct Flock {
+    std::vector<float>         x, y, z;
+    std::vector<glm::vec3>     colors;
+    std::vector<std::uint32_t> order; // Ordre d'écriture mélangé, comme après le tri par niveau de détail
+};
+
+Flock makeFlock(std::size_t count)
+{
+    Flock      flock;
+    CounterRng rng(42, 0);
+    flock.x.resize(count);
+    flock.y.resize(count);
+    flock.z.resize(count);
+    flock.colors.resize(count);
+    flock.order.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        flock.x[i]      = rng.uniform(-20.0f, 20.0f);
+        flock.y[i]      = rng.uniform(-20.0f, 20.0f);
+        flock.z[i]      = rng.uniform(-20.0f, 20.0f);
+        flock.colors[i] = glm::vec3(1.0f, rng.uniform(0.0f, 1.0f), rng.uniform(0.0f, 1.0f));
+    }
+    std::iota(flock.order.begin(), flock.order.end(), 0u);
+    for (std::size_t i = count; i > 1; --i) {
+        std::swap(flock.order[i - 1], flock.order[rng.nextUint() % i]);
+    }
+    return flock;
+}
+
+// Meilleur temps de repeat exécutions, en nanosecondes par instance
+template<typename Fn>
+double measure(std::size_t count, int repeat, Fn&& fn)
+{
+    double best = 1e30;
+    for (int run = 0; run < repeat; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best / static_cast<double>(count);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes  = {1000, 100000, 1000000};
+    int                      repeat = 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            std::istringstream stream(argv[++i]);
+            std::string        item;
+            while (std::getline(stream, item, ',')) {
+                sizes.push_back(static_cast<std::size_t>(std::stoull(item)));
+            }
+        } else if (argument == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: instance_bench [--sizes 1000,100000] [--repeat N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const float scale    = 0.05f;
+    float       checksum = 0.0f; // Affiché à la fin : empêche le compilateur d'écarter les calculs
+    std::printf("%10s %15s %15s %15s %9s\n", "instances", "glm ns/inst", "closed ns/inst", "batched ns/inst", "speedup");
+    for (std::size_t count : sizes) {
+        Flock                     flock = makeFlock(count);
+        std::vector<InstanceData> instances(count);
+
+        double glmTime = measure(count, repeat, [&] {
+            for (std::size_t k = 0; k < count; ++k) {
+                std::uint32_t id    = flock.order[k];
+                glm::mat4     model = glm::translate(glm::mat4(1.0f), glm::vec3(flock.x[id], flock.y[id], flock.z[id])) *
+                                  glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+                instances[k].modelMatrix  = model;
+                instances[k].normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+                instances[k].color        = flock.colors[id];
+            }
+            checksum += instances[count - 1].normalMatrix[0][0];
+        });
+        double closedTime = measure(count, repeat, [&] {
+            for (std::size_t k = 0; k < count; ++k) {
+                std::uint32_t id = flock.order[k];
+                instances[k]     = InstanceData::fromTranslationScale(glm::vec3(flock.x[id], flock.y[id], flock.z[id]), scale, flock.colors[id]);
+            }
+            checksum += instances[count - 1].normalMatrix[0][0];
+        });
+        double batchedTime = measure(count, repeat, [&] {
+            buildTranslationScaleInstances({flock.x.data(), flock.y.data(), flock.z.data()}, flock.colors.data(), flock.order.data(), count, scale,
+                                           instances.data());
+            checksum += instances[count - 1].normalMatrix[0][0];
+        });
+
+        std::printf("%10zu %15.2f %15.2f %15.2f %8.1fx\n", count, glmTime, closedTime, batchedTime, glmTime / batchedTime);
+    }
+    std::printf("(checksum %g)\n", checksum);
+    return EXIT_SUCCESS;
+}
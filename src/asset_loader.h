@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "mesh_cache.h"
+#include "thread_pool.h"
+#include "vertex_animation.h"
+
+// Chargement asynchrone des maillages et des animations. Les fichiers sont lus et
+// analysés (ou leur cache projeté en mémoire) sur un pool de threads dédié, depuis un
+// thread d'arrière-plan ; les ressources prêtes attendent dans une file que le thread
+// OpenGL les envoie au GPU, quelques-unes par frame, avec uploadReady. Le pool est
+// détruit dès le dernier fichier lu : ses threads ne restent pas en concurrence avec
+// ceux de la simulation pour le reste de la partie.
+class AssetLoader {
+public:
+    struct MeshRequest {
+        std::string objPath;
+        std::string mtlPath;
+    };
+
+    // Animation dont chaque frame est un OBJ, regroupée en une VertexAnimation
+    struct AnimationRequest {
+        std::vector<MeshRequest> frames;
+    };
+
+    // Ressource chargée, identifiée par sa position dans la liste des demandes : les
+    // maillages d'abord, puis les animations (dont seul `animation` est rempli)
+    struct LoadedAsset {
+        std::size_t     id = 0;
+        bool            ok = false;
+        LoadedMesh      mesh;
+        VertexAnimation animation;
+    };
+
+    explicit AssetLoader(std::vector<MeshRequest> meshes, unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()))
+        : AssetLoader(std::move(meshes), {}, threadCount)
+    {}
+
+    AssetLoader(std::vector<MeshRequest> meshes, std::vector<AnimationRequest> animations, unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()))
+        : m_requests(std::move(meshes)), m_animations(animations.size()), m_pool(std::make_unique<ThreadPool>(threadCount))
+    {
+        // Chaque frame d'animation est un travail à part, pour que les frames se chargent en parallèle
+        std::vector<std::pair<std::size_t, std::size_t>> frameJobs; // (animation, frame)
+        for (std::size_t a = 0; a < animations.size(); ++a) {
+            m_animations[a].request = std::move(animations[a]);
+            m_animations[a].frames.resize(m_animations[a].request.frames.size());
+            m_animations[a].loaded.assign(m_animations[a].request.frames.size(), 0);
+            m_animations[a].pending = m_animations[a].request.frames.size();
+            for (std::size_t f = 0; f < m_animations[a].frames.size(); ++f) {
+                frameJobs.emplace_back(a, f);
+            }
+            if (m_animations[a].frames.empty()) {
+                push({m_requests.size() + a, false, {}, {}});
+            }
+        }
+
+        m_remaining = m_requests.size() + m_animations.size();
+        m_thread    = std::thread([this, frameJobs = std::move(frameJobs)] {
+            m_pool->parallelFor(m_requests.size() + frameJobs.size(), 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t job = begin; job < end && !m_cancel; ++job) {
+                    if (job < m_requests.size()) {
+                        loadMesh(job);
+                    } else {
+                        loadAnimationFrame(frameJobs[job - m_requests.size()].first, frameJobs[job - m_requests.size()].second);
+                    }
+                }
+            });
+            m_pool.reset();
+            m_loading = false;
+        });
+    }
+
+    // Les chargements pas encore commencés sont abandonnés
+    ~AssetLoader()
+    {
+        m_cancel = true;
+        m_thread.join();
+    }
+
+    AssetLoader(const AssetLoader&)            = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Fichier d'une ressource (la première frame pour une animation), pour les messages d'erreur
+    const std::string& path(std::size_t id) const
+    {
+        static const std::string none;
+        if (id < m_requests.size()) {
+            return m_requests[id].objPath;
+        }
+        const std::vector<MeshRequest>& frames = m_animations[id - m_requests.size()].request.frames;
+        return frames.empty() ? none : frames.front().objPath;
+    }
+
+    // Nombre de ressources pas encore passées à uploadReady
+    std::size_t remaining() const { return m_remaining; }
+
+    // Faux une fois tous les fichiers lus et les threads de chargement arrêtés
+    bool loading() const { return m_loading; }
+
+    // À appeler sur le thread OpenGL : appelle upload(const LoadedAsset&) pour les
+    // ressources prêtes, jusqu'à dépasser budgetMilliseconds (au moins un par appel
+    // pour toujours progresser)
+    template<typename UploadFn>
+    void uploadReady(double budgetMilliseconds, UploadFn&& upload)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        while (true) {
+            LoadedAsset asset;
+            {
+                std::lock_guard<std::mutex> lock(m_readyMutex);
+                if (m_ready.empty()) {
+                    return;
+                }
+                asset = std::move(m_ready.front());
+                m_ready.pop_front();
+            }
+            upload(static_cast<const LoadedAsset&>(asset));
+            --m_remaining;
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+            if (elapsed.count() >= budgetMilliseconds) {
+                return;
+            }
+        }
+    }
+
+private:
+    // Frames d'une animation en cours de chargement ; la dernière arrivée construit l'animation
+    struct PendingAnimation {
+        AnimationRequest         request;
+        std::vector<LoadedMesh>  frames;
+        std::vector<char>        loaded;
+        std::atomic<std::size_t> pending{0};
+    };
+
+    void loadMesh(std::size_t id)
+    {
+        LoadedAsset asset;
+        asset.id = id;
+        asset.ok = asset.mesh.load(m_requests[id].objPath.c_str(), m_requests[id].mtlPath.c_str());
+        push(std::move(asset));
+    }
+
+    void loadAnimationFrame(std::size_t a, std::size_t f)
+    {
+        PendingAnimation& animation = m_animations[a];
+        animation.loaded[f] = animation.frames[f].load(animation.request.frames[f].objPath.c_str(), animation.request.frames[f].mtlPath.c_str());
+        if (animation.pending.fetch_sub(1) != 1) {
+            return;
+        }
+
+        LoadedAsset asset;
+        asset.id = m_requests.size() + a;
+        asset.ok = std::all_of(animation.loaded.begin(), animation.loaded.end(), [](char ok) { return ok != 0; });
+        if (asset.ok) {
+            std::vector<MeshView> views;
+            for (const LoadedMesh& frame : animation.frames) {
+                views.push_back(frame.view());
+            }
+            asset.ok = buildVertexAnimation(views.data(), views.size(), asset.animation);
+        }
+        animation.frames.clear();
+        push(std::move(asset));
+    }
+
+    void push(LoadedAsset&& asset)
+    {
+        std::lock_guard<std::mutex> lock(m_readyMutex);
+        m_ready.push_back(std::move(asset));
+    }
+
+    std::vector<MeshRequest>      m_requests;
+    std::deque<PendingAnimation>  m_animations;
+    std::unique_ptr<ThreadPool>   m_pool; // Détruit par m_thread à la fin des chargements
+    std::thread                   m_thread;
+    std::atomic<bool>             m_cancel{false};
+    std::atomic<bool>             m_loading{true};
+    std::size_t                   m_remaining = 0;
+
+    std::mutex              m_readyMutex;
+    std::deque<LoadedAsset> m_ready;
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "boid_soa.h"
+
+// Référence stable vers un boid : l'emplacement reste le même quand les boids sont
+// déplacés dans le BoidSoA, et la génération invalide la poignée quand le boid meurt
+// (l'emplacement peut alors être réutilisé par un autre).
+struct BoidHandle {
+    std::uint32_t slot       = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t generation = 0;
+
+    bool operator==(const BoidHandle&) const = default;
+};
+
+// Boids vivants rangés de façon contiguë dans un BoidSoA (pour les passes SIMD), avec
+// une table d'emplacements pour les poignées. Les boids sont groupés par espèce : ceux de
+// l'espèce s occupent [speciesBegin(s), speciesEnd(s)), et les passes traitent chaque
+// espèce sur une plage contiguë avec ses propres paramètres. Naître et mourir déplacent
+// au plus un boid par espèce suivante : une naissance prend la place du premier boid de
+// chaque espèce suivante, qui passe en fin de plage ; un mort est remplacé par le dernier
+// de sa plage, puis chaque plage suivante recule d'un cran de la même façon. Un
+// emplacement libéré rejoint la liste des emplacements libres. Tant que reserve() a prévu
+// assez de place, rien n'est réalloué.
+class BoidPool {
+public:
+    static constexpr std::size_t NO_INDEX = std::numeric_limits<std::size_t>::max();
+
+    // Les passes de simulation peuvent modifier les boids, mais pas en ajouter ou en
+    // retirer : passer par spawn et kill
+    BoidSoA&       boids() { return m_boids; }
+    const BoidSoA& boids() const { return m_boids; }
+
+    std::size_t size() const { return m_boids.size(); }
+    std::size_t capacity() const { return m_boids.capacity(); }
+
+    std::size_t speciesCount() const { return m_speciesStart.size() - 1; }
+    std::size_t speciesBegin(std::size_t species) const { return m_speciesStart[species]; }
+    std::size_t speciesEnd(std::size_t species) const { return m_speciesStart[species + 1]; }
+
+    // Ne peut changer que lorsqu'il n'y a aucun boid : renvoie false sinon
+    bool setSpeciesCount(std::size_t count)
+    {
+        if (count == speciesCount()) {
+            return true;
+        }
+        if (m_boids.size() != 0 || count == 0) {
+            return false;
+        }
+        m_speciesStart.assign(count + 1, 0);
+        return true;
+    }
+
+    void reserve(std::size_t count)
+    {
+        m_boids.reserve(count);
+        m_slots.reserve(count);
+        m_denseSlots.reserve(count);
+        m_freeSlots.reserve(count);
+    }
+
+    // boid.species doit être inférieure à speciesCount()
+    BoidHandle spawn(const Boid& boid)
+    {
+        std::uint32_t slot;
+        if (m_freeSlots.empty()) {
+            slot = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back({});
+        } else {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        // Ajouté en fin de tableau, puis ramené à la fin de sa plage en échangeant sa place
+        // avec le premier boid de chaque espèce suivante
+        std::size_t index = m_boids.size();
+        m_slots[slot].index = static_cast<std::uint32_t>(index);
+        m_denseSlots.push_back(slot);
+        m_boids.pushBack(boid);
+        ++m_speciesStart.back();
+        for (std::size_t species = speciesCount() - 1; species > boid.species; --species) {
+            std::size_t first = m_speciesStart[species]++;
+            if (first != index) {
+                swap(first, index);
+            }
+            index = first;
+        }
+        return {slot, m_slots[slot].generation};
+    }
+
+    // Renvoie false si la poignée ne désigne plus un boid vivant
+    bool kill(BoidHandle handle)
+    {
+        std::size_t index = indexOf(handle);
+        if (index == NO_INDEX) {
+            return false;
+        }
+        // Le dernier de la plage prend la place du mort, puis chaque espèce suivante comble
+        // le trou en début de plage avec son dernier boid
+        std::size_t species = m_boids.species[index];
+        for (; species < speciesCount(); ++species) {
+            std::size_t last = --m_speciesStart[species + 1];
+            if (last != index) {
+                move(last, index);
+            }
+            index = last;
+        }
+        m_denseSlots.pop_back();
+        m_boids.popBack();
+
+        ++m_slots[handle.slot].generation;
+        m_freeSlots.push_back(handle.slot);
+        return true;
+    }
+
+    bool alive(BoidHandle handle) const { return indexOf(handle) != NO_INDEX; }
+
+    // Position actuelle du boid dans boids(), ou NO_INDEX s'il est mort
+    std::size_t indexOf(BoidHandle handle) const
+    {
+        if (handle.slot >= m_slots.size() || m_slots[handle.slot].generation != handle.generation) {
+            return NO_INDEX;
+        }
+        return m_slots[handle.slot].index;
+    }
+
+    // Poignée du boid rangé en position index
+    BoidHandle handleAt(std::size_t index) const
+    {
+        std::uint32_t slot = m_denseSlots[index];
+        return {slot, m_slots[slot].generation};
+    }
+
+    std::size_t memoryBytes() const
+    {
+        return m_boids.memoryBytes() + m_slots.capacity() * sizeof(Slot) + (m_denseSlots.capacity() + m_freeSlots.capacity()) * sizeof(std::uint32_t);
+    }
+
+private:
+    // Recopie le boid from en position to, dont l'ancien occupant a déjà été déplacé ou tué
+    void move(std::size_t from, std::size_t to)
+    {
+        m_boids.copy(from, to);
+        m_denseSlots[to]                = m_denseSlots[from];
+        m_slots[m_denseSlots[to]].index = static_cast<std::uint32_t>(to);
+    }
+
+    void swap(std::size_t a, std::size_t b)
+    {
+        m_boids.swap(a, b);
+        std::swap(m_denseSlots[a], m_denseSlots[b]);
+        m_slots[m_denseSlots[a]].index = static_cast<std::uint32_t>(a);
+        m_slots[m_denseSlots[b]].index = static_cast<std::uint32_t>(b);
+    }
+
+    struct Slot {
+        std::uint32_t index      = 0; // Position dans m_boids tant que le boid vit
+        std::uint32_t generation = 0; // Incrémentée à chaque mort
+    };
+
+    BoidSoA                    m_boids;
+    std::vector<Slot>          m_slots;
+    std::vector<std::uint32_t> m_denseSlots; // Emplacement de chaque boid de m_boids
+    std::vector<std::uint32_t> m_freeSlots;
+    std::vector<std::uint32_t> m_speciesStart = {0, 0}; // Début de la plage de chaque espèce, puis size()
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Description d'un boid, utilisée pour le faire apparaître dans un BoidSoA. Les poids
+// sont des facteurs propres au boid, appliqués à ceux de FlockParams.
+struct Boid {
+    glm::vec3    position;
+    glm::vec3    velocity;
+    bool         isFemale;
+    float        alignmentWeight  = 1.0f;
+    float        cohesionWeight   = 1.0f;
+    float        separationWeight = 1.0f;
+    float        interactionRadius;
+    std::uint8_t species = 0; // Indice dans la SpeciesTable du simulateur
+    int          markovState;
+    glm::vec3    color;
+    float        lifespan;
+    float        markovTime;
+};
+
+// Stockage des boids en structure de tableaux : chaque composante est contiguë en
+// mémoire, ce qui permet aux passes de pilotage de ne charger que les données
+// chaudes (positions, vitesses) et de les traiter par paquets SIMD.
+struct BoidSoA {
+    // Données chaudes : lues et écrites à chaque pas de simulation
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+
+    // Données froides
+    std::vector<std::uint8_t> isFemale;
+    std::vector<std::uint8_t> species;
+    std::vector<int>          markovState;
+    std::vector<double>       markovTime; // Date du prochain changement d'état
+    std::vector<float>        lifespan;
+    std::vector<glm::vec3>    color;
+    std::vector<float>        alignmentWeight;
+    std::vector<float>        cohesionWeight;
+    std::vector<float>        separationWeight;
+    std::vector<float>        interactionRadius;
+
+    std::size_t size() const { return px.size(); }
+
+    void resize(std::size_t count)
+    {
+        forEachArray([count](auto& array) { array.resize(count); });
+    }
+
+    void reserve(std::size_t count)
+    {
+        forEachArray([count](auto& array) { array.reserve(count); });
+    }
+
+    std::size_t capacity() const { return px.capacity(); }
+
+    // Recopie le boid from à la place du boid to
+    void copy(std::size_t from, std::size_t to)
+    {
+        forEachArray([from, to](auto& array) { array[to] = array[from]; });
+    }
+
+    void swap(std::size_t a, std::size_t b)
+    {
+        forEachArray([a, b](auto& array) { std::swap(array[a], array[b]); });
+    }
+
+    void popBack()
+    {
+        forEachArray([](auto& array) { array.pop_back(); });
+    }
+
+    // Retire le boid i en le remplaçant par le dernier (l'ordre n'est pas conservé)
+    void swapRemove(std::size_t i)
+    {
+        forEachArray([i](auto& array) {
+            array[i] = array.back();
+            array.pop_back();
+        });
+    }
+
+    // Octets réservés par l'ensemble des tableaux
+    std::size_t memoryBytes() const
+    {
+        std::size_t bytes = 0;
+        forEachArrayOf(*this, [&bytes](const auto& array) { bytes += array.capacity() * sizeof(array[0]); });
+        return bytes;
+    }
+
+    void pushBack(const Boid& boid)
+    {
+        px.push_back(boid.position.x);
+        py.push_back(boid.position.y);
+        pz.push_back(boid.position.z);
+        vx.push_back(boid.velocity.x);
+        vy.push_back(boid.velocity.y);
+        vz.push_back(boid.velocity.z);
+        isFemale.push_back(boid.isFemale ? 1 : 0);
+        species.push_back(boid.species);
+        markovState.push_back(boid.markovState);
+        markovTime.push_back(boid.markovTime);
+        lifespan.push_back(boid.lifespan);
+        color.push_back(boid.color);
+        alignmentWeight.push_back(boid.alignmentWeight);
+        cohesionWeight.push_back(boid.cohesionWeight);
+        separationWeight.push_back(boid.separationWeight);
+        interactionRadius.push_back(boid.interactionRadius);
+    }
+
+    glm::vec3 position(std::size_t i) const { return {px[i], py[i], pz[i]}; }
+    glm::vec3 velocity(std::size_t i) const { return {vx[i], vy[i], vz[i]}; }
+
+    void setPosition(std::size_t i, const glm::vec3& p)
+    {
+        px[i] = p.x;
+        py[i] = p.y;
+        pz[i] = p.z;
+    }
+
+    void setVelocity(std::size_t i, const glm::vec3& v)
+    {
+        vx[i] = v.x;
+        vy[i] = v.y;
+        vz[i] = v.z;
+    }
+
+private:
+    template<typename Fn>
+    void forEachArray(Fn&& fn)
+    {
+        forEachArrayOf(*this, fn);
+    }
+
+    template<typename Self, typename Fn>
+    static void forEachArrayOf(Self& self, Fn&& fn)
+    {
+        fn(self.px), fn(self.py), fn(self.pz), fn(self.vx), fn(self.vy), fn(self.vz);
+        fn(self.isFemale), fn(self.species), fn(self.markovState), fn(self.markovTime), fn(self.lifespan), fn(self.color);
+        fn(self.alignmentWeight), fn(self.cohesionWeight), fn(self.separationWeight), fn(self.interactionRadius);
+    }
+};
+
+// Colonnes exportées d'un pas : le tampon d'écriture de FlockSimulator, échangé avec
+// celles du BoidSoA à chaque pas. Après l'échange, il garde l'état d'avant le pas jusqu'à
+// ce que le pas suivant le réécrive entièrement : un autre tampon de mêmes colonnes peut
+// donc prendre sa place entre deux pas, sans copie (voir SnapshotWriter::submit).
+struct BoidStepBuffer {
+    std::vector<float>        px, py, pz;
+    std::vector<float>        vx, vy, vz;
+    std::vector<int>          markovState;
+    std::vector<std::uint8_t> isFemale;
+
+    std::size_t size() const { return px.size(); }
+
+    void resize(std::size_t count)
+    {
+        forEachArray([count](auto& array) { array.resize(count); });
+    }
+
+    void reserve(std::size_t count)
+    {
+        forEachArray([count](auto& array) { array.reserve(count); });
+    }
+
+    std::size_t memoryBytes() const
+    {
+        std::size_t bytes = 0;
+        forEachArrayOf(*this, [&bytes](const auto& array) { bytes += array.capacity() * sizeof(array[0]); });
+        return bytes;
+    }
+
+    // Copie des colonnes de boids (hors de la simulation : tests, bancs d'essai)
+    void assign(const BoidSoA& boids)
+    {
+        px.assign(boids.px.begin(), boids.px.end());
+        py.assign(boids.py.begin(), boids.py.end());
+        pz.assign(boids.pz.begin(), boids.pz.end());
+        vx.assign(boids.vx.begin(), boids.vx.end());
+        vy.assign(boids.vy.begin(), boids.vy.end());
+        vz.assign(boids.vz.begin(), boids.vz.end());
+        markovState.assign(boids.markovState.begin(), boids.markovState.end());
+        isFemale.assign(boids.isFemale.begin(), boids.isFemale.end());
+    }
+
+    void swapWith(BoidSoA& boids)
+    {
+        px.swap(boids.px), py.swap(boids.py), pz.swap(boids.pz);
+        vx.swap(boids.vx), vy.swap(boids.vy), vz.swap(boids.vz);
+        markovState.swap(boids.markovState), isFemale.swap(boids.isFemale);
+    }
+
+    void swap(BoidStepBuffer& other)
+    {
+        px.swap(other.px), py.swap(other.py), pz.swap(other.pz);
+        vx.swap(other.vx), vy.swap(other.vy), vz.swap(other.vz);
+        markovState.swap(other.markovState), isFemale.swap(other.isFemale);
+    }
+
+private:
+    template<typename Fn>
+    void forEachArray(Fn&& fn)
+    {
+        forEachArrayOf(*this, fn);
+    }
+
+    template<typename Self, typename Fn>
+    static void forEachArrayOf(Self& self, Fn&& fn)
+    {
+        fn(self.px), fn(self.py), fn(self.pz), fn(self.vx), fn(self.vy), fn(self.vz), fn(self.markovState), fn(self.isFemale);
+    }
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frustum.h"
+#include "glm/glm.hpp"
+
+// Hiérarchie de boîtes englobantes sur des sphères (centre xyz, rayon w), pour le
+// découpage par la pyramide de vue. L'arbre est construit une fois (coupe médiane sur
+// l'axe le plus long) puis seulement réajusté à chaque frame : les objets bougent, la
+// topologie reste. Il est reconstruit aussitôt quand le nombre d'objets change ; quand le
+// réajustement l'a trop dégradé, un nouvel arbre est construit par morceaux sur les
+// frames suivantes, l'ancien restant réajusté et utilisé jusqu'à ce qu'il soit prêt.
+//
+// Les nœuds sont rangés en profondeur d'abord : le fils gauche suit son parent et
+// chaque sous-arbre couvre une plage contiguë d'objets, ce qui permet d'accepter un
+// sous-arbre entièrement visible sans le parcourir.
+class BoundingVolumeHierarchy {
+public:
+    // Feuilles larges : moins de nœuds à réajuster et à parcourir, leurs sphères sont testées quatre par quatre
+    static constexpr std::uint32_t LEAF_SIZE = 32;
+    // Reconstruction quand la somme des aires des nœuds dépasse ce facteur fois celle de la construction
+    static constexpr float REBUILD_RATIO = 2.0f;
+    // Travail de reconstruction par frame, en objets partitionnés rapportés au nombre
+    // d'objets : un niveau de l'arbre par frame
+    static constexpr std::size_t REBUILD_LEVELS_PER_UPDATE = 1;
+
+    std::size_t size() const { return m_objects.size(); }
+    std::size_t nodeCount() const { return m_nodes.size(); }
+    bool        rebuilding() const { return m_rebuilding; } // Un nouvel arbre est en construction
+
+    void build(const std::vector<glm::vec4>& spheres) { build(spheres.size(), [&](std::size_t i) { return spheres[i]; }); }
+    void refit(const std::vector<glm::vec4>& spheres) { refit([&](std::size_t i) { return spheres[i]; }); }
+    void update(const std::vector<glm::vec4>& spheres) { update(spheres.size(), [&](std::size_t i) { return spheres[i]; }); }
+
+    // Mêmes opérations sur count sphères données par sphereOf(i) (centre xyz, rayon w) :
+    // l'appelant n'a pas à les ranger d'abord dans un tableau, elles sont lues une seule
+    // fois, directement par les feuilles.
+    template<typename SphereOf>
+    void build(std::size_t count, SphereOf&& sphereOf)
+    {
+        startBuild(count, sphereOf);
+        continueBuild(SIZE_MAX);
+        finishBuild(sphereOf);
+    }
+
+    // Recalcule les boîtes à partir des nouvelles sphères (même nombre, même ordre). Les
+    // feuilles recopient leurs sphères en colonnes en même temps qu'elles calculent leur boîte.
+    template<typename SphereOf>
+    void refit(SphereOf&& sphereOf)
+    {
+        std::size_t count = m_objects.size();
+        m_x.resize(count);
+        m_y.resize(count);
+        m_z.resize(count);
+        m_r.resize(count);
+
+        // Les enfants suivent toujours leur parent : un parcours à rebours voit les enfants d'abord
+        m_area = 0.0f;
+        for (std::size_t n = m_nodes.size(); n-- > 0;) {
+            Node& node = m_nodes[n];
+            if (node.right == 0) {
+                float minX = INFINITY, minY = INFINITY, minZ = INFINITY;
+                float maxX = -INFINITY, maxY = -INFINITY, maxZ = -INFINITY;
+                for (std::uint32_t k = node.first; k < node.first + node.count; ++k) {
+                    const glm::vec4 sphere = sphereOf(m_objects[k]);
+                    m_x[k] = sphere.x;
+                    m_y[k] = sphere.y;
+                    m_z[k] = sphere.z;
+                    m_r[k] = sphere.w;
+                    minX = std::min(minX, sphere.x - sphere.w);
+                    maxX = std::max(maxX, sphere.x + sphere.w);
+                    minY = std::min(minY, sphere.y - sphere.w);
+                    maxY = std::max(maxY, sphere.y + sphere.w);
+                    minZ = std::min(minZ, sphere.z - sphere.w);
+                    maxZ = std::max(maxZ, sphere.z + sphere.w);
+                }
+                node.min = glm::vec3(minX, minY, minZ);
+                node.max = glm::vec3(maxX, maxY, maxZ);
+            } else {
+                const Node& left  = m_nodes[n + 1];
+                const Node& right = m_nodes[node.right];
+                node.min = glm::min(left.min, right.min);
+                node.max = glm::max(left.max, right.max);
+            }
+            glm::vec3 extent = node.max - node.min;
+            m_area += extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+    }
+
+    // Réajuste l'arbre, ou le reconstruit si le nombre d'objets a changé. Un arbre dégradé
+    // est remplacé au bout de quelques appels, le temps d'en construire un nouveau.
+    template<typename SphereOf>
+    void update(std::size_t count, SphereOf&& sphereOf)
+    {
+        if (count != m_objects.size()) {
+            build(count, sphereOf);
+            return;
+        }
+        if (m_rebuilding && continueBuild(REBUILD_LEVELS_PER_UPDATE * count)) {
+            finishBuild(sphereOf);
+            return;
+        }
+        refit(sphereOf);
+        if (!m_rebuilding && m_area > REBUILD_RATIO * m_builtArea) {
+            startBuild(count, sphereOf);
+        }
+    }
+
+    // Ajoute à visible l'indice de chaque sphère qui touche la pyramide (ordre des feuilles)
+    void cull(const Frustum& frustum, std::vector<std::uint32_t>& visible) const
+    {
+        if (m_nodes.empty()) {
+            return;
+        }
+        std::uint32_t stack[64];
+        int           top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+            switch (frustum.classifyBox(node.min, node.max)) {
+            case Frustum::Containment::Outside:
+                break;
+            case Frustum::Containment::Inside:
+                visible.insert(visible.end(), m_objects.begin() + node.first, m_objects.begin() + node.first + node.count);
+                break;
+            case Frustum::Containment::Intersects:
+                if (node.right == 0) {
+                    frustum.cullSpheres(m_x.data() + node.first, m_y.data() + node.first, m_z.data() + node.first, m_r.data() + node.first,
+                                        m_objects.data() + node.first, node.count, visible);
+                } else {
+                    stack[top++] = node.right;
+                    stack[top++] = static_cast<std::uint32_t>(&node - m_nodes.data()) + 1;
+                }
+                break;
+            }
+        }
+    }
+
+private:
+    struct Node {
+        glm::vec3     min{0.0f};
+        std::uint32_t first = 0; // Plage d'objets couverte : [first, first + count)
+        glm::vec3     max{0.0f};
+        std::uint32_t count = 0;
+        std::uint32_t right = 0; // Fils droit (le gauche suit le nœud) ; 0 pour une feuille
+    };
+
+    struct Center {
+        glm::vec3     position;
+        std::uint32_t id;
+    };
+
+    // Nœud à créer sur m_centers[begin, end). parent est le nœud dont c'est le fils
+    // droit (NO_PARENT pour la racine et les fils gauches, qui suivent leur parent).
+    struct BuildTask {
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t parent;
+    };
+    static constexpr std::uint32_t NO_PARENT = UINT32_MAX;
+
+    // Prépare la construction d'un arbre sur les centres actuels des sphères, sans
+    // toucher à l'arbre en place. Les centres sont recopiés côte à côte : les partitions
+    // successives restent en cache.
+    template<typename SphereOf>
+    void startBuild(std::size_t count, SphereOf&& sphereOf)
+    {
+        m_centers.resize(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            m_centers[i] = {glm::vec3(sphereOf(i)), i};
+        }
+        m_building.clear();
+        m_building.reserve(2 * count / LEAF_SIZE + 1);
+        m_tasks.clear();
+        if (count > 0) {
+            m_tasks.push_back({0, static_cast<std::uint32_t>(count), NO_PARENT});
+        }
+        m_rebuilding = true;
+    }
+
+    // Crée des nœuds jusqu'à avoir partitionné budget objets ; renvoie true quand l'arbre
+    // est complet. La pile rend les nœuds en profondeur d'abord, le fils gauche en premier,
+    // comme une construction récursive. La profondeur reste sous 64 : la coupe médiane
+    // divise la plage par deux à chaque niveau.
+    bool continueBuild(std::size_t budget)
+    {
+        std::size_t work = 0;
+        while (!m_tasks.empty() && work < budget) {
+            const BuildTask task  = m_tasks.back();
+            const auto      index = static_cast<std::uint32_t>(m_building.size());
+            m_tasks.pop_back();
+            if (task.parent != NO_PARENT) {
+                m_building[task.parent].right = index;
+            }
+            m_building.push_back({glm::vec3(0.0f), task.begin, glm::vec3(0.0f), task.end - task.begin, 0});
+            if (task.end - task.begin <= LEAF_SIZE) {
+                continue;
+            }
+
+            glm::vec3 low  = m_centers[task.begin].position;
+            glm::vec3 high = low;
+            for (std::uint32_t k = task.begin + 1; k < task.end; ++k) {
+                low  = glm::min(low, m_centers[k].position);
+                high = glm::max(high, m_centers[k].position);
+            }
+            glm::vec3 extent = high - low;
+            int       axis   = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+            std::uint32_t middle = task.begin + (task.end - task.begin) / 2;
+            std::nth_element(m_centers.begin() + task.begin, m_centers.begin() + middle, m_centers.begin() + task.end,
+                             [axis](const Center& a, const Center& b) { return a.position[axis] < b.position[axis]; });
+            work += task.end - task.begin;
+            m_tasks.push_back({middle, task.end, index});
+            m_tasks.push_back({task.begin, middle, NO_PARENT});
+        }
+        return m_tasks.empty();
+    }
+
+    // Remplace l'arbre en place par celui qui vient d'être construit
+    template<typename SphereOf>
+    void finishBuild(SphereOf&& sphereOf)
+    {
+        m_nodes.swap(m_building);
+        m_objects.resize(m_centers.size());
+        for (std::size_t k = 0; k < m_centers.size(); ++k) {
+            m_objects[k] = m_centers[k].id;
+        }
+        m_rebuilding = false;
+        refit(sphereOf);
+        m_builtArea = m_area;
+    }
+
+    std::vector<Node>          m_nodes;
+    std::vector<std::uint32_t> m_objects; // Indice des sphères dans l'ordre des feuilles
+    // Arbre en construction
+    std::vector<Center>    m_centers;
+    std::vector<Node>      m_building;
+    std::vector<BuildTask> m_tasks;
+    bool                   m_rebuilding = false;
+    // Sphères recopiées dans l'ordre des feuilles, en colonnes pour le test SIMD
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_r;
+    float              m_area      = 0.0f;
+    float              m_builtArea = 0.0f;
+};
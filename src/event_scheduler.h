@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// File d'événements datés : tas 4-aire ordonné par date de déclenchement (membre `time`
+// de Event). Un tas 4-aire est moins profond qu'un tas binaire et ses quatre enfants se
+// suivent en mémoire, ce qui réduit les défauts de cache lors des descentes.
+// Chaque frame ne traite que les événements échus : le coût suit le nombre d'événements,
+// pas le nombre d'objets qui en attendent un.
+template<typename Event>
+class EventScheduler {
+public:
+    static constexpr std::size_t ARITY = 4;
+
+    bool        empty() const { return m_heap.empty(); }
+    std::size_t size() const { return m_heap.size(); }
+    std::size_t capacity() const { return m_heap.capacity(); }
+
+    void clear() { m_heap.clear(); }
+    void reserve(std::size_t count) { m_heap.reserve(count); }
+
+    // Événement le plus proche (la file ne doit pas être vide)
+    const Event& top() const { return m_heap.front(); }
+
+    void push(const Event& event)
+    {
+        m_heap.push_back(event);
+        siftUp(m_heap.size() - 1);
+    }
+
+    Event pop()
+    {
+        Event event = std::move(m_heap.front());
+        m_heap.front() = std::move(m_heap.back());
+        m_heap.pop_back();
+        if (!m_heap.empty()) {
+            siftDown(0);
+        }
+        return event;
+    }
+
+    // Retire et transmet à fn, dans l'ordre des dates, chaque événement dont la date est
+    // <= time. fn peut programmer de nouveaux événements : ceux qui sont déjà échus sont
+    // traités dans le même appel.
+    template<typename Fn>
+    std::size_t popDue(double time, Fn&& fn)
+    {
+        std::size_t count = 0;
+        while (!m_heap.empty() && m_heap.front().time <= time) {
+            fn(pop());
+            ++count;
+        }
+        return count;
+    }
+
+    // Retire tous les événements pour lesquels stale(event) est vrai, puis reforme le tas
+    // en O(n). Renvoie le nombre d'événements retirés.
+    template<typename Pred>
+    std::size_t removeIf(Pred&& stale)
+    {
+        auto        end     = std::remove_if(m_heap.begin(), m_heap.end(), stale);
+        std::size_t removed = static_cast<std::size_t>(m_heap.end() - end);
+        m_heap.erase(end, m_heap.end());
+        // Les feuilles forment déjà des tas : redescendre chaque parent, du dernier à la racine
+        for (std::size_t index = m_heap.size() / ARITY + 1; index-- > 0;) {
+            if (index < m_heap.size()) {
+                siftDown(index);
+            }
+        }
+        return removed;
+    }
+
+private:
+    void siftUp(std::size_t index)
+    {
+        Event event = std::move(m_heap[index]);
+        while (index > 0) {
+            std::size_t parent = (index - 1) / ARITY;
+            if (!(event.time < m_heap[parent].time)) {
+                break;
+            }
+            m_heap[index] = std::move(m_heap[parent]);
+            index         = parent;
+        }
+        m_heap[index] = std::move(event);
+    }
+
+    void siftDown(std::size_t index)
+    {
+        const std::size_t size  = m_heap.size();
+        Event             event = std::move(m_heap[index]);
+        while (true) {
+            std::size_t first = index * ARITY + 1;
+            if (first >= size) {
+                break;
+            }
+            std::size_t last     = std::min(first + ARITY, size);
+            std::size_t earliest = first;
+            for (std::size_t child = first + 1; child < last; ++child) {
+                if (m_heap[child].time < m_heap[earliest].time) {
+                    earliest = child;
+                }
+            }
+            if (!(m_heap[earliest].time < event.time)) {
+                break;
+            }
+            m_heap[index] = std::move(m_heap[earliest]);
+            index         = earliest;
+        }
+        m_heap[index] = std::move(event);
+    }
+
+    std::vector<Event> m_heap;
+};
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "boid_pool.h"
+#include "boid_soa.h"
+#include "event_scheduler.h"
+#include "glm/glm.hpp"
+#include "profiler.h"
+#include "random.h"
+#include "spatial_grid.h"
+#include "species.h"
+#include "steering.h"
+#include "thread_pool.h"
+
+// Paramètres réglables de la simulation (curseurs ImGui, caméra, arpenteur)
+struct FlockParams {
+    float separationDistance  = 0.1f; // Distance minimale de séparation des boids
+    float interactionRadius   = 1.0f; // Rayon d'interaction pour l'alignement et la cohésion
+    float alignmentWeight     = 0.1f;
+    float cohesionWeight      = 0.1f;
+    float distanceMinToCamera = 0.2f;
+    float avoidanceWeight     = 0.2f;
+    float domeRadius          = 2.0f;
+    float markovRadius        = 1.0f; // Rayon de comptage des voisins pour la chaîne de Markov
+    int   markovThreshold     = 5; // Nombre de voisins au-delà duquel un boid change d'état
+    float meanLifespan        = 20.0f; // Durée de vie moyenne d'un boid (secondes)
+    bool  autoMode            = false; // Mode jour/nuit automatique
+    float dayNightInterval    = 5.0f; // Délai moyen entre deux tirages jour/nuit du mode automatique
+
+    glm::vec3 cameraPosition{0.0f};
+    glm::vec3 surveyorPosition{0.0f};
+};
+
+// État de la chaîne de Markov d'un boid d'après son nombre de voisins (compté par la
+// passe de voisinage) : 1 au-delà de markovThreshold voisins
+inline int markovStateFor(float markovNeighborCount, int markovThreshold)
+{
+    return markovNeighborCount > static_cast<float>(markovThreshold) ? 1 : 0;
+}
+
+// Pas de simulation du troupeau, réparti sur un pool de threads. Chaque passe lit un
+// état figé (copie triée par la grille, ou tampon de positions courant) et écrit dans
+// un autre tampon : le résultat ne dépend ni de l'ordre de traitement ni du nombre de threads.
+// Les boids sont rangés par espèce : chaque tranche confiée au pool est découpée aux
+// frontières des espèces, et chaque morceau passe par les noyaux avec les paramètres de
+// son espèce, sans test par boid.
+class FlockSimulator {
+public:
+    explicit FlockSimulator(ThreadPool& pool)
+        : m_pool(pool)
+    {}
+
+    // Les boids peuvent être modifiés sur place ; ils naissent et meurent par spawn et kill
+    BoidSoA&        boids() { return m_flock.boids(); }
+    const BoidSoA&  boids() const { return m_flock.boids(); }
+    const BoidPool& flock() const { return m_flock; }
+
+    // État des boids au début du dernier pas (après les naissances et morts qui l'ont
+    // précédé), jusqu'au pas suivant. Le tampon peut être échangé contre un autre
+    // BoidStepBuffer : le pas suivant le redimensionne et le réécrit entièrement.
+    BoidStepBuffer& previousState() { return m_back; }
+
+    // Prévoit la place de count boids : en dessous, naissances et morts ne réallouent rien.
+    // La file d'événements compte deux événements par boid et la bascule jour/nuit, plus
+    // autant d'événements périmés au plus (voir compactEvents).
+    void reserve(std::size_t count)
+    {
+        m_flock.reserve(count);
+        m_back.reserve(count);
+        m_events.reserve(2 * (2 * count + 1));
+    }
+
+    // Ajoute un boid et programme ses événements. Ses délais markovTime et lifespan
+    // partent de l'instant présent.
+    BoidHandle spawn(const Boid& boid)
+    {
+        BoidHandle  handle = m_flock.spawn(boid);
+        BoidSoA&    boids  = m_flock.boids();
+        std::size_t i      = boids.size() - 1;
+        boids.markovTime[i] += m_time;
+        m_events.push({boids.markovTime[i], handle, EventKind::MarkovTransition});
+        m_events.push({m_time + boids.lifespan[i], handle, EventKind::LifespanExpiry});
+        return handle;
+    }
+
+    // Nouveau boid de l'espèce species tiré au hasard dans le dôme, de vitesse speed. Les
+    // tirages dépendent de la graine et du nombre de boids déjà créés ainsi : une même
+    // suite de naissances redonne les mêmes boids.
+    Boid randomBoid(float speed, std::size_t species = 0)
+    {
+        CounterRng  rng(m_seed, SPAWN_STREAM, m_spawnCount++);
+        const float radius = m_params.domeRadius;
+        Boid        boid{};
+        boid.position    = glm::vec3(rng.uniform(-radius, radius), rng.uniform(-radius, radius), rng.uniform(-radius, radius));
+        boid.velocity    = rng.onSphere(speed);
+        boid.isFemale    = rng.nextUint() % 2 == 0;
+        boid.markovState = 0;
+        boid.markovTime  = rng.exponential(1.0f);
+        boid.lifespan    = rng.exponential(1.0f / m_params.meanLifespan);
+        boid.species     = static_cast<std::uint8_t>(species);
+        return boid;
+    }
+
+    // Retire un boid : le dernier de son espèce prend sa place (voir BoidPool), ses deux
+    // événements en attente sont périmés
+    bool kill(BoidHandle handle)
+    {
+        if (!m_flock.kill(handle)) {
+            return false;
+        }
+        m_staleEvents += 2;
+        compactEvents();
+        return true;
+    }
+
+    FlockParams&       params() { return m_params; }
+    const FlockParams& params() const { return m_params; }
+
+    const SpeciesTable& species() const { return m_species; }
+
+    // Les paramètres des espèces peuvent changer à tout moment, leur nombre seulement
+    // quand il n'y a aucun boid : renvoie false sinon
+    bool setSpecies(const SpeciesTable& species)
+    {
+        if (!m_flock.setSpeciesCount(species.size())) {
+            return false;
+        }
+        m_species = species;
+        return true;
+    }
+
+    double        time() const { return m_time; }
+    std::uint64_t steps() const { return m_steps; }
+
+    // Paires (boid, voisin candidat) examinées par les passes de voisinage depuis la création
+    std::uint64_t candidatePairs() const { return m_candidatePairs.load(std::memory_order_relaxed); }
+
+    // Graine des tirages de la simulation (naissances, changements d'état, interrupteur)
+    std::uint64_t seed() const { return m_seed; }
+    void          setSeed(std::uint64_t seed) { m_seed = seed; }
+
+    // Octets réservés par les boids et par les tampons de travail d'un pas
+    std::size_t memoryBytes() const
+    {
+        std::size_t floats = 0;
+        for (const auto* array : {&m_sorted.x, &m_sorted.y, &m_sorted.z, &m_sorted.vx, &m_sorted.vy, &m_sorted.vz,
+                                  &m_sums.separationX, &m_sums.separationY, &m_sums.separationZ, &m_sums.alignmentX,
+                                  &m_sums.alignmentY, &m_sums.alignmentZ, &m_sums.cohesionX, &m_sums.cohesionY,
+                                  &m_sums.cohesionZ, &m_sums.neighborCount, &m_sums.markovNeighborCount}) {
+            floats += array->capacity();
+        }
+        return m_flock.memoryBytes() + m_back.memoryBytes() + m_grid.memoryBytes() + floats * sizeof(float) + m_events.capacity() * sizeof(Event);
+    }
+
+    // Avance la simulation de dt secondes. Renvoie le nouvel état jour/nuit lorsque
+    // le mode automatique en a tiré un pendant ce pas.
+    std::optional<bool> step(float dt)
+    {
+        m_time += dt;
+        BoidSoA&          boids = m_flock.boids();
+        const std::size_t count = boids.size();
+
+        // Ranger les boids dans la grille puis recopier leurs données dans l'ordre trié :
+        // c'est le tampon de lecture de la passe de voisinage
+        {
+            PROFILE_SCOPE("Grid build");
+            float neighborRadius = std::max({m_params.separationDistance, m_params.interactionRadius * m_species.maxInteractionRadius(), m_params.markovRadius});
+            m_grid.build(count, m_params.domeRadius, neighborRadius, m_species.size(), [&](std::size_t i) { return boids.position(i); },
+                         [&](std::size_t i) { return boids.species[i]; });
+            m_sorted.resize(count);
+            m_pool.parallelFor(count, GATHER_GRAIN, [&](std::size_t begin, std::size_t end) {
+                m_sorted.gather(boids, m_grid, begin, end);
+            });
+        }
+
+        // Calculer les vecteurs de séparation, alignement et cohésion, et compter les
+        // voisins de la chaîne de Markov dans la même passe
+        {
+            PROFILE_SCOPE("Neighbour pass");
+            m_sums.resize(count);
+            // Les couches de la grille suivent l'ordre des espèces : les emplacements triés
+            // d'une espèce occupent la même plage que ses boids
+            m_pool.parallelFor(count, NEIGHBOR_GRAIN, [&](std::size_t begin, std::size_t end) {
+                std::uint64_t candidates = 0;
+                forEachSpeciesRange(begin, end, [&](std::size_t species, std::size_t first, std::size_t last) {
+                    float radius = m_params.interactionRadius * m_species[species].interactionRadius;
+                    candidates += steeringKernels().accumulateNeighbors(makeNeighborPassArgs(m_sorted, m_grid, m_params.separationDistance, radius, m_params.markovRadius, m_sums, first, last,
+                                                                               m_species.interactions(species)));
+                });
+                m_candidatePairs.fetch_add(candidates, std::memory_order_relaxed);
+            });
+        }
+
+        // Appliquer les règles et intégrer dans le tampon d'écriture, puis l'échanger
+        SteeringParams steering{};
+        steering.distanceMinToCamera = m_params.distanceMinToCamera;
+        steering.avoidanceWeight     = m_params.avoidanceWeight;
+        steering.domeRadius          = m_params.domeRadius;
+        steering.deltaTime           = dt;
+        steering.cameraPosition      = m_params.cameraPosition;
+        steering.surveyorPosition    = m_params.surveyorPosition;
+
+        {
+            PROFILE_SCOPE("Integrate");
+            m_back.resize(count);
+            m_pool.parallelFor(count, INTEGRATE_GRAIN, [&](std::size_t begin, std::size_t end) {
+                forEachSpeciesRange(begin, end, [&](std::size_t species, std::size_t first, std::size_t last) {
+                    SteeringParams speciesSteering   = steering;
+                    speciesSteering.separationWeight = m_species[species].separationWeight;
+                    speciesSteering.alignmentWeight  = m_params.alignmentWeight * m_species[species].alignmentWeight;
+                    speciesSteering.cohesionWeight   = m_params.cohesionWeight * m_species[species].cohesionWeight;
+                    steeringKernels().integrate(makeIntegrateArgs(boids, m_back.px.data(), m_back.py.data(), m_back.pz.data(), m_back.vx.data(), m_back.vy.data(), m_back.vz.data(), m_sums,
+                                                                  speciesSteering, first, last));
+                });
+                // Les colonnes exportées que les événements modifient sur place passent aussi
+                // par le tampon : après l'échange, il garde l'état complet d'avant le pas
+                std::copy(boids.markovState.begin() + begin, boids.markovState.begin() + end, m_back.markovState.begin() + begin);
+                std::copy(boids.isFemale.begin() + begin, boids.isFemale.begin() + end, m_back.isFemale.begin() + begin);
+            });
+            m_back.swapWith(boids);
+        }
+
+        // Événements échus pendant ce pas : changements d'état de la chaîne de Markov (d'après
+        // les voisins comptés par la passe de voisinage de ce pas, seulement pour les boids
+        // concernés), fins de vie, bascules jour/nuit. Ils sont traités dans l'ordre des dates, avec des
+        // tirages pris dans une suite propre au pas : le résultat reste reproductible.
+        PROFILE_SCOPE("Events");
+        std::optional<bool> dayMode;
+        CounterRng          rng(m_seed, EVENT_STREAM, m_steps);
+        if (m_params.autoMode != m_dayNightScheduled) {
+            // Le mode automatique vient d'être activé ou coupé : (ré)armer ou annuler la bascule
+            ++m_dayNightGeneration;
+            if (m_dayNightScheduled) {
+                ++m_staleEvents;
+                compactEvents();
+            }
+            m_dayNightScheduled = m_params.autoMode;
+            if (m_params.autoMode) {
+                m_events.push({m_time + rng.exponential(1.0f / m_params.dayNightInterval), {0, m_dayNightGeneration}, EventKind::DayNight});
+            }
+        }
+        m_events.popDue(m_time, [&](const Event& event) {
+            switch (event.kind) {
+            case EventKind::MarkovTransition:
+                if (std::size_t i = m_flock.indexOf(event.boid); i != BoidPool::NO_INDEX) {
+                    boids.markovState[i] = markovStateFor(m_sums.markovNeighborCount[i], m_params.markovThreshold);
+                    // Générer un nouveau temps entre les changements d'état
+                    boids.markovTime[i] += rng.exponential(1.0f);
+                    m_events.push({boids.markovTime[i], event.boid, EventKind::MarkovTransition});
+                } else {
+                    --m_staleEvents;
+                }
+                break;
+            case EventKind::LifespanExpiry:
+                if (std::size_t i = m_flock.indexOf(event.boid); i != BoidPool::NO_INDEX) {
+                    respawn(i, rng);
+                    m_events.push({m_time + boids.lifespan[i], event.boid, EventKind::LifespanExpiry});
+                } else {
+                    --m_staleEvents;
+                }
+                break;
+            case EventKind::DayNight:
+                if (event.boid.generation == m_dayNightGeneration) {
+                    // Générer aléatoirement le nouvel état de l'interrupteur (nombre de « cliques » pair : jour)
+                    dayMode = rng.poisson(1.0f) % 2 == 0;
+                    m_events.push({m_time + rng.exponential(1.0f / m_params.dayNightInterval), event.boid, EventKind::DayNight});
+                } else {
+                    --m_staleEvents;
+                }
+                break;
+            }
+        });
+        ++m_steps;
+        return dayMode;
+    }
+
+private:
+    enum class EventKind : std::uint32_t { MarkovTransition, LifespanExpiry, DayNight };
+
+    // Un événement dont le boid est mort est ignoré ; pour la bascule jour/nuit, seule la
+    // génération compte (elle change quand le mode automatique est coupé)
+    struct Event {
+        double     time;
+        BoidHandle boid;
+        EventKind  kind;
+    };
+
+    // Retire les événements périmés dès qu'ils forment plus de la moitié de la file : elle
+    // ne dépasse jamais le double des événements vivants, et chaque compactage en O(n)
+    // suit au moins n / 2 morts
+    void compactEvents()
+    {
+        if (2 * m_staleEvents <= m_events.size()) {
+            return;
+        }
+        m_events.removeIf([this](const Event& event) {
+            return event.kind == EventKind::DayNight ? event.boid.generation != m_dayNightGeneration : m_flock.indexOf(event.boid) == BoidPool::NO_INDEX;
+        });
+        m_staleEvents = 0;
+    }
+
+    // Appelle fn(species, first, last) pour chaque morceau non vide de [begin, end)
+    // appartenant à une seule espèce
+    template<typename Fn>
+    void forEachSpeciesRange(std::size_t begin, std::size_t end, Fn&& fn) const
+    {
+        for (std::size_t species = 0; species < m_flock.speciesCount(); ++species) {
+            std::size_t first = std::max(begin, m_flock.speciesBegin(species));
+            std::size_t last  = std::min(end, m_flock.speciesEnd(species));
+            if (first < last) {
+                fn(species, first, last);
+            }
+        }
+    }
+
+    // Fin de vie : le boid réapparaît ailleurs dans le dôme, à la même vitesse, avec un
+    // nouveau sexe et une nouvelle durée de vie
+    void respawn(std::size_t i, CounterRng& rng)
+    {
+        BoidSoA&    boids  = m_flock.boids();
+        const float radius = m_params.domeRadius;
+        const float speed  = glm::length(boids.velocity(i));
+        boids.setPosition(i, glm::vec3(rng.uniform(-radius, radius), rng.uniform(-radius, radius), rng.uniform(-radius, radius)));
+        boids.setVelocity(i, rng.onSphere(speed));
+        boids.isFemale[i]    = rng.nextUint() % 2 == 0 ? 1 : 0;
+        boids.markovState[i] = 0;
+        boids.lifespan[i]    = rng.exponential(1.0f / m_params.meanLifespan);
+    }
+
+    // Tailles des tranches confiées au pool (en boids)
+    static constexpr std::size_t GATHER_GRAIN    = 8192;
+    static constexpr std::size_t NEIGHBOR_GRAIN  = 256;
+    static constexpr std::size_t INTEGRATE_GRAIN = 4096;
+
+    // Flux des tirages de la simulation (voir CounterRng)
+    static constexpr std::uint32_t EVENT_STREAM = 1;
+    static constexpr std::uint32_t SPAWN_STREAM = 2;
+
+    ThreadPool&          m_pool;
+    FlockParams          m_params;
+    SpeciesTable         m_species;
+    BoidPool             m_flock;
+    BoidStepBuffer       m_back; // Tampon d'écriture du pas, échangé avec les colonnes du BoidSoA
+    SpatialGrid          m_grid;
+    SortedBoids          m_sorted;
+    NeighborAccumulators m_sums;
+    double               m_time       = 0.0; // En double : un float ne distingue plus les pas au bout de quelques heures
+    std::uint64_t        m_steps      = 0;
+    std::uint64_t        m_seed       = 0;
+    std::uint64_t        m_spawnCount = 0; // Boids créés par randomBoid
+
+    std::atomic<std::uint64_t> m_candidatePairs{0}; // Cumulé par tranche de la passe de voisinage
+
+    EventScheduler<Event> m_events;
+    std::size_t           m_staleEvents        = 0; // Événements de la file dont le boid est mort ou la bascule annulée
+    std::uint32_t         m_dayNightGeneration = 0;
+    bool                  m_dayNightScheduled  = false;
+};
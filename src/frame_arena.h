@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Allocateur linéaire pour les tampons de travail d'une frame : chaque allocation avance
+// un curseur dans un bloc, reset() libère tout d'un coup en début de frame. Quand le
+// bloc ne suffit pas, des blocs de débordement prennent le relais jusqu'au prochain
+// reset(), qui agrandit alors le bloc principal à la consommation maximale observée :
+// une fois ce régime atteint, une frame n'alloue plus rien sur le tas.
+class FrameArena {
+public:
+    static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+    explicit FrameArena(std::size_t capacity = 1 << 16)
+    {
+        grow(capacity);
+    }
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // count objets initialisés par valeur, valides jusqu'au prochain reset()
+    template<typename T>
+    std::span<T> allocate(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "reset() ne détruit pas les objets");
+        static_assert(alignof(T) <= ALIGNMENT);
+        T* data = static_cast<T*>(allocateBytes(count * sizeof(T)));
+        std::uninitialized_value_construct_n(data, count);
+        return {data, count};
+    }
+
+    // Copie de [first, last) dans l'arène
+    template<typename T>
+    std::span<T> copy(const T* first, const T* last)
+    {
+        std::span<T> result = allocate<T>(static_cast<std::size_t>(last - first));
+        std::copy(first, last, result.begin());
+        return result;
+    }
+
+    void reset()
+    {
+        m_peak = std::max(m_peak, m_frameBytes);
+        if (!m_overflow.empty()) {
+            m_overflow.clear();
+            grow(m_peak);
+        }
+        m_used       = 0;
+        m_frameBytes = 0;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t used() const { return m_frameBytes; }  // Octets demandés depuis le dernier reset()
+    std::size_t peak() const { return std::max(m_peak, m_frameBytes); }
+
+private:
+    static std::size_t alignUp(std::size_t bytes) { return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+    void grow(std::size_t capacity)
+    {
+        m_capacity = alignUp(std::max<std::size_t>(capacity, ALIGNMENT));
+        m_block    = std::make_unique<Storage[]>(m_capacity / ALIGNMENT);
+    }
+
+    void* allocateBytes(std::size_t bytes)
+    {
+        bytes = alignUp(bytes);
+        m_frameBytes += bytes;
+        if (m_used + bytes <= m_capacity) {
+            void* data = reinterpret_cast<std::byte*>(m_block.get()) + m_used;
+            m_used += bytes;
+            return data;
+        }
+        m_overflow.push_back(std::make_unique<Storage[]>(std::max<std::size_t>(bytes, ALIGNMENT) / ALIGNMENT));
+        return m_overflow.back().get();
+    }
+
+    struct alignas(ALIGNMENT) Storage {
+        std::byte bytes[ALIGNMENT];
+    };
+
+    std::unique_ptr<Storage[]>              m_block;
+    std::size_t                             m_capacity   = 0;
+    std::size_t                             m_used       = 0; // Octets occupés dans m_block
+    std::size_t                             m_frameBytes = 0; // Y compris les débordements
+    std::size_t                             m_peak       = 0;
+    std::vector<std::unique_ptr<Storage[]>> m_overflow;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "simd.h"
+
+// Pyramide de vue extraite de la matrice projection * vue (méthode de Gribb et Hartmann).
+// Chaque plan (normale unitaire tournée vers l'intérieur, distance en w) garde les points p
+// tels que dot(normale, p) + w >= 0.
+struct Frustum {
+    enum class Containment { Outside, Intersects, Inside };
+
+    glm::vec4 planes[6]; // Gauche, droite, bas, haut, proche, lointain
+
+    static Frustum fromMatrix(const glm::mat4& viewProjection)
+    {
+        // glm range les matrices par colonnes : la ligne i est (m[0][i], m[1][i], m[2][i], m[3][i])
+        auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+        Frustum frustum;
+        frustum.planes[0] = row(3) + row(0);
+        frustum.planes[1] = row(3) - row(0);
+        frustum.planes[2] = row(3) + row(1);
+        frustum.planes[3] = row(3) - row(1);
+        frustum.planes[4] = row(3) + row(2);
+        frustum.planes[5] = row(3) - row(2);
+        for (glm::vec4& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Containment classifyBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+    {
+        glm::vec3   center = (boxMin + boxMax) * 0.5f;
+        glm::vec3   extent = (boxMax - boxMin) * 0.5f;
+        Containment result = Containment::Inside;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 normal = glm::vec3(plane);
+            float     distance = glm::dot(normal, center) + plane.w;
+            float     reach    = glm::dot(glm::abs(normal), extent);
+            if (distance < -reach) {
+                return Containment::Outside;
+            }
+            if (distance < reach) {
+                result = Containment::Intersects;
+            }
+        }
+        return result;
+    }
+
+    // Teste count sphères rangées en colonnes (centres x, y, z et rayons r) et ajoute à
+    // visible l'identifiant ids[i] de chacune de celles qui touchent la pyramide. Quatre
+    // sphères par itération avec SSE2.
+    void cullSpheres(const float* x, const float* y, const float* z, const float* r, const std::uint32_t* ids, std::size_t count,
+                     std::vector<std::uint32_t>& visible) const
+    {
+        // Place réservée pour le pire cas, écrite sans branche puis ramenée aux seules sphères gardées
+        std::size_t    size = visible.size();
+        visible.resize(size + count);
+        std::uint32_t* out = visible.data() + size;
+        std::size_t    i   = 0;
+#if SIMD_HAS_SSE2
+        // Les plans sont diffusés une fois : les écritures dans visible obligeraient sinon à les relire
+        __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for (int p = 0; p < 6; ++p) {
+            planeX[p] = _mm_set1_ps(planes[p].x);
+            planeY[p] = _mm_set1_ps(planes[p].y);
+            planeZ[p] = _mm_set1_ps(planes[p].z);
+            planeW[p] = _mm_set1_ps(planes[p].w);
+        }
+        for (; i + 4 <= count; i += 4) {
+            __m128 px = _mm_loadu_ps(x + i);
+            __m128 py = _mm_loadu_ps(y + i);
+            __m128 pz = _mm_loadu_ps(z + i);
+            __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < 6; ++p) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, planeX[p]), _mm_mul_ps(py, planeY[p])), _mm_add_ps(_mm_mul_ps(pz, planeZ[p]), planeW[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+            }
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; ++lane) {
+                *out = ids[i + lane];
+                out += (mask >> lane) & 1;
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            *out = ids[i];
+            out += intersectsSphere(glm::vec3(x[i], y[i], z[i]), r[i]) ? 1 : 0;
+        }
+        visible.resize(static_cast<std::size_t>(out - visible.data()));
+    }
+};
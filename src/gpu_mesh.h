@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include "p6/p6.h"
+#include "sphere.h"
+
+// Emplacements des attributs de sommet communs à tous les shaders
+#define VERTEX_ATTR_POSITION 0
+#define VERTEX_ATTR_NORMAL 1
+#define VERTEX_ATTR_TEXCOORDS 2
+
+// Maillage indexé conservé sur le GPU : sommets et indices sont envoyés une seule fois
+// à la construction, draw() ne fait que lier le VAO et dessiner.
+class GpuMesh {
+public:
+    GpuMesh(const ShapeVertex* vertices, GLsizei vertexCount, const GLuint* indices, GLsizei indexCount)
+        : m_indexCount(indexCount)
+    {
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ibo);
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(ShapeVertex), vertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
+        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)offsetof(ShapeVertex, position));
+        glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
+        glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)offsetof(ShapeVertex, normal));
+        glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORDS);
+        glVertexAttribPointer(VERTEX_ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid*)offsetof(ShapeVertex, texCoords));
+
+        // Le tampon d'indices est mémorisé par le VAO
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indices, GL_STATIC_DRAW);
+        glBindVertexArray(0);
+    }
+
+    explicit GpuMesh(const Sphere& sphere)
+        : GpuMesh(sphere.getDataPointer(), sphere.getVertexCount(), sphere.getIndexPointer(), sphere.getIndexCount())
+    {}
+
+    ~GpuMesh()
+    {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ibo);
+    }
+
+    GpuMesh(const GpuMesh&)            = delete;
+    GpuMesh& operator=(const GpuMesh&) = delete;
+
+    void draw() const
+    {
+        glBindVertexArray(m_vao);
+        glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
+        glBindVertexArray(0);
+    }
+
+    GLuint  vao() const { return m_vao; }
+    GLsizei indexCount() const { return m_indexCount; }
+
+private:
+    GLuint  m_vao = 0;
+    GLuint  m_vbo = 0;
+    GLuint  m_ibo = 0;
+    GLsizei m_indexCount = 0;
+};
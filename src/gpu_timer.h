@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "p6/p6.h"
+#include "profiler.h"
+
+// Minuteurs GPU (requêtes GL_TIME_ELAPSED). Les résultats sont relus LATENCY frames plus
+// tard pour ne jamais attendre le GPU ; ceux qui ne sont pas encore prêts sont perdus.
+// Ils sont transmis au profileur sur un fil « GPU », placés à l'instant CPU où la mesure
+// a commencé. Les requêtes GL_TIME_ELAPSED ne s'imbriquent pas : une seule portée à la fois.
+class GpuTimers {
+public:
+    static constexpr std::size_t LATENCY = 4;
+
+    GpuTimers() = default;
+    ~GpuTimers()
+    {
+        for (Frame& frame : m_frames) {
+            if (!frame.queries.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+            }
+        }
+    }
+
+    GpuTimers(const GpuTimers&)            = delete;
+    GpuTimers& operator=(const GpuTimers&) = delete;
+
+    // À appeler en début de frame : relit les mesures de la frame qui réutilise ces requêtes
+    void beginFrame()
+    {
+        m_current = (m_current + 1) % LATENCY;
+        Frame& frame = m_frames[m_current];
+        m_lastResults.clear();
+        for (std::size_t i = 0; i < frame.used; ++i) {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == 0) {
+                continue;
+            }
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+            const Section& section = frame.sections[i];
+            m_lastResults.emplace_back(section.name, static_cast<double>(elapsed) * 1e-6);
+            profiler().recordOnTrack(m_track, section.name, section.cpuStart, section.cpuStart + static_cast<std::int64_t>(elapsed));
+        }
+        frame.used = 0;
+        frame.sections.clear();
+    }
+
+    void begin(const char* name)
+    {
+        if (m_open || !profiler().enabled()) {
+            return;
+        }
+        Frame& frame = m_frames[m_current];
+        if (frame.used == frame.queries.size()) {
+            frame.queries.push_back(0);
+            glGenQueries(1, &frame.queries.back());
+        }
+        frame.sections.push_back({name, profiler().now()});
+        glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used++]);
+        m_open = true;
+    }
+
+    void end()
+    {
+        if (m_open) {
+            glEndQuery(GL_TIME_ELAPSED);
+            m_open = false;
+        }
+    }
+
+    // Durées (ms) relues au dernier beginFrame, mesurées LATENCY frames plus tôt
+    const std::vector<std::pair<const char*, double>>& lastResults() const { return m_lastResults; }
+
+    // Portée mesurée sur le GPU
+    class Scope {
+    public:
+        Scope(GpuTimers& timers, const char* name)
+            : m_timers(timers)
+        {
+            m_timers.begin(name);
+        }
+        ~Scope() { m_timers.end(); }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuTimers& m_timers;
+    };
+
+private:
+    struct Section {
+        const char*  name;
+        std::int64_t cpuStart;
+    };
+
+    struct Frame {
+        std::vector<GLuint>  queries; // Réutilisées d'une frame à l'autre
+        std::vector<Section> sections;
+        std::size_t          used = 0;
+    };
+
+    Frame                                       m_frames[LATENCY];
+    std::size_t                                 m_current = 0;
+    bool                                        m_open    = false;
+    std::vector<std::pair<const char*, double>> m_lastResults;
+    std::size_t                                 m_track = profiler().createTrack("GPU");
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Empreinte non cryptographique de 64 bits dérivée de FNV-1a, par mots de 8 octets pour
+// aller vite sur les gros OBJ. La multiplication ne propage les bits que vers le haut :
+// chaque mot est d'abord mélangé pour que ses octets de poids fort comptent aussi dans
+// les bits bas. Les derniers octets passent par FNV-1a, un par un.
+inline std::uint64_t hashBytes(std::string_view bytes, std::uint64_t hash = 14695981039346656037ull)
+{
+    constexpr std::uint64_t PRIME = 1099511628211ull;
+    constexpr std::uint64_t MIX   = 0x9e3779b97f4a7c15ull; // Partie fractionnaire du nombre d'or
+    std::size_t             i     = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        word *= MIX;
+        word ^= word >> 32;
+        hash = (hash ^ word) * PRIME;
+    }
+    for (; i < bytes.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * PRIME;
+    }
+    return hash;
+}
+
+// Empreinte du contenu brut d'un tableau d'objets (sans pointeurs ni octets de remplissage)
+template<typename T>
+std::uint64_t hashArray(const T* data, std::size_t count, std::uint64_t hash = 14695981039346656037ull)
+{
+    return hashBytes(std::string_view(reinterpret_cast<const char*>(data), count * sizeof(T)), hash);
+}
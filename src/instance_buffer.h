@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "glm/glm.hpp"
+#include "instance_data.h"
+#include "p6/p6.h"
+
+// Emplacements des attributs par instance dans shaders/3D_instanced.vs.glsl
+// (0 à 2 sont les attributs de sommet : position, normale, coordonnées de texture)
+#define INSTANCE_ATTR_MODEL_MATRIX 3  // 4 emplacements : 3 à 6
+#define INSTANCE_ATTR_NORMAL_MATRIX 7 // 3 emplacements : 7 à 9
+#define INSTANCE_ATTR_COLOR 10
+
+// Tampon d'attributs par instance, réécrit à chaque frame. Le stockage est « orphelin »
+// à chaque envoi (glBufferData avec nullptr) : le pilote fournit une nouvelle zone
+// mémoire au lieu d'attendre que le GPU ait fini de lire la précédente.
+class InstanceBuffer {
+public:
+    InstanceBuffer() { glGenBuffers(1, &m_vbo); }
+    ~InstanceBuffer() { glDeleteBuffers(1, &m_vbo); }
+
+    InstanceBuffer(const InstanceBuffer&)            = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Déclare les attributs par instance dans le VAO d'un modèle (une seule fois par VAO)
+    void attach(GLuint vao) const
+    {
+        glBindVertexArray(vao);
+        pointAttributes(0);
+        glBindVertexArray(0);
+    }
+
+    void upload(const std::vector<InstanceData>& instances)
+    {
+        m_count = static_cast<GLsizei>(instances.size());
+        m_capacity = std::max(m_capacity, instances.size());
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+
+    // Zone où écrire directement count instances, dans un stockage orphelin comme pour
+    // upload ; à écrire dans l'ordre sans la relire, puis à rendre par unmap avant de
+    // dessiner. nullptr si count vaut 0 ou si la projection échoue (rien ne sera dessiné).
+    InstanceData* map(std::size_t count)
+    {
+        m_count    = 0;
+        m_capacity = std::max(m_capacity, count);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        if (count == 0) {
+            return nullptr;
+        }
+        void* data = glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (data != nullptr) {
+            m_count = static_cast<GLsizei>(count);
+        }
+        return static_cast<InstanceData*>(data);
+    }
+
+    // Renvoie false si le contenu a été perdu (changement de mode vidéo…) : il n'y a
+    // alors rien à dessiner pour cette frame
+    bool unmap()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE) {
+            m_count = 0;
+            return false;
+        }
+        return true;
+    }
+
+    // Dessine toutes les instances envoyées en un seul appel
+    void draw(GLuint vao, GLsizei indexCount) const
+    {
+        if (m_count == 0) {
+            return;
+        }
+        glBindVertexArray(vao);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, m_count);
+    }
+
+    // Dessine instanceCount instances à partir de firstInstance avec la plage d'indices
+    // [firstIndex, firstIndex + indexCount) (un niveau de détail)
+    void draw(GLuint vao, GLuint firstIndex, GLsizei indexCount, GLsizei firstInstance, GLsizei instanceCount) const
+    {
+        if (instanceCount == 0) {
+            return;
+        }
+        glBindVertexArray(vao);
+        drawBound(firstIndex, indexCount, firstInstance, instanceCount);
+    }
+
+    // Comme draw, avec le VAO déjà lié (voir RenderQueue). Sans
+    // glDrawElementsInstancedBaseInstance (OpenGL 4.2), les attributs sont repointés sur
+    // la première instance ; ils reviennent au début du tampon à la fin.
+    void drawBound(GLuint firstIndex, GLsizei indexCount, GLsizei firstInstance, GLsizei instanceCount) const
+    {
+        if (firstInstance != 0) {
+            pointAttributes(static_cast<std::size_t>(firstInstance) * sizeof(InstanceData));
+        }
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (const GLvoid*)(firstIndex * sizeof(GLuint)), instanceCount);
+        if (firstInstance != 0) {
+            pointAttributes(0);
+        }
+    }
+
+private:
+    // Attributs par instance du VAO lié, à partir de l'octet `base` du tampon
+    void pointAttributes(std::size_t base) const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        for (int column = 0; column < 4; ++column) {
+            GLuint location = INSTANCE_ATTR_MODEL_MATRIX + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  (const GLvoid*)(base + offsetof(InstanceData, modelMatrix) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        for (int column = 0; column < 3; ++column) {
+            GLuint location = INSTANCE_ATTR_NORMAL_MATRIX + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  (const GLvoid*)(base + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glEnableVertexAttribArray(INSTANCE_ATTR_COLOR);
+        glVertexAttribPointer(INSTANCE_ATTR_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (const GLvoid*)(base + offsetof(InstanceData, color)));
+        glVertexAttribDivisor(INSTANCE_ATTR_COLOR, 1);
+    }
+
+    GLuint      m_vbo      = 0;
+    GLsizei     m_count    = 0;
+    std::size_t m_capacity = 0;
+};
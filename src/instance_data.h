@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+// Données d'une instance, lues par le vertex shader avec un diviseur de 1
+struct InstanceData {
+    glm::mat4 modelMatrix;
+    glm::mat3 normalMatrix; // Inverse transposée de la partie 3x3 de modelMatrix
+    glm::vec3 color;
+
+    // Translation suivie d'une mise à l'échelle uniforme : la matrice des normales
+    // se déduit directement, sans inversion
+    static InstanceData fromTranslationScale(const glm::vec3& position, float scale, const glm::vec3& color)
+    {
+        InstanceData instance;
+        instance.modelMatrix    = glm::mat4(scale);
+        instance.modelMatrix[3] = glm::vec4(position, 1.0f);
+        instance.normalMatrix   = glm::mat3(1.0f / scale);
+        instance.color          = color;
+        return instance;
+    }
+
+    // Translation, rotation puis échelle uniforme : pour M = s·R avec R orthonormée,
+    // l'inverse transposée vaut R / s
+    static InstanceData fromTranslationRotationScale(const glm::vec3& position, const glm::mat3& rotation, float scale, const glm::vec3& color)
+    {
+        InstanceData instance;
+        instance.modelMatrix    = glm::mat4(rotation * scale);
+        instance.modelMatrix[3] = glm::vec4(position, 1.0f);
+        instance.normalMatrix   = rotation * (1.0f / scale);
+        instance.color          = color;
+        return instance;
+    }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+#include "instance_data.h"
+#include "simd.h"
+
+// Positions d'un lot d'instances, rangées par composante (comme BoidSoA)
+struct InstancePositions {
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+};
+
+// out[i] = previous[i] + alpha * (current[i] - previous[i]) : une boucle simple, que le
+// compilateur vectorise seul
+inline void interpolatePositions(const float* previous, const float* current, float alpha, std::size_t count, float* out)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = previous[i] + alpha * (current[i] - previous[i]);
+    }
+}
+
+// Écrit count instances « translation puis échelle uniforme » : out[k] est placée en
+// positions[ids[k]] avec la couleur colors[ids[k]] (ids == nullptr : l'instance k elle-même).
+// Seules la translation et la couleur changent d'une instance à l'autre ; les autres
+// colonnes de modelMatrix et de normalMatrix (diagonales scale et 1 / scale) sont
+// préparées une fois. Les instances sont écrites dans l'ordre par mots de 16 octets et out
+// n'est jamais relu : il peut s'agir de la mémoire projetée d'un tampon (InstanceBuffer::map),
+// lente en lecture.
+inline void buildTranslationScaleInstances(const InstancePositions& positions, const glm::vec3* colors, const std::uint32_t* ids, std::size_t count,
+                                           float scale, InstanceData* out)
+{
+    std::size_t k = 0;
+#if SIMD_HAS_SSE2
+    static_assert(sizeof(InstanceData) == 28 * sizeof(float), "InstanceData : 16 + 9 + 3 flottants sans remplissage");
+    // Les 7 mots d'une instance : 3 colonnes de modelMatrix, la translation, puis
+    // normalMatrix et la couleur à cheval sur les mots (n = 1 / scale) :
+    //   (s 0 0 0) (0 s 0 0) (0 0 s 0) (x y z 1) (n 0 0 0) (n 0 0 0) (n r g b)
+    const float  inverse = 1.0f / scale;
+    const __m128 column0 = _mm_setr_ps(scale, 0.0f, 0.0f, 0.0f);
+    const __m128 column1 = _mm_setr_ps(0.0f, scale, 0.0f, 0.0f);
+    const __m128 column2 = _mm_setr_ps(0.0f, 0.0f, scale, 0.0f);
+    const __m128 normal  = _mm_setr_ps(inverse, 0.0f, 0.0f, 0.0f);
+    const __m128 one     = _mm_set1_ps(1.0f);
+
+    auto write = [&](float* o, __m128 translation, std::uint32_t id) {
+        const glm::vec3& color = colors[id];
+        _mm_storeu_ps(o + 0, column0);
+        _mm_storeu_ps(o + 4, column1);
+        _mm_storeu_ps(o + 8, column2);
+        _mm_storeu_ps(o + 12, translation);
+        _mm_storeu_ps(o + 16, normal);
+        _mm_storeu_ps(o + 20, normal);
+        _mm_storeu_ps(o + 24, _mm_setr_ps(inverse, color.r, color.g, color.b));
+    };
+
+    // Quatre instances à la fois : les composantes x, y, z de quatre positions sont
+    // transposées en quatre translations (x y z 1)
+    for (; k + 4 <= count; k += 4) {
+        std::uint32_t id[4];
+        __m128        x, y, z;
+        if (ids != nullptr) {
+            for (int lane = 0; lane < 4; ++lane) {
+                id[lane] = ids[k + lane];
+            }
+            x = _mm_setr_ps(positions.x[id[0]], positions.x[id[1]], positions.x[id[2]], positions.x[id[3]]);
+            y = _mm_setr_ps(positions.y[id[0]], positions.y[id[1]], positions.y[id[2]], positions.y[id[3]]);
+            z = _mm_setr_ps(positions.z[id[0]], positions.z[id[1]], positions.z[id[2]], positions.z[id[3]]);
+        } else {
+            for (int lane = 0; lane < 4; ++lane) {
+                id[lane] = static_cast<std::uint32_t>(k + lane);
+            }
+            x = _mm_loadu_ps(positions.x + k);
+            y = _mm_loadu_ps(positions.y + k);
+            z = _mm_loadu_ps(positions.z + k);
+        }
+        __m128 w = one;
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        float* o = reinterpret_cast<float*>(out + k);
+        write(o, x, id[0]);
+        write(o + 28, y, id[1]);
+        write(o + 56, z, id[2]);
+        write(o + 84, w, id[3]);
+    }
+#endif
+    for (; k < count; ++k) {
+        std::uint32_t id = ids != nullptr ? ids[k] : static_cast<std::uint32_t>(k);
+        out[k] = InstanceData::fromTranslationScale(glm::vec3(positions.x[id], positions.y[id], positions.z[id]), scale, colors[id]);
+    }
+}
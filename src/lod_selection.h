@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+#include "frame_arena.h"
+#include "mesh.h"
+
+// Choix du niveau de détail d'après la taille à l'écran de l'erreur de simplification :
+// une erreur de `error` unités vue à `distance` de la caméra couvre
+// error * pixelsPerUnit / distance pixels, pixelsPerUnit valant
+// hauteurFenêtre / (2 tan(fovY / 2)).
+struct LodSelection {
+    // Niveau des instances qui ne tiennent pas dans le budget (voir selectInstances)
+    static constexpr std::uint8_t SKIPPED = 0xFF;
+
+    float       pixelsPerUnit = 1.0f;
+    float       pixelError    = 1.0f;     // Erreur tolérée à l'écran, en pixels
+    std::size_t triangleBudget = 2000000; // Triangles dessinés au plus par modèle et par frame
+
+    static float pixelsPerUnitFor(float viewportHeight, float fovY) { return viewportHeight / (2.0f * std::tan(fovY * 0.5f)); }
+
+    // Niveau le plus grossier dont l'erreur projetée reste sous tolerance pixels
+    // (scale : mise à l'échelle du modèle ; lods ne doit pas être vide)
+    static std::size_t select(const std::vector<MeshLod>& lods, float scale, float distance, float pixelsPerUnit, float tolerance)
+    {
+        float allowed = tolerance * std::max(distance, 1e-4f) / (scale * pixelsPerUnit);
+        for (std::size_t level = lods.size(); level-- > 1;) {
+            if (lods[level].error <= allowed) {
+                return level;
+            }
+        }
+        return 0;
+    }
+
+    std::size_t select(const std::vector<MeshLod>& lods, float scale, float distance) const
+    {
+        return select(lods, scale, distance, pixelsPerUnit, pixelError);
+    }
+
+    // Niveau de chaque instance (distance à la caméra donnée par distanceOf(i)). Tant
+    // que le total de triangles dépasse le budget, la tolérance est doublée : les
+    // instances lointaines passent les premières à un niveau plus grossier. Si le budget
+    // est encore dépassé une fois toutes au niveau le plus grossier, les plus lointaines
+    // reçoivent le niveau SKIPPED et ne sont pas dessinées.
+    // Renvoie le nombre de triangles retenu, toujours dans le budget ; les tampons de
+    // travail sont pris dans arena.
+    template<typename DistanceFn>
+    std::size_t selectInstances(const std::vector<MeshLod>& lods, float scale, std::size_t instanceCount, DistanceFn&& distanceOf,
+                                std::vector<std::uint8_t>& levels, FrameArena& arena) const
+    {
+        constexpr int MAX_DOUBLINGS = 16;
+
+        levels.resize(instanceCount);
+        std::span<float> distances = arena.allocate<float>(instanceCount);
+        for (std::size_t i = 0; i < instanceCount; ++i) {
+            distances[i] = distanceOf(i);
+        }
+
+        float       tolerance = pixelError;
+        std::size_t triangles = 0;
+        for (int attempt = 0; attempt <= MAX_DOUBLINGS; ++attempt, tolerance *= 2.0f) {
+            triangles = 0;
+            for (std::size_t i = 0; i < instanceCount; ++i) {
+                levels[i] = static_cast<std::uint8_t>(select(lods, scale, distances[i], pixelsPerUnit, tolerance));
+                triangles += lods[levels[i]].indexCount / 3;
+            }
+            if (triangles <= triangleBudget) {
+                return triangles;
+            }
+        }
+
+        // Des plus proches aux plus lointaines, garder les instances qui tiennent encore
+        std::span<std::uint32_t> order = arena.allocate<std::uint32_t>(instanceCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return distances[a] < distances[b]; });
+        triangles = 0;
+        for (std::uint32_t i : order) {
+            std::size_t cost = lods[levels[i]].indexCount / 3;
+            if (triangles + cost <= triangleBudget) {
+                triangles += cost;
+            } else {
+                levels[i] = SKIPPED;
+            }
+        }
+        return triangles;
+    }
+};
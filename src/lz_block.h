@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Compression LZ77 rapide au format des blocs LZ4 : une suite de séquences « littéraux
+// puis recopie », chacune annoncée par un octet (4 bits de longueur de littéraux, 4 bits
+// de longueur de recopie), les longueurs dépassant 15 étant complétées par des octets de
+// 255. Les blocs sont indépendants et limités à 64 Kio, ce qui tient les décalages et la
+// table de hachage sur 16 bits. Pas de recherche exhaustive : une entrée par empreinte de
+// 4 octets, et un pas qui s'allonge dans les zones sans répétition pour les traverser vite.
+namespace lz {
+
+constexpr std::size_t MAX_BLOCK_SIZE = 1 << 16;
+constexpr std::size_t MIN_MATCH      = 4;
+constexpr std::size_t LAST_LITERALS  = 5;  // Le bloc se termine toujours par des littéraux
+constexpr std::size_t MATCH_LIMIT    = 12; // Pas de recopie commençant dans les 12 derniers octets
+constexpr int         HASH_BITS      = 13;
+constexpr int         SKIP_TRIGGER   = 6;  // Le pas augmente tous les 2^6 essais infructueux
+
+// Taille maximale d'un bloc compressé de size octets (données incompressibles)
+constexpr std::size_t compressBound(std::size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+namespace detail {
+
+inline std::uint32_t read32(const std::uint8_t* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t hash(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Longueur commune de a et b, sans dépasser limit (a < limit)
+inline std::size_t commonLength(const std::uint8_t* a, const std::uint8_t* b, const std::uint8_t* limit)
+{
+    const std::uint8_t* start = a;
+    while (a + 8 <= limit) {
+        std::uint64_t x, y;
+        std::memcpy(&x, a, 8);
+        std::memcpy(&y, b, 8);
+        if (std::uint64_t diff = x ^ y) {
+            return static_cast<std::size_t>(a - start) + static_cast<std::size_t>(std::countr_zero(diff) / 8);
+        }
+        a += 8, b += 8;
+    }
+    while (a < limit && *a == *b) {
+        ++a, ++b;
+    }
+    return static_cast<std::size_t>(a - start);
+}
+
+// Écrit le reste d'une longueur annoncée dans un demi-octet
+inline std::uint8_t* writeLength(std::uint8_t* op, std::size_t length)
+{
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = static_cast<std::uint8_t>(length);
+    return op;
+}
+
+} // namespace detail
+
+// Compresse src (au plus MAX_BLOCK_SIZE octets) dans dst. Renvoie la taille compressée,
+// ou 0 si elle dépasserait capacity (compressBound(size) suffit toujours).
+inline std::size_t compress(const std::uint8_t* src, std::size_t size, std::uint8_t* dst, std::size_t capacity)
+{
+    if (size > MAX_BLOCK_SIZE) {
+        return 0;
+    }
+    const std::uint8_t* const end    = src + size;
+    std::uint8_t*             op     = dst;
+    std::uint8_t* const       opEnd  = dst + capacity;
+    const std::uint8_t*       anchor = src;
+
+    // Une séquence : littéraux [anchor, anchor + literals) puis, si length > 0, recopie
+    auto emit = [&](std::size_t literals, std::size_t offset, std::size_t length) {
+        if (static_cast<std::size_t>(opEnd - op) < 1 + literals + literals / 255 + 1 + 2 + length / 255 + 1) {
+            return false;
+        }
+        std::uint8_t* token = op++;
+        *token              = static_cast<std::uint8_t>(std::min<std::size_t>(literals, 15) << 4);
+        if (literals >= 15) {
+            op = detail::writeLength(op, literals - 15);
+        }
+        if (literals > 0) {
+            std::memcpy(op, anchor, literals);
+            op += literals;
+        }
+        if (length > 0) {
+            *op++ = static_cast<std::uint8_t>(offset);
+            *op++ = static_cast<std::uint8_t>(offset >> 8);
+            std::size_t extra = length - MIN_MATCH;
+            *token |= static_cast<std::uint8_t>(std::min<std::size_t>(extra, 15));
+            if (extra >= 15) {
+                op = detail::writeLength(op, extra - 15);
+            }
+        }
+        return true;
+    };
+
+    if (size > MATCH_LIMIT) {
+        std::uint16_t             table[1 << HASH_BITS] = {};
+        const std::uint8_t* const matchEnd              = end - LAST_LITERALS;
+        const std::uint8_t* const searchEnd             = end - MATCH_LIMIT;
+        const std::uint8_t*       ip                    = src + 1;
+        while (ip < searchEnd) {
+            // Chercher une recopie, de plus en plus loin quand rien ne se répète
+            const std::uint8_t* match    = nullptr;
+            unsigned            attempts = 1u << SKIP_TRIGGER;
+            while (ip < searchEnd) {
+                std::uint32_t h = detail::hash(detail::read32(ip));
+                match           = src + table[h];
+                table[h]        = static_cast<std::uint16_t>(ip - src);
+                if (match < ip && detail::read32(match) == detail::read32(ip)) {
+                    break;
+                }
+                match = nullptr;
+                ip += attempts++ >> SKIP_TRIGGER;
+            }
+            if (match == nullptr) {
+                break;
+            }
+            // Étendre la recopie vers l'arrière, puis vers l'avant
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                --ip, --match;
+            }
+            std::size_t length = MIN_MATCH + detail::commonLength(ip + MIN_MATCH, match + MIN_MATCH, matchEnd);
+            if (!emit(static_cast<std::size_t>(ip - anchor), static_cast<std::size_t>(ip - match), length)) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+            if (ip < searchEnd) {
+                table[detail::hash(detail::read32(ip - 2))] = static_cast<std::uint16_t>(ip - 2 - src);
+            }
+        }
+    }
+    if (!emit(static_cast<std::size_t>(end - anchor), 0, 0)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(op - dst);
+}
+
+// Décompresse un bloc produit par compress : renvoie false si les données sont
+// corrompues ou ne redonnent pas exactement dstSize octets
+inline bool decompress(const std::uint8_t* src, std::size_t size, std::uint8_t* dst, std::size_t dstSize)
+{
+    const std::uint8_t* ip    = src;
+    const std::uint8_t* ipEnd = src + size;
+    std::uint8_t*       op    = dst;
+    std::uint8_t*       opEnd = dst + dstSize;
+
+    auto readLength = [&](std::size_t& length) {
+        std::uint8_t byte;
+        do {
+            if (ip == ipEnd) {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < ipEnd) {
+        std::uint8_t token    = *ip++;
+        std::size_t  literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) {
+            return false;
+        }
+        if (literals > static_cast<std::size_t>(ipEnd - ip) || literals > static_cast<std::size_t>(opEnd - op)) {
+            return false;
+        }
+        if (literals > 0) {
+            std::memcpy(op, ip, literals);
+            ip += literals;
+            op += literals;
+        }
+        if (ip == ipEnd) {
+            break; // Dernière séquence : littéraux seuls
+        }
+
+        if (ipEnd - ip < 2) {
+            return false;
+        }
+        std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !readLength(length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dst) || length > static_cast<std::size_t>(opEnd - op)) {
+            return false;
+        }
+        // Les recopies peuvent chevaucher leur source (offset < length) : octet par octet
+        const std::uint8_t* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            for (std::size_t i = 0; i < length; ++i) {
+                *op++ = match[i];
+            }
+        }
+    }
+    return op == opEnd;
+}
+
+} // namespace lz
@@ -1,4 +1,4 @@
-#include <cstdlib> // pour std::rand() et std::srand() et autre
+#include <cstdlib>
 #include <ctime>   // pour std::time()
 #define DOCTEST_CONFIG_IMPLEMENT
 #include "doctest/doctest.h"
@@ -9,46 +9,50 @@
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
+#include <limits>
 #include <map>
 #include <cmath>
+#include <chrono>
+#include <span>
 #include "imgui.h"
 #include "sphere.h"
+#include "asset_loader.h"
+#include "boid_soa.h"
+#include "bvh.h"
+#include "flock_simulator.h"
+#include "frame_arena.h"
+#include "gpu_mesh.h"
+#include "gpu_timer.h"
+#include "instance_buffer.h"
+#include "instance_transforms.h"
+#include "lod_selection.h"
+#include "mesh_cache.h"
+#include "profiler.h"
+#include "random.h"
+#include "render_queue.h"
+#include "shader_program.h"
+#include "simulation_thread.h"
+#include "thread_pool.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 #include <vector>
 #include <cmath>
 
-#define VERTEX_ATTR_POSITION 0
-#define VERTEX_ATTR_NORMAL 1
-#define VERTEX_ATTR_TEXCOORDS 2
-
-struct Boid {
-    glm::vec3 position;
-    glm::vec3 velocity;
-    bool isFemale;
-    float alignmentWeight;
-    float cohesionWeight;
-    float separationWeight;
-    float interactionRadius;
-    int markovState;
-    glm::vec3 color;
-    float lifespan;
-    float markovTime;
-};
+#define VERTEX_ATTR_ANIMATION_SLOT 3 // Après les attributs communs de gpu_mesh.h
 
 struct Model {
     GLuint vao; // Vertex Array Object
-    GLuint vbo; // Vertex Buffer Object
+    GLuint vbo; // Vertex Buffer Object (sommets entrelacés)
     GLuint ebo; // Element Buffer Object
-    GLuint vboNormals; // Vertex Buffer Object for normals
-    GLuint vboTexCoords; // Vertex Buffer Object for texture coordinates
-    int numVertices; // Number of vertices
+    int numIndices; // Nombre d'indices du maillage complet
+    std::vector<MeshLod> lods; // Niveaux de détail, du maillage complet au plus simplifié
     std::map<std::string, GLuint> materialTextureIDs; // Texture IDs per material
-    std::vector<glm::vec3> vertices; // Added member for storing vertices
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> texCoords;
-    std::vector<unsigned int> indices;
+    std::vector<MeshMaterial> materials; // Matériaux et leurs plages d'indices
+    glm::vec3 boundsMin; // Boîte englobante
+    glm::vec3 boundsMax;
+    glm::vec3 boundsCenter; // Sphère englobante, centrée sur la boîte (pour le découpage par la caméra)
+    float boundsRadius;
 };
 
 struct Surveyor {
@@ -64,87 +68,52 @@ struct TextureInfo {
     float scaleZ;
 };
 
-// Déclaration d'une structure pour stocker chaque frame de l'animation
-struct AnimationFrame {
-    Model model;
-    // Autres données nécessaires pour la frame, comme la position, l'orientation, etc.
+// Animation par sommets envoyée au GPU (voir VertexAnimation et shaders/3D_animated.vs.glsl)
+struct AnimatedModel {
+    GLuint vao = 0;
+    GLuint texCoordVBO = 0; // Coordonnées de texture de la topologie commune
+    GLuint slotVBO = 0; // Emplacement de chaque sommet dans la texture d'animation
+    GLuint ebo = 0;
+    GLuint texelBuffer = 0; // Texels de toutes les frames
+    GLuint texelTexture = 0; // Texture buffer sur texelBuffer
+    int numIndices = 0;
+    std::vector<MeshLod> lods;
+    int frameCount = 0;
+    int staticCount = 0;
+    int movingCount = 0;
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
 };
 
-float separationDistance = 0.1f; // Distance minimale de séparation des boids
 bool dayMode = true; // Mode jour ou nuit
-bool autoMode = false; // Mode jour ou nuit
 float transition = 0.0f; // Valeur de transition pour le fondu
 float elapsedTime = 0.0f; // Déclaration d'une variable pour suivre le temps écoulé depuis le début de l'animation
 
-// Facteurs de pondération pour les règles de comportement des boids
-float alignmentWeight = 0.1f;
-float cohesionWeight = 0.1f;
-
-// Facteurs pour la règle d'évitement de la caméra
-float distanceMinToCamera = 0.2f;
-float avoidanceWeight = 0.2f;
+// Distance entre la caméra et l'arpenteur
 float distanceToSurveyor = 2.0f;
 
 // Rayon du dôme
 float domeRadius = 2.0f;
 
-Model loadModel(const char* objPath, const char* mtlPath) {
-    Model model;
+// Envoie au GPU un maillage chargé (depuis son cache binaire ou son OBJ, voir LoadedMesh)
+Model uploadModel(const MeshView& view) {
+    Model model{};
 
-    // Open the OBJ file
-    std::ifstream file(objPath);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << objPath << std::endl;
-        return model;
-    }
-
-    // Open the MTL file
-    std::ifstream mtlFile(mtlPath);
-    if (!mtlFile.is_open()) {
-        std::cerr << "Error: Could not open file " << mtlPath << std::endl;
-        return model;
-    }
-
-    std::map<std::string, std::pair<std::string, glm::vec3>> materialTexturePaths;
-
-    // Process the MTL file
-    std::string lineTexture;
-    std::string currentMaterial;
-    while (std::getline(mtlFile, lineTexture)) {
-        std::istringstream iss(lineTexture);
-        std::string type;
-        iss >> type;
-        if (type == "newmtl") {
-            iss >> currentMaterial;
-        } else if (type == "map_Kd") {
-            std::string texturePath;
-            iss >> texturePath;
-            // Check if there are scaling parameters
-            glm::vec3 scaleParameters(1.0f);
-            if (texturePath == "-s") {
-                iss >> scaleParameters.x >> scaleParameters.y >> scaleParameters.z;
-                // Read the actual texture path
-                iss >> texturePath;
-            }
-            // Adjust texture path to match the directory structure
-            texturePath = "img/" + texturePath;
-            // Store the texture path along with its scaling parameters
-            materialTexturePaths[currentMaterial] = std::make_pair(texturePath, scaleParameters);
+    // Load textures and associate them with materials
+    for (std::size_t m = 0; m < view.materialCount; ++m) {
+        const MeshMaterial& material = view.materials[m];
+        model.materials.push_back(material);
+        if (material.texturePathView().empty()) {
+            continue;
         }
-    }
+        // Adjust texture path to match the directory structure
+        std::string texturePath = "img/" + std::string(material.texturePathView());
 
-    // Load textures and associate them with materials
-    for (const auto& [material, textureInfo] : materialTexturePaths) {
         // Log the texture path before loading
-        std::cout << "Loading texture for material: " << material << ", path: " << textureInfo.first << std::endl;
+        std::cout << "Loading texture for material: " << material.nameView() << ", path: " << texturePath << std::endl;
 
         // Load texture using p6::load_image or any other method you prefer
-        // For example:
-        p6::Image textureImage = p6::load_image(textureInfo.first.c_str(), true);
-
-        // Concatenate scaling parameters if present
-        std::string scaleParams = std::to_string(textureInfo.second.x) + " " + std::to_string(textureInfo.second.y) + " " + std::to_string(textureInfo.second.z);
-        std::string texturePathWithScale = textureInfo.first + " -s " + scaleParams;
+        p6::Image textureImage = p6::load_image(texturePath.c_str(), true);
 
         // Generate OpenGL texture and bind it
         GLuint textureID;
@@ -160,81 +129,42 @@ Model loadModel(const char* objPath, const char* mtlPath) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         // Associate texture with material
-        // You may need to modify your Model struct to store texture IDs per material
-        model.materialTextureIDs[material] = textureID;
+        model.materialTextureIDs[std::string(material.nameView())] = textureID;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
-        if (type == "v") {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            model.vertices.push_back(vertex);
-        } else if (type == "vn") {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            model.normals.push_back(normal);
-        } else if (type == "vt") {
-            glm::vec2 texCoord;
-            iss >> texCoord.s >> texCoord.t;
-            model.texCoords.push_back(texCoord);
-        } else if (type == "f") {
-            unsigned int vertexIndex1, vertexIndex2, vertexIndex3;
-            unsigned int normalIndex1, normalIndex2, normalIndex3;
-            unsigned int texCoordIndex1, texCoordIndex2, texCoordIndex3;
-            char slash;
-            iss >> vertexIndex1 >> slash >> normalIndex1 >> slash >> texCoordIndex1
-                >> vertexIndex2 >> slash >> normalIndex2 >> slash >> texCoordIndex2
-                >> vertexIndex3 >> slash >> normalIndex3 >> slash >> texCoordIndex3;
-
-            // OBJ indices start from 1, so we need to decrement them to match C++ indexing
-            model.indices.push_back(vertexIndex1 - 1);
-            model.indices.push_back(vertexIndex2 - 1);
-            model.indices.push_back(vertexIndex3 - 1);
-        }
+    model.numIndices = static_cast<int>(view.lod(0).indexCount);
+    for (std::size_t level = 0; level < std::max<std::size_t>(view.lodCount, 1); ++level) {
+        model.lods.push_back(view.lod(level));
+    }
+    model.boundsMin = view.boundsMin;
+    model.boundsMax = view.boundsMax;
+    model.boundsCenter = (view.boundsMin + view.boundsMax) * 0.5f;
+    model.boundsRadius = 0.0f;
+    for (std::size_t i = 0; i < view.vertexCount; ++i) {
+        model.boundsRadius = std::max(model.boundsRadius, glm::distance(view.vertices[i].position, model.boundsCenter));
     }
-
-    model.numVertices = model.indices.size();
 
     // Generate and bind VAO and VBO
     glGenVertexArrays(1, &model.vao);
     glGenBuffers(1, &model.vbo);
 
+    // Envoi direct des sommets entrelacés (depuis le cache projeté en mémoire le cas échéant)
     glBindVertexArray(model.vao);
     glBindBuffer(GL_ARRAY_BUFFER, model.vbo);
-    glBufferData(GL_ARRAY_BUFFER, model.vertices.size() * sizeof(glm::vec3), model.vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, view.vertexCount * sizeof(MeshVertex), view.vertices, GL_STATIC_DRAW);
 
-    // Set vertex attribute pointers for positions
-    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0); // Position attribute (aPos)
+    // Set vertex attribute pointers for positions, normals and texture coordinates
+    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)offsetof(MeshVertex, position));
     glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-
-    // Generate and bind VBO for normals
-    GLuint vboNormals;
-    glGenBuffers(1, &vboNormals);
-    glBindBuffer(GL_ARRAY_BUFFER, vboNormals);
-    glBufferData(GL_ARRAY_BUFFER, model.normals.size() * sizeof(glm::vec3), model.normals.data(), GL_STATIC_DRAW);
-
-    // Set vertex attribute pointers for normals
-    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0); // Normal attribute (aNormal)
+    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)offsetof(MeshVertex, normal));
     glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-
-    // Generate and bind VBO for texture coordinates
-    GLuint vboTexCoords;
-    glGenBuffers(1, &vboTexCoords);
-    glBindBuffer(GL_ARRAY_BUFFER, vboTexCoords);
-    glBufferData(GL_ARRAY_BUFFER, model.texCoords.size() * sizeof(glm::vec2), model.texCoords.data(), GL_STATIC_DRAW);
-
-    // Set vertex attribute pointers for texture coordinates
-    glVertexAttribPointer(VERTEX_ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0); // Texture coordinates attribute (aTexCoord)
+    glVertexAttribPointer(VERTEX_ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)offsetof(MeshVertex, texCoords));
     glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORDS);
 
     // Generate and bind EBO (Element Buffer Object)
     glGenBuffers(1, &model.ebo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, model.indices.size() * sizeof(unsigned int), model.indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, view.indexCount * sizeof(std::uint32_t), view.indices, GL_STATIC_DRAW);
 
     // Unbind VAO
     glBindVertexArray(0);
@@ -242,167 +172,254 @@ Model loadModel(const char* objPath, const char* mtlPath) {
     return model;
 }
 
-// Load the OBJ model
-Model newModel(const std::string& objFilePath, const std::string& mtlFilePath) {
-    Model model = loadModel(objFilePath.c_str(), mtlFilePath.c_str());
-    if (model.numVertices == 0) {
-        std::cerr << "Failed to load model" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-    return model;
+// Libère les objets OpenGL d'un modèle
+void deleteModel(const Model& model) {
+    glDeleteVertexArrays(1, &model.vao);
+    glDeleteBuffers(1, &model.vbo);
+    glDeleteBuffers(1, &model.ebo);
 }
 
-float random(float min, float max) {
-    return min + static_cast <float> (rand()) / (static_cast<float>(RAND_MAX + 1) / (max - min));
-}
-
-// Génère un nombre aléatoire dans l'intervalle [min, max]
-float linearRand(float min, float max) {
-    // Calcul de la plage de valeurs
-    float range = max - min;
-
-    // Génération d'un nombre aléatoire dans [0, RAND_MAX]
-    float randomNum = static_cast<float>(std::rand()) / RAND_MAX;
-
-    // Mise à l'échelle et translation du nombre pour qu'il soit dans [min, max]
-    return min + randomNum * range;
-}
-
-glm::vec3 customSphericalRand(float radius) {
-    float theta = random(0.0f, 2.0f * static_cast<float>(M_PI));
-    float phi = random(0.0f, static_cast<float>(M_PI));
+// Envoie au GPU une animation par sommets : la topologie commune dans un VAO et les
+// texels de toutes les frames dans une texture buffer lue par le vertex shader
+AnimatedModel uploadAnimation(const VertexAnimation& animation) {
+    AnimatedModel model;
+    model.numIndices = static_cast<int>(animation.indices.size());
+    model.lods = animation.lods;
+    if (model.lods.empty()) {
+        model.lods.push_back({0, static_cast<std::uint32_t>(animation.indices.size()), 0.0f});
+    }
+    model.frameCount = static_cast<int>(animation.frameCount);
+    model.staticCount = static_cast<int>(animation.staticCount);
+    model.movingCount = static_cast<int>(animation.movingCount);
+    model.boundsMin = animation.boundsMin;
+    model.boundsMax = animation.boundsMax;
 
-    float sinPhi = sin(phi);
+    glGenVertexArrays(1, &model.vao);
+    glBindVertexArray(model.vao);
 
-    float x = radius * sinPhi * cos(theta);
-    float y = radius * sinPhi * sin(theta);
-    float z = radius * cos(phi);
+    glGenBuffers(1, &model.texCoordVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, model.texCoordVBO);
+    glBufferData(GL_ARRAY_BUFFER, animation.texCoords.size() * sizeof(glm::vec2), animation.texCoords.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(VERTEX_ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (const GLvoid*)0);
+    glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORDS);
 
-    return glm::vec3(x, y, z);
-}
+    glGenBuffers(1, &model.slotVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, model.slotVBO);
+    glBufferData(GL_ARRAY_BUFFER, animation.slots.size() * sizeof(std::uint32_t), animation.slots.data(), GL_STATIC_DRAW);
+    glVertexAttribIPointer(VERTEX_ATTR_ANIMATION_SLOT, 1, GL_UNSIGNED_INT, sizeof(std::uint32_t), (const GLvoid*)0);
+    glEnableVertexAttribArray(VERTEX_ATTR_ANIMATION_SLOT);
 
-// Définir une fonction pour générer aléatoirement l'état de l'interrupteur (jour ou nuit) avec une distribution de Poisson
-bool generateSwitchState(float lambda) {
-    // Générer un nombre aléatoire selon la distribution de Poisson
-    int k = 0;
-    float p = 1.0;
-    float L = std::exp(-lambda);
-    float randVal = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-
-    while (p > L) {
-        k++;
-        randVal *= static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-        p *= randVal;
-    }
+    glGenBuffers(1, &model.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, animation.indices.size() * sizeof(std::uint32_t), animation.indices.data(), GL_STATIC_DRAW);
 
-    // Si le nombre de "cliques" est impair, c'est la nuit, sinon c'est le jour
-    return (k % 2 == 0);
-}
+    glBindVertexArray(0);
 
-float generateStateChangeTime(float lambda) {
-    return -log(1.0f - static_cast<float>(rand()) / static_cast<float>(RAND_MAX)) / lambda;
-}
+    glGenBuffers(1, &model.texelBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, model.texelBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, animation.texels.size() * sizeof(VertexAnimation::Texel), animation.texels.data(), GL_STATIC_DRAW);
+    glGenTextures(1, &model.texelTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, model.texelTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA16UI, model.texelBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
 
-float generateExp(float lambda) {
-    return -log(1.0f - static_cast<float>(rand()) / static_cast<float>(RAND_MAX)) / lambda;
+    return model;
 }
 
-int countNeighbors(const Boid& boid, const std::vector<Boid>& boids, int numBoids) {
-    int count = 0;
-    for (int i = 0; i < numBoids; ++i) {
-        if (&boid != &boids[i]) {
-            float distance = glm::distance(boid.position, boids[i].position);
-            if (distance < 1.0f) {
-                ++count;
-            }
-        }
-    }
-    return count;
+void deleteAnimation(const AnimatedModel& model) {
+    glDeleteVertexArrays(1, &model.vao);
+    glDeleteBuffers(1, &model.texCoordVBO);
+    glDeleteBuffers(1, &model.slotVBO);
+    glDeleteBuffers(1, &model.ebo);
+    glDeleteBuffers(1, &model.texelBuffer);
+    glDeleteTextures(1, &model.texelTexture);
 }
 
-void updateMarkovState(Boid& boid, const std::vector<Boid>& boids, int numBoids) {
-    int neighborCount = countNeighbors(boid, boids, numBoids);
-    
-    // Si le boid a plus de 5 voisins, changer son état de la chaîne de Markov
-    if (neighborCount > 5) {
-        boid.markovState = 1;
-    } else {
-        boid.markovState = 0;
+// Maillage de remplacement (une sphère) affiché tant que le vrai modèle n'est pas chargé
+MeshData placeholderMesh() {
+    Sphere sphere(0.5f, 16, 8);
+    MeshData mesh;
+    for (GLsizei i = 0; i < sphere.getVertexCount(); ++i) {
+        const ShapeVertex& vertex = sphere.getDataPointer()[i];
+        mesh.vertices.push_back({vertex.position, vertex.normal, vertex.texCoords});
     }
+    mesh.indices.assign(sphere.getIndexPointer(), sphere.getIndexPointer() + sphere.getIndexCount());
+    mesh.computeBounds();
+    return mesh;
 }
 
 // Fonction pour obtenir la couleur en fonction du mode jour/nuit et du type de boid
-glm::vec3 getBoidColor(bool markovState, bool isFemale) {
-    float transitionDuration = generateExp(5); // Générer la durée de transition avec une distribution exponentielle
+// (transitionDuration : durée de transition tirée selon une loi exponentielle, baseColor :
+// couleur de l'espèce)
+glm::vec3 getBoidColor(bool markovState, bool isFemale, float transitionDuration, glm::vec3 baseColor) {
     if (markovState) {
         // Couleur des boids pendant le jour
         if (isFemale && transitionDuration > 0.0f) {
             // Calculer le facteur de transition en fonction du temps écoulé
             float transitionFactor = 1.0f - glm::clamp(transitionDuration, 0.0f, 1.0f);
             // Appliquer la transition vers le rouge
-            return glm::mix(glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), transitionFactor);
+            return glm::mix(baseColor, glm::vec3(1.0f, 0.0f, 0.0f), transitionFactor);
         } else {
-            // Retourner la couleur blanche pour les autres boids ou lorsque la transition est terminée
-            return glm::vec3(1.0f, 1.0f, 1.0f);
+            // Retourner la couleur de l'espèce pour les autres boids ou lorsque la transition est terminée
+            return baseColor;
         }
     } else {
         // Couleur des boids pendant la nuit
-        return glm::vec3(1.0f, 1.0f, 1.0f);
+        return baseColor;
     }
 }
 
 
-void changeModelDetail(Model& model, int targetNumVertices) {
-    // Obtenez le nombre actuel de sommets du modèle
-    int currentNumVertices = model.numVertices;
+// Tri par comptage des instances selon leur niveau de détail : order[k] est l'indice de la
+// k-ième instance une fois rangées, celles du niveau l occupant [first[l], first[l + 1]).
+// Les instances de niveau LodSelection::SKIPPED sont laissées de côté.
+struct LodOrder {
+    std::span<GLsizei>       first;
+    std::span<std::uint32_t> order;
+};
 
-    // Si le nombre de sommets actuel est inférieur ou égal à la cible,
-    // il n'est pas nécessaire de simplifier le maillage
-    if (currentNumVertices <= targetNumVertices) {
-        return;
+LodOrder sortByLod(const std::vector<std::uint8_t>& levels, std::size_t lodCount, FrameArena& arena) {
+    LodOrder result;
+    result.first = arena.allocate<GLsizei>(lodCount + 1);
+    for (std::uint8_t level : levels) {
+        if (level != LodSelection::SKIPPED) {
+            ++result.first[level + 1];
+        }
     }
+    for (std::size_t level = 0; level < lodCount; ++level) {
+        result.first[level + 1] += result.first[level];
+    }
+    std::span<GLsizei> cursor = arena.copy(result.first.data(), result.first.data() + lodCount);
+    result.order = arena.allocate<std::uint32_t>(static_cast<std::size_t>(result.first[lodCount]));
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        if (levels[i] != LodSelection::SKIPPED) {
+            result.order[cursor[levels[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+    return result;
+}
 
-    // Calculez le ratio de simplification
-    float simplificationRatio = static_cast<float>(targetNumVertices) / static_cast<float>(currentNumVertices);
-
-    // Appliquez la simplification en réduisant le nombre de sommets
-    int newNumVertices = static_cast<int>(currentNumVertices * simplificationRatio);
-
-    // Réduisez le nombre de sommets en supprimant les derniers sommets excédentaires
-    model.vertices.resize(newNumVertices);
-
-    // Mettez à jour les données du VBO avec les nouveaux sommets
-    glBindBuffer(GL_ARRAY_BUFFER, model.vbo);
-    glBufferData(GL_ARRAY_BUFFER, model.vertices.size() * sizeof(glm::vec3), model.vertices.data(), GL_STATIC_DRAW);
+// Enregistre un paquet instancié par niveau de détail, à la profondeur de son instance la
+// plus proche (depthOf(k) : distance à la caméra de la k-ième instance rangée). Renvoie le
+// nombre de triangles enregistrés.
+template<typename DepthFn>
+std::size_t recordLodPackets(RenderQueue<ShaderProgram>& queue, const ShaderProgram& program, const InstanceBuffer& buffer,
+                             const Model& model, std::span<const GLsizei> firstInstance, DepthFn&& depthOf) {
+    std::size_t triangles = 0;
+    for (std::size_t level = 0; level < model.lods.size(); ++level) {
+        GLsizei count = firstInstance[level + 1] - firstInstance[level];
+        if (count == 0) {
+            continue;
+        }
+        DrawPacket<ShaderProgram> packet;
+        packet.program = &program;
+        packet.vao = model.vao;
+        packet.firstIndex = model.lods[level].firstIndex;
+        packet.indexCount = static_cast<GLsizei>(model.lods[level].indexCount);
+        packet.instances = &buffer;
+        packet.firstInstance = firstInstance[level];
+        packet.instanceCount = count;
+        packet.depth = std::numeric_limits<float>::max();
+        for (GLsizei k = firstInstance[level]; k < firstInstance[level + 1]; ++k) {
+            packet.depth = std::min(packet.depth, depthOf(static_cast<std::size_t>(k)));
+        }
+        queue.push(packet);
+        triangles += static_cast<std::size_t>(count) * model.lods[level].indexCount / 3;
+    }
+    return triangles;
+}
 
-    // Mettez à jour le nombre de sommets du modèle
-    model.numVertices = newNumVertices;
+// Range les instances par niveau de détail, les envoie au GPU puis enregistre un paquet
+// instancié par niveau. Renvoie le nombre de triangles enregistrés.
+std::size_t recordInstancesByLod(RenderQueue<ShaderProgram>& queue, const ShaderProgram& program, InstanceBuffer& buffer,
+                                 const Model& model, const std::vector<InstanceData>& instances,
+                                 const std::vector<std::uint8_t>& levels, std::vector<InstanceData>& sorted,
+                                 const glm::vec3& cameraPosition, FrameArena& arena) {
+    LodOrder lodOrder = sortByLod(levels, model.lods.size(), arena);
+    sorted.resize(lodOrder.order.size());
+    for (std::size_t k = 0; k < sorted.size(); ++k) {
+        sorted[k] = instances[lodOrder.order[k]];
+    }
+    buffer.upload(sorted);
+    return recordLodPackets(queue, program, buffer, model, lodOrder.first,
+                            [&](std::size_t k) { return glm::distance(glm::vec3(sorted[k].modelMatrix[3]), cameraPosition); });
 }
 
-std::vector<AnimationFrame> animationFrames;
-// Déclarer une variable pour suivre l'indice de la frame actuelle
-int currentFrameIndex = 0;
-
-// Définir une fonction pour animer les frames
-void animateFrames(float deltaTime) {
-    // Incrémenter l'indice de la frame en fonction du temps écoulé
-    currentFrameIndex = (currentFrameIndex + 1) % animationFrames.size();
-
-    // Ton code pour afficher la frame actuelle ici
-    Model currentFrameModel = animationFrames[currentFrameIndex].model;
-    // Afficher la frame dans la scène
-    // Par exemple :
-    glBindVertexArray(currentFrameModel.vao);
-    glDrawElements(GL_TRIANGLES, currentFrameModel.numVertices, GL_UNSIGNED_INT, 0);
+// Fenêtre « Profiler » : portées de la dernière frame complète, fil par fil, et dernières
+// mesures GPU ; le bouton d'export écrit tous les événements en mémoire au format Chrome.
+// threads garde ses tampons d'une frame à l'autre ; rien n'est relu tant que le profileur
+// est désactivé.
+void drawProfilerWindow(const GpuTimers& gpuTimers, std::vector<Profiler::ThreadEvents>& threads, std::string& exportMessage) {
+    ImGui::Begin("Profiler");
+    bool enabled = profiler().enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        profiler().setEnabled(enabled);
+    }
+    auto [frameStart, frameEnd] = profiler().lastFrame();
+    ImGui::Text("Frame: %.2f ms", (frameEnd - frameStart) * 1e-6);
+    if (enabled) {
+        profiler().collect(frameStart, frameEnd, threads);
+    } else {
+        threads.clear();
+    }
+    for (Profiler::ThreadEvents& thread : threads) {
+        if (thread.events.empty()) {
+            continue;
+        }
+        // Rangés par ordre de fin, les parents suivent leurs enfants : on les remet dans l'ordre de début
+        std::sort(thread.events.begin(), thread.events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+            return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+        });
+        ImGui::Separator();
+        ImGui::Text("%s", thread.name.c_str());
+        for (const ProfileEvent& event : thread.events) {
+            ImGui::Text("%*s%s: %.3f ms", static_cast<int>(2 * event.depth), "", event.name, (event.end - event.start) * 1e-6);
+        }
+    }
+    if (!gpuTimers.lastResults().empty()) {
+        ImGui::Separator();
+        ImGui::Text("GPU (%zu frames ago)", GpuTimers::LATENCY);
+        for (const auto& [name, milliseconds] : gpuTimers.lastResults()) {
+            ImGui::Text("%s: %.3f ms", name, milliseconds);
+        }
+    }
+    ImGui::Separator();
+    if (ImGui::Button("Export Chrome trace")) {
+        std::ofstream file("profile_trace.json");
+        profiler().writeChromeTrace(file);
+        exportMessage = file ? "Written to profile_trace.json" : "Could not write profile_trace.json";
+    }
+    if (!exportMessage.empty()) {
+        ImGui::Text("%s", exportMessage.c_str());
+    }
+    ImGui::End();
 }
 
-int main() {
+int main(int argc, char** argv) {
     auto ctx = p6::Context{{1280, 720, "pacman revenge"}};
     ctx.maximize_window();
-    std::srand(std::time(nullptr));
+    const auto randomSeed = static_cast<std::uint64_t>(std::time(nullptr));
+    seedRandom(randomSeed);
 
     // Load shaders using Shader class
-    p6::Shader shader = p6::load_shader("shaders/3D.vs.glsl", "shaders/normals.fs.glsl");
+    ShaderProgram shader(p6::load_shader("shaders/3D.vs.glsl", "shaders/normals.fs.glsl"));
+    // Variante instanciée : matrice du modèle, des normales et couleur lues par instance
+    ShaderProgram instancedShader(p6::load_shader("shaders/3D_instanced.vs.glsl", "shaders/normals.fs.glsl"));
+    // Shader de l'arpenteur : animation par sommets interpolée entre deux frames
+    ShaderProgram animatedShader(p6::load_shader("shaders/3D_animated.vs.glsl", "shaders/normals.fs.glsl"));
+
+    // Caméra et lumière de l'arpenteur, partagées par les trois programmes via un UBO
+    UniformBuffer<CameraUniforms> cameraUniforms(CameraUniforms::BINDING);
+    for (const ShaderProgram* program : {&shader, &instancedShader, &animatedShader}) {
+        program->bindBlock(CameraUniforms::BLOCK, CameraUniforms::BINDING);
+    }
+    // Uniformes constants d'un programme à l'autre : envoyés une seule fois
+    instancedShader.use();
+    instancedShader.set("uDomeColor"_uniform, glm::vec4(1.0f));
+    animatedShader.use();
+    animatedShader.set("uDomeColor"_uniform, glm::vec4(1.0f));
+    animatedShader.set("uAnimationTexels"_uniform, 0);
 
     // Enable depth test
     glEnable(GL_DEPTH_TEST);
@@ -413,36 +430,95 @@ int main() {
 
     // Declare variables for ImGui sliders
     int numBoids = 25;
+    const int maxBoids = 100000; // Assez pour que le découpage par BVH et les niveaux de détail comptent
     float speedBoids = 2.5f;
     float boidSize = 0.05f;
 
-    // Create boids
-    std::vector<Boid> boids(numBoids);
-    for (auto& boid : boids) {
-        boid.position = glm::vec3(linearRand(-domeRadius, domeRadius),
-                                      linearRand(-domeRadius, domeRadius),
-                                      linearRand(-domeRadius, domeRadius));
-
-        boid.velocity = customSphericalRand(speedBoids);
-        
-        // Définir aléatoirement si le boid est une femelle
-        boid.isFemale = (rand() % 2 == 0);
-
-        // État initial de la chaîne de Markov
-        boid.markovState = 0;
-        
-        // Initialiser markovTime avec une valeur aléatoire entre 0 et la première transition
-        boid.markovTime = generateStateChangeTime(5);
-
-        // Générer la durée de vie du boid
-        boid.lifespan = generateExp(1);
+    // Simulation du troupeau, répartie sur tous les cœurs, à pas fixe sur son propre thread
+    ThreadPool threadPool;
+    FlockSimulator simulator(threadPool);
+    simulator.setSeed(randomSeed);
+    FlockParams flockParams;
+    flockParams.domeRadius = domeRadius;
+    float simulationRate = 60.0f; // Pas de simulation par seconde
+    float renderRate = 60.0f; // Images par seconde maximales du rendu (0 : synchronisé avec l'écran)
+
+    // Toute la plage du curseur est réservée : ajouter ou retirer des boids ne réalloue rien.
+    // Les boids naissent au premier pas, tirés par le simulateur d'après sa graine.
+    simulator.reserve(maxBoids);
+
+    // Deux espèces : les fantômes, et des feux follets moins nombreux et plus nerveux
+    // (rayon d'interaction réduit, alignement fort), qui suivent les fantômes alors que
+    // ceux-ci les remarquent à peine. Fixées pour toute la partie (voir SimulationRecorder).
+    const std::size_t ghostSpecies = 0;
+    const std::size_t wispSpecies = 1;
+    SpeciesParams ghostParams;
+    ghostParams.share = 0.75f;
+    SpeciesParams wispParams;
+    wispParams.interactionRadius = 0.6f;
+    wispParams.separationWeight = 1.5f;
+    wispParams.alignmentWeight = 1.5f;
+    wispParams.cohesionWeight = 0.5f;
+    wispParams.share = 0.25f;
+    wispParams.color = glm::vec3(0.4f, 1.0f, 0.8f);
+    SpeciesTable species({ghostParams, wispParams});
+    species.setInteraction(ghostSpecies, wispSpecies, 0.2f);
+    simulator.setSpecies(species);
+    SimulationRecorder recorder; // Déclarés avant le thread, qui s'en sert jusqu'à son arrêt
+    SnapshotWriter snapshotWriter;
+    SimulationThread simulationThread(simulator);
+
+    // --record <fichier> : journal de la partie, à rejouer sans fenêtre avec flock_replay
+    // --snapshot <fichier> : état des boids à chaque pas, à lire avec flock_snapshot
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--record") {
+            if (recorder.open(argv[i + 1], simulator)) {
+                simulationThread.setRecorder(&recorder);
+            } else {
+                std::cerr << "Could not record to " << argv[i + 1] << std::endl;
+            }
+        } else if (std::string(argv[i]) == "--snapshot") {
+            if (snapshotWriter.open(argv[i + 1])) {
+                simulationThread.setSnapshotWriter(&snapshotWriter);
+            } else {
+                std::cerr << "Could not write snapshots to " << argv[i + 1] << std::endl;
+            }
+        }
     }
-
-    // Load the OBJ model
-    Model ghostModel = newModel("assets/models/pacman_ghost_cube_v4.obj","assets/models/pacman_ghost_cube_v4.mtl");
-
-    // Load the OBJ model
-    Model switchModel = newModel("assets/models/seance6_switch.obj","assets/models/seance6_switch.mtl");
+    simulationThread.setStepRate(simulationRate);
+    simulationThread.setInputs({flockParams, numBoids, speedBoids});
+    simulationThread.start();
+    ctx.framerate_capped_at(renderRate);
+    std::uint64_t seenSwitchEvents = 0;
+
+    // Chargement asynchrone des modèles : fantôme, interrupteur puis l'animation de l'arpenteur,
+    // dont les frames sont regroupées en une seule animation par sommets.
+    // Une sphère les remplace à l'écran tant qu'ils ne sont pas prêts.
+    int numFrames = 20;
+    std::vector<AssetLoader::MeshRequest> meshRequests = {
+        {"assets/models/pacman_ghost_cube_v4.obj", "assets/models/pacman_ghost_cube_v4.mtl"},
+        {"assets/models/seance6_switch.obj", "assets/models/seance6_switch.mtl"},
+    };
+    AssetLoader::AnimationRequest surveyorFrames;
+    for (int i = 0; i < numFrames; ++i) {
+        std::string objFilePath = "assets/models/pacman_cube_v3/pacman_cube_v3" + std::to_string(i+1) + ".obj";
+        std::string mtlFilePath = "assets/models/pacman_cube_v3/pacman_cube_v3" + std::to_string(i+1) + ".mtl";
+        surveyorFrames.frames.push_back({objFilePath, mtlFilePath});
+    }
+    const std::size_t ghostAsset = 0;
+    const std::size_t switchAsset = 1;
+    AssetLoader assetLoader(std::move(meshRequests), {std::move(surveyorFrames)});
+    float uploadBudgetMs = 2.0f; // Temps d'envoi au GPU accordé par frame
+
+    // Le fantôme et l'interrupteur ont chacun leur copie, leur VAO recevant des attributs par instance différents
+    MeshData placeholder = placeholderMesh();
+    Model placeholderModel = uploadModel(placeholder.view());
+    Model ghostModel = uploadModel(placeholder.view());
+    Model wispModel = uploadModel(placeholder.view()); // Les feux follets gardent la sphère
+    Model switchModel = uploadModel(placeholder.view());
+    AnimatedModel surveyorAnimation; // vao == 0 tant que l'animation n'est pas chargée
+    std::size_t surveyorAnimationBytes = 0;
+    float animationDuration = 1.0f; // Durée totale de l'animation (en secondes)
 
     int numberOfSwitch = 10;
     std::vector<glm::vec3> switchPos(numberOfSwitch);
@@ -454,49 +530,104 @@ int main() {
         switchPos[i] = glm::vec3(randomNumberX, randomNumberY, randomNumberZ);
     }
 
+    // Attributs par instance des fantômes et des interrupteurs, rangés par niveau de détail
+    // et réécrits à chaque frame
+    InstanceBuffer ghostInstances;
+    ghostInstances.attach(ghostModel.vao);
+    InstanceBuffer wispInstances;
+    wispInstances.attach(wispModel.vao);
+    std::vector<glm::vec3> ghostColors;
+    std::vector<float> ghostTransitions; // Durées de transition des couleurs, tirées par lot à chaque frame
+
+    InstanceBuffer switchInstances;
+    switchInstances.attach(switchModel.vao);
+    std::vector<InstanceData> switchInstanceData;
+    for (int i = 0; i < numberOfSwitch; ++i) {
+        glm::vec3 switchColor = glm::vec3(1.0f, 1.0f, 1.0f); // White color for switch
+        switchInstanceData.push_back(InstanceData::fromTranslationScale(switchPos[i], 0.5f, switchColor));
+    }
+    std::vector<InstanceData> sortedInstances;
+    std::vector<std::uint8_t> instanceLevels;
+
+    // Découpage par la caméra : une hiérarchie de sphères englobantes par modèle, réajustée à
+    // chaque frame ; seules les instances visibles sont envoyées au GPU
+    BoundingVolumeHierarchy ghostHierarchy;
+    BoundingVolumeHierarchy wispHierarchy;
+    BoundingVolumeHierarchy switchHierarchy;
+    std::vector<std::uint32_t> visibleIds;
+    std::vector<InstanceData> visibleInstances;
+    std::size_t visibleGhosts = 0; // Valeurs de la frame précédente, affichées dans les réglages
+    double cullingMilliseconds = 0.0;
+
+    // Niveaux de détail choisis d'après l'erreur de simplification projetée à l'écran
+    LodSelection lodSelection;
+    int triangleBudget = static_cast<int>(lodSelection.triangleBudget);
+    std::size_t trianglesDrawn = 0; // Triangles de la frame précédente, affichés dans les réglages
+
     // Create surveyor
     Surveyor surveyor;
     surveyor.position = glm::vec3{0.0f, -2.75f, 1.0f};
     surveyor.rotationAngle = 0.0f;
     surveyor.speed = 2.5f;
-    int targetNumVertices = ghostModel.numVertices;
 
-    // Load the OBJ model
-    // Vecteur pour stocker toutes les frames de l'animation
-    // Chargement de chaque frame de l'animation depuis les fichiers OBJ et MTL
-    int numFrames = 20;
-    for (int i = 0; i < numFrames; ++i) {
-        std::string objFilePath = "assets/models/pacman_cube_v3/pacman_cube_v3" + std::to_string(i+1) + ".obj";
-        std::string mtlFilePath = "assets/models/pacman_cube_v3/pacman_cube_v3" + std::to_string(i+1) + ".mtl";
-        // Convertir les std::string en const char *
-        const char *objPath = objFilePath.c_str();
-        const char *mtlPath = mtlFilePath.c_str();
-        Model model = loadModel(objPath, mtlPath);
-        if (model.numVertices == 0) {
-            std::cerr << "Failed to load model" << std::endl;
-            return -1;
-        }
-        // Ajouter la frame chargée au vecteur
-        animationFrames.push_back({model});
-    }
+    // Create dome : envoyé une fois au GPU, chaque frame ne fait que le dessiner
+    GpuMesh dome(Sphere(domeRadius, 32, 16));
+
+    // Dessins de la frame, triés par état puis soumis en une fois
+    RenderQueue<ShaderProgram> renderQueue;
+    GlRenderBackend renderBackend;
 
-    // Create dome
-    Sphere dome(domeRadius, 32, 16);
-    GLuint domeVBO, domeVAO;
-    glGenBuffers(1, &domeVBO);
-    glGenVertexArrays(1, &domeVAO);
+    // Tampons de travail de la frame (niveaux de détail, regroupement des instances), libérés en bloc au début de la suivante
+    FrameArena frameArena;
 
+    // Profileur : portées CPU de chaque fil et minuteurs GPU, affichés dans la fenêtre « Profiler »
+    profiler().setThreadName("Render");
+    GpuTimers gpuTimers;
+    std::vector<Profiler::ThreadEvents> profilerThreads;
+    std::string profilerMessage;
 
     // Boucle de mise à jour des boids
     ctx.update = [&]() {
+        profiler().beginFrame();
+        gpuTimers.beginFrame();
+        frameArena.reset();
+        PROFILE_SCOPE("Frame");
+
+        // Envoyer au GPU les modèles chargés entre-temps, dans la limite du budget de la frame
+        assetLoader.uploadReady(uploadBudgetMs, [&](const AssetLoader::LoadedAsset& asset) {
+            PROFILE_SCOPE("Asset upload");
+            if (!asset.ok) {
+                std::cerr << "Failed to load model " << assetLoader.path(asset.id) << std::endl;
+                return;
+            }
+            if (asset.id != ghostAsset && asset.id != switchAsset) {
+                surveyorAnimation = uploadAnimation(asset.animation);
+                surveyorAnimationBytes = asset.animation.byteSize();
+                animatedShader.use();
+                animatedShader.set("uFrameCount"_uniform, surveyorAnimation.frameCount);
+                animatedShader.set("uStaticCount"_uniform, surveyorAnimation.staticCount);
+                animatedShader.set("uMovingCount"_uniform, surveyorAnimation.movingCount);
+                animatedShader.set("uBoundsMin"_uniform, surveyorAnimation.boundsMin);
+                animatedShader.set("uBoundsExtent"_uniform, surveyorAnimation.boundsMax - surveyorAnimation.boundsMin);
+                return;
+            }
+            Model model = uploadModel(asset.mesh.view());
+            if (asset.id == ghostAsset) {
+                deleteModel(ghostModel);
+                ghostModel = model;
+                ghostInstances.attach(ghostModel.vao);
+            } else {
+                deleteModel(switchModel);
+                switchModel = model;
+                switchInstances.attach(switchModel.vao);
+            }
+        });
+
         glm::vec3 backgroundColor = dayMode ? glm::vec3{0.06, 0.03, 0.5} : glm::vec3{0.0, 0.0, 0.5}; 
         backgroundColor = glm::mix(backgroundColor, glm::vec3{0.8, 0.9, 1.0}, transition); 
         ctx.background(p6::Color{backgroundColor.r, backgroundColor.g, backgroundColor.b}); 
 
         float deltaTime = ctx.delta_time();
-        
-        // Appeler la fonction d'animation des frames
-        animateFrames(deltaTime);
 
         // Handle input for moving the surveyor
         if (ctx.key_is_pressed(GLFW_KEY_LEFT) && (-domeRadius < surveyor.position.x)) {
@@ -544,254 +675,203 @@ int main() {
         glm::mat4 MVMatrix = glm::lookAt(cameraPosition, cameraPosition + cameraDirection, glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
 
-        shader.use();
-        shader.set("uMVPMatrix", ProjMatrix * MVMatrix);
-        shader.set("uMVMatrix", MVMatrix);
-        shader.set("uNormalMatrix", NormalMatrix);
+        // Une seule mise à jour du bloc Camera par frame, quel que soit le nombre d'objets
+        cameraUniforms.update({ProjMatrix * MVMatrix, MVMatrix, NormalMatrix, glm::vec4(surveyor.position, 1.0f)});
 
         ImGui::Begin("Settings");
-        ImGui::SliderInt("Number of Boids", &numBoids, 1, 100);
+        ImGui::SliderInt("Number of Boids", &numBoids, 1, maxBoids, "%d", ImGuiSliderFlags_Logarithmic);
         ImGui::SliderFloat("Boid Size", &boidSize, 0.01f, 1.0f);
         ImGui::Checkbox("Day/Night Mode", &dayMode);
-        ImGui::Checkbox("Day/Night Auto Mode", &autoMode);
-        ImGui::SliderFloat("Alignment Weight", &alignmentWeight, 0.0f, 1.0f); 
-        ImGui::SliderFloat("Cohesion Weight", &cohesionWeight, 0.0f, 1.0f); 
-        ImGui::SliderFloat("Separation Distance", &separationDistance, 0.5f, 4.0f);
-        ImGui::SliderInt("Target Num Vertices", &targetNumVertices, 100, 207004);
+        ImGui::Checkbox("Day/Night Auto Mode", &flockParams.autoMode);
+        ImGui::SliderFloat("Day/Night Interval (s)", &flockParams.dayNightInterval, 0.5f, 60.0f);
+        ImGui::SliderFloat("Mean Lifespan (s)", &flockParams.meanLifespan, 1.0f, 120.0f);
+        ImGui::SliderFloat("Alignment Weight", &flockParams.alignmentWeight, 0.0f, 1.0f); 
+        ImGui::SliderFloat("Cohesion Weight", &flockParams.cohesionWeight, 0.0f, 1.0f); 
+        ImGui::SliderFloat("Separation Distance", &flockParams.separationDistance, 0.5f, 4.0f);
+        ImGui::SliderFloat("Interaction Radius", &flockParams.interactionRadius, 0.1f, 4.0f);
+        ImGui::SliderFloat("LOD Pixel Error", &lodSelection.pixelError, 0.1f, 16.0f);
+        if (ImGui::SliderInt("Triangle Budget", &triangleBudget, 10000, 10000000)) {
+            lodSelection.triangleBudget = static_cast<std::size_t>(triangleBudget);
+        }
+        ImGui::SliderFloat("Animation Duration (s)", &animationDuration, 0.1f, 5.0f);
+        if (ImGui::SliderFloat("Simulation Rate (Hz)", &simulationRate, 10.0f, 240.0f)) {
+            simulationThread.setStepRate(simulationRate);
+        }
+        if (ImGui::SliderFloat("Render FPS Cap (0 = VSync)", &renderRate, 0.0f, 240.0f)) {
+            if (renderRate > 0.0f) {
+                ctx.framerate_capped_at(renderRate);
+            } else {
+                ctx.framerate_synced_with_monitor();
+            }
+        }
+        ImGui::Text("Steering kernels: %s, %u threads", steeringKernels().name, threadPool.threadCount());
+        if (assetLoader.remaining() > 0) {
+            ImGui::Text("Loading models: %zu remaining", assetLoader.remaining());
+        }
+        if (surveyorAnimationBytes > 0) {
+            ImGui::Text("Surveyor animation: %.2f MB", surveyorAnimationBytes / (1024.0 * 1024.0));
+        }
+        ImGui::Text("Triangles drawn: %zu", trianglesDrawn);
+        ImGui::Text("Visible ghosts: %zu / %zu, culling %.3f ms", visibleGhosts, ghostHierarchy.size() + wispHierarchy.size(), cullingMilliseconds);
+        ImGui::Text("Species: %zu ghosts, %zu wisps", ghostHierarchy.size(), wispHierarchy.size());
+        ImGui::Text("Simulation step: %.2f ms, %llu dropped steps", simulationThread.lastStepMilliseconds(), static_cast<unsigned long long>(simulationThread.droppedSteps()));
         ImGui::End();
-
-        // Change model detail based on target number of vertices
-        changeModelDetail(ghostModel, targetNumVertices);
-
-        // Render switch model
-        for (int i = 0; i < numberOfSwitch; ++i) {
-            glm::vec3 switchPosition = switchPos[i]; // Position de la switch
-            shader.use();
-            glm::mat4 switchModelMatrix = glm::translate(glm::mat4(1.0f), switchPosition) *
-                                        glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
-            shader.set("uModelMatrix", switchModelMatrix);
-            glm::vec3 switchColor = glm::vec3(1.0f, 1.0f, 1.0f); // White color for switch
-            shader.set("uColor", switchColor);
-            glBindVertexArray(switchModel.vao);
-            glDrawElements(GL_TRIANGLES, switchModel.numVertices, GL_UNSIGNED_INT, 0);
+        drawProfilerWindow(gpuTimers, profilerThreads, profilerMessage);
+
+        lodSelection.pixelsPerUnit = LodSelection::pixelsPerUnitFor(static_cast<float>(ctx.main_canvas_height()), glm::radians(70.f));
+        trianglesDrawn = 0;
+        auto distanceToCamera = [&](const std::vector<InstanceData>& instances) {
+            return [&instances, &cameraPosition](std::size_t i) { return glm::distance(glm::vec3(instances[i].modelMatrix[3]), cameraPosition); };
+        };
+
+        // Ne garde dans visibleIds que les instances dont la sphère englobante touche la pyramide
+        // de vue (positionOf(i) : position de l'instance i)
+        Frustum frustum = Frustum::fromMatrix(ProjMatrix * MVMatrix);
+        cullingMilliseconds = 0.0;
+        auto cullInstances = [&](BoundingVolumeHierarchy& hierarchy, const Model& model, float scale, std::size_t count, auto&& positionOf) {
+            PROFILE_SCOPE("Culling");
+            auto start = std::chrono::steady_clock::now();
+            // Sphères calculées par l'arbre au moment où il les range, sans tableau intermédiaire
+            glm::vec3 center = scale * model.boundsCenter;
+            float     radius = scale * model.boundsRadius;
+            hierarchy.update(count, [&](std::size_t i) { return glm::vec4(positionOf(i) + center, radius); });
+            visibleIds.clear();
+            hierarchy.cull(frustum, visibleIds);
+            cullingMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        // Render switch model : un paquet par niveau de détail
+        cullInstances(switchHierarchy, switchModel, 0.5f, switchInstanceData.size(),
+                      [&](std::size_t i) { return glm::vec3(switchInstanceData[i].modelMatrix[3]); });
+        visibleInstances.clear();
+        for (std::uint32_t id : visibleIds) {
+            visibleInstances.push_back(switchInstanceData[id]);
         }
-
-        // Bind dome VAO
-        glBindVertexArray(domeVAO);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, domeVBO);
-        glBufferData(GL_ARRAY_BUFFER, dome.getVertexCount() * sizeof(ShapeVertex),
-                    dome.getDataPointer(), GL_STATIC_DRAW);
-
-        // Specify attribute pointers for dome
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE,
-                            sizeof(ShapeVertex),
-                            (const GLvoid *)offsetof(ShapeVertex, position));
-        glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-        glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE,
-                            sizeof(ShapeVertex),
-                            (const GLvoid *)offsetof(ShapeVertex, normal));
-        glEnableVertexAttribArray(VERTEX_ATTR_TEXCOORDS);
-        glVertexAttribPointer(VERTEX_ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE,
-                            sizeof(ShapeVertex),
-                            (const GLvoid *)offsetof(ShapeVertex, texCoords));
-
-        // Render dome
-        glm::mat4 domeModelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(domeRadius));
-        shader.set("uModelMatrix", domeModelMatrix);
-
-        // Activer le mélange pour permettre la transparence
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        // Définir la couleur du dome avec une composante alpha
-        glm::vec4 domeColorWithAlpha = glm::vec4(0.0f, 0.0f, 1.0f, 0.5f); // Rouge avec une transparence de 0.5
-        // Passer la couleur du dome avec alpha au shader
-        shader.set("uDomeColor", domeColorWithAlpha);
-        // Draw dome
-        glDrawArrays(GL_TRIANGLES, 0, dome.getVertexCount());
-
-        // Désactiver le mélange une fois que vous avez fini de rendre des objets transparents
-        glDisable(GL_BLEND);
-
-        // Unbind VAO
-        glBindVertexArray(0);
-
-        // Utilise l'indice de frame courant pour sélectionner la frame appropriée à afficher
-        // Incrémente le temps écoulé à chaque itération de la boucle
+        lodSelection.selectInstances(switchModel.lods, 0.5f, visibleInstances.size(), distanceToCamera(visibleInstances), instanceLevels, frameArena);
+        trianglesDrawn += recordInstancesByLod(renderQueue, instancedShader, switchInstances, switchModel, visibleInstances, instanceLevels, sortedInstances, cameraPosition, frameArena);
+
+        // Render dome : transparent, la file le dessine après tous les objets opaques
+        DrawPacket<ShaderProgram> domePacket;
+        domePacket.program = &shader;
+        domePacket.vao = dome.vao();
+        domePacket.indexCount = dome.indexCount();
+        domePacket.transparent = true;
+        domePacket.depth = glm::length(cameraPosition);
+        domePacket.hasObjectUniforms = true;
+        domePacket.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(domeRadius));
+        domePacket.color = glm::vec4(0.0f, 0.0f, 1.0f, 0.5f); // Bleu avec une transparence de 0.5
+        renderQueue.push(domePacket);
+
+        // Incrémente le temps écoulé à chaque itération de la boucle ; le vertex shader en
+        // déduit les deux frames à interpoler
         elapsedTime += deltaTime;
 
-        // Durée totale de l'animation (en secondes)
-        float animationDuration = 1.0f; // Par exemple, 2 secondes
-
-        // Calcule l'indice de frame en utilisant le temps écoulé
-        int currentFrameIndex = static_cast<int>(std::fmod(elapsedTime / animationDuration, numFrames));
-
-        Model currentFrameModel = animationFrames[currentFrameIndex].model;
-        
-        // Envoie les matrices au shader
         // Render surveyor
-        shader.use();
-        shader.set("surveyorPosition", surveyor.position);
         glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), surveyor.position) *
                             glm::rotate(glm::mat4(1.0f), glm::radians(100.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
                             glm::rotate(glm::mat4(1.0f), surveyorRotationAngleYRadians, glm::vec3(0.0f, 1.0f, 0.0f)) *
                             glm::scale(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f));
-        shader.set("uModelMatrix", modelMatrix);
         glm::vec3 surveyorColor = glm::vec3(1.0f, 1.0f, 0.0f); // Yellow color for surveyor
-        shader.set("uColor", surveyorColor);
-        glBindVertexArray(currentFrameModel.vao);
-        glDrawElements(GL_TRIANGLES, currentFrameModel.numVertices, GL_UNSIGNED_INT, 0);
-        
-        // Change model detail based on target number of vertices
-        changeModelDetail(currentFrameModel, targetNumVertices); // Change detail level of surveyor model
-        
-        for (auto& boid : boids) {
-            // Vérifier si c'est la nuit pour dessiner les fantômes
-            if (!dayMode) {
-
-                // Appliquer la rotation à la matrice du modèle
-                glm::mat4 boidModelMatrix = glm::translate(glm::mat4(1.0f), boid.position) * glm::scale(glm::mat4(1.0f), glm::vec3(boidSize));
-                
-                shader.set("uModelMatrix", glm::mat4(1.0f));
-                glm::vec3 boidColor = getBoidColor(boid.markovState, boid.isFemale);
-                shader.set("uColor", boidColor);
-                shader.set("boidPosition", boid.position);
-                shader.set("uMVPMatrix", ProjMatrix * MVMatrix * boidModelMatrix);
-                shader.set("uMVMatrix", MVMatrix * boidModelMatrix);
-                shader.set("uNormalMatrix", glm::transpose(glm::inverse(MVMatrix * boidModelMatrix)));
-
-                glBindVertexArray(ghostModel.vao);
-                glDrawElements(GL_TRIANGLES, ghostModel.numVertices, GL_UNSIGNED_INT, 0);
-            }
-            // Mise à jour de l'état de la chaîne de Markov en fonction du nombre de voisins
-            updateMarkovState(boid, boids, numBoids);         
-            // Mise à jour de l'état de la chaîne de Markov
-            if (elapsedTime > boid.markovTime) {
-                // Générer un nouveau temps entre les changements d'état
-                boid.markovTime += generateStateChangeTime(1);
-
-                if (autoMode){
-                    // Générer aléatoirement le nouvel état de l'interrupteur
-                    bool newSwitchState = generateSwitchState(1);
-
-                    // Mettre à jour l'état de l'interrupteur
-                    dayMode = newSwitchState;
-                }
-            }
+        DrawPacket<ShaderProgram> surveyorPacket;
+        surveyorPacket.depth = glm::distance(surveyor.position, cameraPosition);
+        surveyorPacket.hasObjectUniforms = true;
+        surveyorPacket.modelMatrix = modelMatrix;
+        surveyorPacket.color = glm::vec4(surveyorColor, 1.0f);
+        if (surveyorAnimation.vao != 0) {
+            animatedShader.use();
+            animatedShader.set("uElapsedTime"_uniform, elapsedTime);
+            animatedShader.set("uAnimationDuration"_uniform, animationDuration);
+            const MeshLod& lod = surveyorAnimation.lods[lodSelection.select(surveyorAnimation.lods, 0.5f, surveyorPacket.depth)];
+            surveyorPacket.program = &animatedShader;
+            surveyorPacket.vao = surveyorAnimation.vao;
+            surveyorPacket.textureTarget = GL_TEXTURE_BUFFER;
+            surveyorPacket.texture = surveyorAnimation.texelTexture;
+            surveyorPacket.firstIndex = lod.firstIndex;
+            surveyorPacket.indexCount = static_cast<GLsizei>(lod.indexCount);
+        } else {
+            surveyorPacket.program = &shader;
+            surveyorPacket.vao = placeholderModel.vao;
+            surveyorPacket.indexCount = static_cast<GLsizei>(placeholderModel.numIndices);
         }
-
-        // Update number of boids
-        if (numBoids > boids.size()) {
-            for (int i = 0; i < numBoids; ++i){
-                Boid boid;
-                boid.position = glm::vec3(linearRand(-domeRadius, domeRadius),
-                                      linearRand(-domeRadius, domeRadius),
-                                      linearRand(-domeRadius, domeRadius));
-
-                // Vitesse aléatoire des boids dans une certaine plage
-                boid.velocity = customSphericalRand(speedBoids);
-                
-                // Définir aléatoirement si le boid est une femelle
-                boid.isFemale = (rand() % 2 == 0);
-
-                // État initial de la chaîne de Markov
-                boid.markovState = 0;
-                
-                // Générer la durée de vie du boid
-                boid.lifespan = generateExp(5);
-
-                // Initialiser markovTime avec une valeur aléatoire entre 0 et la première transition
-                boid.markovTime = generateStateChangeTime(1);
-
-                boids.push_back(boid);
+        renderQueue.push(surveyorPacket);
+        trianglesDrawn += static_cast<std::size_t>(surveyorPacket.indexCount) / 3;
+
+        // Dernier état publié par la simulation, interpolé entre ses deux derniers pas
+        const BoidSnapshot& snapshot = simulationThread.latestSnapshot();
+        float alpha = snapshot.interpolationFactor(simulationThread.now());
+        // Vérifier si c'est la nuit pour dessiner les fantômes, un paquet par niveau de détail
+        if (!dayMode) {
+            PROFILE_SCOPE("Ghosts");
+            // Positions interpolées par composante ; les matrices ne sont construites qu'à la
+            // fin, pour les seuls fantômes visibles, directement dans le tampon d'instances
+            std::size_t count = snapshot.size();
+            std::span<float> ghostX = frameArena.allocate<float>(count);
+            std::span<float> ghostY = frameArena.allocate<float>(count);
+            std::span<float> ghostZ = frameArena.allocate<float>(count);
+            interpolatePositions(snapshot.previousPx.data(), snapshot.px.data(), alpha, count, ghostX.data());
+            interpolatePositions(snapshot.previousPy.data(), snapshot.py.data(), alpha, count, ghostY.data());
+            interpolatePositions(snapshot.previousPz.data(), snapshot.pz.data(), alpha, count, ghostZ.data());
+            auto ghostPosition = [&](std::size_t i) { return glm::vec3(ghostX[i], ghostY[i], ghostZ[i]); };
+
+            ghostColors.resize(count);
+            ghostTransitions.resize(count);
+            threadRandom().fillExponential(ghostTransitions.data(), ghostTransitions.size(), 5.0f);
+            for (std::size_t s = 0; s + 1 < snapshot.speciesStart.size(); ++s) {
+                for (std::size_t i = snapshot.speciesStart[s]; i < snapshot.speciesStart[s + 1]; ++i) {
+                    ghostColors[i] = getBoidColor(snapshot.markovState[i], snapshot.isFemale[i], ghostTransitions[i], species[s].color);
+                }
             }
-        } else if (numBoids < boids.size()) {
-            boids.resize(numBoids);
-        }
 
-        // Variables pour stocker les vecteurs de séparation, alignement et cohésion pour chaque boid
-        std::vector<glm::vec3> separation(numBoids, glm::vec3(0.0f));
-        std::vector<glm::vec3> alignment(numBoids, glm::vec3(0.0f));
-        std::vector<glm::vec3> cohesion(numBoids, glm::vec3(0.0f));
-
-        // Calculer les vecteurs de séparation, alignement et cohésion
-        for (int i = 0; i < numBoids; ++i) {
-            for (int j = 0; j < numBoids; ++j) {
-                if (i != j) {
-                    // Règle de séparation
-                    float distance = glm::length(boids[j].position - boids[i].position);
-                    if (distance < separationDistance) {
-                        separation[i] -= glm::normalize(boids[j].position - boids[i].position) / distance;
+            // Les boids d'une espèce sont contigus dans l'instantané : chaque espèce a son
+            // modèle, sa hiérarchie et son tampon d'instances
+            visibleGhosts = 0;
+            auto drawSpecies = [&](std::size_t s, BoundingVolumeHierarchy& hierarchy, const Model& model, InstanceBuffer& speciesInstances) {
+                std::size_t begin = s + 1 < snapshot.speciesStart.size() ? snapshot.speciesStart[s] : 0;
+                std::size_t end = s + 1 < snapshot.speciesStart.size() ? snapshot.speciesStart[s + 1] : 0;
+                cullInstances(hierarchy, model, boidSize, end - begin, [&](std::size_t i) { return ghostPosition(begin + i); });
+                visibleGhosts += visibleIds.size();
+                for (std::uint32_t& id : visibleIds) {
+                    id += static_cast<std::uint32_t>(begin);
+                }
+                lodSelection.selectInstances(model.lods, boidSize, visibleIds.size(),
+                                             [&](std::size_t i) { return glm::distance(ghostPosition(visibleIds[i]), cameraPosition); }, instanceLevels, frameArena);
+                LodOrder lodOrder = sortByLod(instanceLevels, model.lods.size(), frameArena);
+                std::span<std::uint32_t> orderedIds = frameArena.allocate<std::uint32_t>(lodOrder.order.size());
+                for (std::size_t k = 0; k < orderedIds.size(); ++k) {
+                    orderedIds[k] = visibleIds[lodOrder.order[k]];
+                }
+                if (InstanceData* instances = speciesInstances.map(orderedIds.size())) {
+                    buildTranslationScaleInstances({ghostX.data(), ghostY.data(), ghostZ.data()}, ghostColors.data(), orderedIds.data(), orderedIds.size(),
+                                                   boidSize, instances);
+                    if (speciesInstances.unmap()) {
+                        trianglesDrawn += recordLodPackets(renderQueue, instancedShader, speciesInstances, model, lodOrder.first,
+                                                           [&](std::size_t k) { return glm::distance(ghostPosition(orderedIds[k]), cameraPosition); });
                     }
-
-                    // Règle d'alignement
-                    alignment[i] += boids[j].velocity;
-
-                    // Règle de cohésion
-                    cohesion[i] += boids[j].position;
                 }
-            }
+            };
+            drawSpecies(ghostSpecies, ghostHierarchy, ghostModel, ghostInstances);
+            drawSpecies(wispSpecies, wispHierarchy, wispModel, wispInstances);
+        } else {
+            visibleGhosts = 0;
         }
 
-        // Appliquer les règles
-        for (int i = 0; i < numBoids; ++i) {
-            // Règle de séparation
-            boids[i].velocity += separation[i];
-
-            // Règle d'alignement
-            alignment[i] /= numBoids - 1;
-            boids[i].velocity += (alignment[i] - boids[i].velocity) * alignmentWeight;
-
-            // Règle de cohésion
-            cohesion[i] /= numBoids - 1;
-            cohesion[i] = (cohesion[i] - boids[i].position) / glm::length(cohesion[i] - boids[i].position);
-            boids[i].velocity += cohesion[i] * cohesionWeight;
-
-            // Règle d'évitement de la caméra
-            glm::vec3 directionToCamera = cameraPosition - boids[i].position;
-            float distanceToCamera = glm::length(directionToCamera);
-            if (distanceToCamera < distanceMinToCamera) {
-                // Normaliser le vecteur de direction et ajouter à la vitesse
-                glm::vec3 avoidance = glm::normalize(directionToCamera);
-                boids[i].velocity += avoidance * avoidanceWeight;
-            }
-
-            // Normaliser la vitesse
-            // Calculate direction to avoid the surveyor
-            glm::vec3 directionFromSurveyor = glm::normalize(boids[i].position - surveyor.position);
-
-            // Adjust boid velocity to move away from the surveyor
-            boids[i].velocity += directionFromSurveyor * avoidanceWeight * ctx.delta_time();
-
-            // Appliquer simple intégration d'Euler pour mettre à jour la position du boid
-            boids[i].position += boids[i].velocity * deltaTime;
-
-            // Keep boids within the dome bounds
-            float distanceToCenter = glm::length(boids[i].position);
-            if (distanceToCenter > domeRadius) {
-                // Move the boid back inside the dome
-                boids[i].position = glm::normalize(boids[i].position) * domeRadius;
-            }
-
-            // Calculate boid's model matrix
-            glm::mat4 boidModelMatrix = glm::translate(glm::mat4(1.0f), boids[i].position) * glm::scale(glm::mat4(1.0f), glm::vec3(boidSize));
-
-            // Get the color of the current boid based on day/night mode and boid type
-            glm::vec3 boidColor = getBoidColor(boids[i].markovState, boids[i].isFemale);
+        {
+            PROFILE_SCOPE("Render submit");
+            GpuTimers::Scope gpuScope(gpuTimers, "Draw");
+            renderQueue.submit(renderBackend);
+        }
 
-            // Send the color of the current boid to the shader
-            shader.set("uColor", boidColor);
+        // Changements de l'interrupteur tirés par le mode automatique
+        if (snapshot.switchEvents != seenSwitchEvents) {
+            seenSwitchEvents = snapshot.switchEvents;
+            dayMode = snapshot.switchState;
+        }
 
-            // Send boid matrices to the GPU
-            shader.set("uMVPMatrix", ProjMatrix * MVMatrix * boidModelMatrix);
-            shader.set("uMVMatrix", MVMatrix * boidModelMatrix);
-            shader.set("uNormalMatrix", glm::transpose(
-                                glm::inverse(MVMatrix * boidModelMatrix)));
+        // Transmettre les réglages, la caméra et l'arpenteur au thread de simulation
+        flockParams.cameraPosition   = cameraPosition;
+        flockParams.surveyorPosition = surveyor.position;
+        simulationThread.setInputs({flockParams, numBoids, speedBoids});
 
-        }
-    
         if (dayMode && transition < 1.0f) {
             transition += 0.01f;
         } else if (!dayMode && transition > 0.0f) {
@@ -800,20 +880,22 @@ int main() {
     };
     // Should be done last. It starts the infinite loop.
     ctx.start();
-
-    // Clean up
-    glDeleteBuffers(1, &domeVBO);
-    glDeleteVertexArrays(1, &domeVAO);
+    simulationThread.stop();
+    if (recorder.isOpen() && !recorder.close()) {
+        std::cerr << "Recording is incomplete" << std::endl;
+    }
+    if (snapshotWriter.isOpen() && !snapshotWriter.close()) {
+        std::cerr << "Snapshot file is incomplete" << std::endl;
+    }
 
     // Libération des VAO et VBO après utilisation
-    glDeleteVertexArrays(1, &ghostModel.vao);
-    glDeleteBuffers(1, &ghostModel.vbo);
-    glDeleteBuffers(1, &ghostModel.ebo);
-    
-    // Libération des VAO et VBO après utilisation
-    glDeleteVertexArrays(1, &switchModel.vao);
-    glDeleteBuffers(1, &switchModel.vbo);
-    glDeleteBuffers(1, &switchModel.ebo);
+    deleteModel(ghostModel);
+    deleteModel(wispModel);
+    deleteModel(switchModel);
+    deleteModel(placeholderModel);
+    if (surveyorAnimation.vao != 0) {
+        deleteAnimation(surveyorAnimation);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Sommet entrelacé : position, normale et coordonnées de texture à la suite
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+// Matériau du fichier MTL et plage d'indices qui l'utilise (usemtl). Taille fixe,
+// sans pointeur, pour pouvoir être lu tel quel depuis le cache binaire.
+struct MeshMaterial {
+    static constexpr std::size_t NAME_SIZE = 64;
+    static constexpr std::size_t PATH_SIZE = 192;
+
+    char          name[NAME_SIZE];
+    char          texturePath[PATH_SIZE]; // map_Kd, vide s'il n'y en a pas
+    glm::vec3     diffuse;                // Kd
+    glm::vec3     textureScale;           // Option -s de map_Kd
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+
+    std::string_view nameView() const { return {name, strnlen(name, NAME_SIZE)}; }
+    std::string_view texturePathView() const { return {texturePath, strnlen(texturePath, PATH_SIZE)}; }
+
+    static void copyString(char* destination, std::size_t size, std::string_view source)
+    {
+        std::size_t length = std::min(source.size(), size - 1);
+        std::memcpy(destination, source.data(), length);
+        std::memset(destination + length, 0, size - length);
+    }
+};
+
+// Niveau de détail : plage d'indices dans le tampon d'indices du maillage et erreur
+// géométrique de la simplification (distance, dans l'unité du maillage)
+struct MeshLod {
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    float         error;
+};
+
+// Vue en lecture seule sur un maillage, qu'il vienne de l'analyse d'un OBJ ou d'un
+// cache projeté en mémoire
+struct MeshView {
+    const MeshVertex*    vertices      = nullptr;
+    std::size_t          vertexCount   = 0;
+    const std::uint32_t* indices       = nullptr;
+    std::size_t          indexCount    = 0;
+    const MeshMaterial*  materials     = nullptr;
+    std::size_t          materialCount = 0;
+    const MeshLod*       lods          = nullptr; // Le niveau 0 est le maillage complet
+    std::size_t          lodCount      = 0;
+    glm::vec3            boundsMin{0.0f};
+    glm::vec3            boundsMax{0.0f};
+
+    // Niveau de détail, ou tout le maillage s'il n'a pas de chaîne de niveaux
+    MeshLod lod(std::size_t level) const
+    {
+        return lodCount > 0 ? lods[std::min(level, lodCount - 1)] : MeshLod{0, static_cast<std::uint32_t>(indexCount), 0.0f};
+    }
+};
+
+// Maillage possédant ses données, tel que produit par le chargeur OBJ
+struct MeshData {
+    std::vector<MeshVertex>    vertices;
+    std::vector<std::uint32_t> indices; // Maillage complet puis, à la suite, les niveaux simplifiés
+    std::vector<MeshMaterial>  materials;
+    std::vector<MeshLod>       lods; // Vide tant que la chaîne de niveaux n'est pas construite
+    glm::vec3                  boundsMin{0.0f};
+    glm::vec3                  boundsMax{0.0f};
+
+    void computeBounds()
+    {
+        if (vertices.empty()) {
+            boundsMin = boundsMax = glm::vec3(0.0f);
+            return;
+        }
+        boundsMin = boundsMax = vertices[0].position;
+        for (const MeshVertex& vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+    }
+
+    MeshView view() const
+    {
+        return {vertices.data(), vertices.size(), indices.data(), indices.size(), materials.data(), materials.size(),
+                lods.data(), lods.size(), boundsMin, boundsMax};
+    }
+};
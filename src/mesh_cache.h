@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "hash.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "mesh_simplifier.h"
+#include "obj_loader.h"
+
+// Cache binaire des maillages : un en-tête suivi des sommets entrelacés, des indices
+// (tous niveaux de détail confondus), de la table des matériaux et de celle des niveaux, directement utilisables une fois le fichier projeté
+// en mémoire. Le cache est invalidé quand la version du format ou le contenu des
+// fichiers OBJ / MTL d'origine change.
+struct MeshCacheHeader {
+    static constexpr char          MAGIC[8] = {'P', 'M', 'E', 'S', 'H', 'C', 'H', 'E'};
+    static constexpr std::uint32_t VERSION  = 4;
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t vertexSize;   // sizeof(MeshVertex), pour refuser un cache d'une autre plateforme
+    std::uint64_t contentHash;  // Empreinte des fichiers OBJ et MTL d'origine
+    std::uint64_t vertexCount;
+    std::uint64_t indexCount;
+    std::uint64_t materialCount;
+    std::uint64_t lodCount;
+    std::uint64_t vertexOffset; // Décalages depuis le début du fichier
+    std::uint64_t indexOffset;
+    std::uint64_t materialOffset;
+    std::uint64_t lodOffset;
+    float         boundsMin[3];
+    float         boundsMax[3];
+};
+
+// Empreinte d'un couple OBJ / MTL (la taille de l'OBJ sépare les deux contenus)
+inline std::uint64_t meshSourceHash(std::string_view objText, std::string_view mtlText)
+{
+    std::uint64_t size = objText.size();
+    std::uint64_t hash = hashBytes(objText);
+    hash = hashBytes(std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)), hash);
+    return hashBytes(mtlText, hash);
+}
+
+namespace detail {
+inline std::uint64_t alignTo(std::uint64_t offset, std::uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+} // namespace detail
+
+// Écrit le cache dans un fichier temporaire puis le renomme : un lancement interrompu
+// ne laisse jamais de cache à moitié écrit
+inline bool writeMeshCache(const std::string& path, const MeshData& mesh, std::uint64_t contentHash)
+{
+    MeshCacheHeader header{};
+    std::memcpy(header.magic, MeshCacheHeader::MAGIC, sizeof(header.magic));
+    header.version        = MeshCacheHeader::VERSION;
+    header.vertexSize     = sizeof(MeshVertex);
+    header.contentHash    = contentHash;
+    header.vertexCount    = mesh.vertices.size();
+    header.indexCount     = mesh.indices.size();
+    header.materialCount  = mesh.materials.size();
+    header.lodCount       = mesh.lods.size();
+    header.vertexOffset   = detail::alignTo(sizeof(MeshCacheHeader), 16);
+    header.indexOffset    = detail::alignTo(header.vertexOffset + header.vertexCount * sizeof(MeshVertex), 16);
+    header.materialOffset = detail::alignTo(header.indexOffset + header.indexCount * sizeof(std::uint32_t), 16);
+    header.lodOffset      = detail::alignTo(header.materialOffset + header.materialCount * sizeof(MeshMaterial), 16);
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = mesh.boundsMin[axis];
+        header.boundsMax[axis] = mesh.boundsMax[axis];
+    }
+
+    // Nom temporaire propre à chaque écriture, plusieurs threads pouvant charger le même OBJ
+    static std::atomic<unsigned> writeCount{0};
+    std::string                  temporaryPath = path + ".tmp" + std::to_string(writeCount++);
+    std::FILE*  file          = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    auto writeAt = [&](std::uint64_t offset, const void* data, std::size_t size) {
+        static constexpr char padding[16] = {};
+        long                  position    = std::ftell(file);
+        return std::fwrite(padding, 1, static_cast<std::size_t>(offset - position), file) == offset - position
+               && (size == 0 || std::fwrite(data, 1, size, file) == size);
+    };
+    bool written = writeAt(0, &header, sizeof(header))
+                   && writeAt(header.vertexOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(MeshVertex))
+                   && writeAt(header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(std::uint32_t))
+                   && writeAt(header.materialOffset, mesh.materials.data(), mesh.materials.size() * sizeof(MeshMaterial))
+                   && writeAt(header.lodOffset, mesh.lods.data(), mesh.lods.size() * sizeof(MeshLod));
+    written = (std::fclose(file) == 0) && written;
+
+    std::remove(path.c_str());
+    if (!written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Vérifie un cache projeté en mémoire et renvoie une vue sur ses données.
+// Renvoie false si le fichier est absent, tronqué, d'une autre version ou périmé, ou si
+// une plage ou un indice sort des données : un cache abîmé est reconstruit plutôt que
+// d'envoyer au GPU des indices hors du tampon de sommets.
+inline bool readMeshCache(const MappedFile& file, std::uint64_t contentHash, MeshView& view)
+{
+    if (file.size() < sizeof(MeshCacheHeader)) {
+        return false;
+    }
+    MeshCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MeshCacheHeader::MAGIC, sizeof(header.magic)) != 0
+        || header.version != MeshCacheHeader::VERSION || header.vertexSize != sizeof(MeshVertex)
+        || header.contentHash != contentHash) {
+        return false;
+    }
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize) {
+        return offset % 16 == 0 && offset <= file.size() && count <= (file.size() - offset) / elementSize;
+    };
+    if (!fits(header.vertexOffset, header.vertexCount, sizeof(MeshVertex))
+        || !fits(header.indexOffset, header.indexCount, sizeof(std::uint32_t))
+        || !fits(header.materialOffset, header.materialCount, sizeof(MeshMaterial))
+        || !fits(header.lodOffset, header.lodCount, sizeof(MeshLod))) {
+        return false;
+    }
+
+    auto inIndexRange = [&](std::uint32_t first, std::uint32_t count) { return first <= header.indexCount && count <= header.indexCount - first; };
+    const MeshLod*      lods      = reinterpret_cast<const MeshLod*>(file.data() + header.lodOffset);
+    const MeshMaterial* materials = reinterpret_cast<const MeshMaterial*>(file.data() + header.materialOffset);
+    for (std::uint64_t i = 0; i < header.lodCount; ++i) {
+        if (!inIndexRange(lods[i].firstIndex, lods[i].indexCount)) {
+            return false;
+        }
+    }
+    for (std::uint64_t i = 0; i < header.materialCount; ++i) {
+        if (!inIndexRange(materials[i].firstIndex, materials[i].indexCount)) {
+            return false;
+        }
+    }
+    // Plus grand indice en un seul passage, sans branche : la boucle se vectorise
+    const std::uint32_t* indices = reinterpret_cast<const std::uint32_t*>(file.data() + header.indexOffset);
+    std::uint32_t        largest = 0;
+    for (std::uint64_t i = 0; i < header.indexCount; ++i) {
+        largest = std::max(largest, indices[i]);
+    }
+    if (header.indexCount > 0 && largest >= header.vertexCount) {
+        return false;
+    }
+
+    view.vertices      = reinterpret_cast<const MeshVertex*>(file.data() + header.vertexOffset);
+    view.vertexCount   = header.vertexCount;
+    view.indices       = indices;
+    view.indexCount    = header.indexCount;
+    view.materials     = materials;
+    view.materialCount = header.materialCount;
+    view.lods          = lods;
+    view.lodCount      = header.lodCount;
+    view.boundsMin     = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    view.boundsMax     = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    return true;
+}
+
+// Maillage chargé depuis le cache (projeté en mémoire) ou, à défaut, depuis l'OBJ
+class LoadedMesh {
+public:
+    const MeshView& view() const { return m_view; }
+    bool            fromCache() const { return m_cache.isOpen(); }
+
+    // Charge objPath / mtlPath en passant par le cache objPath + ".meshcache",
+    // reconstruit (analyse puis chaîne de niveaux de détail) s'il manque ou s'il est
+    // périmé. Renvoie false en cas d'échec.
+    bool load(const char* objPath, const char* mtlPath)
+    {
+        *this = LoadedMesh{};
+
+        MappedFile objFile(objPath);
+        MappedFile mtlFile(mtlPath);
+        if (!objFile.isOpen()) {
+            return false;
+        }
+        std::uint64_t contentHash = meshSourceHash(objFile.text(), mtlFile.text());
+
+        std::string cachePath = std::string(objPath) + ".meshcache";
+        if (m_cache.open(cachePath.c_str()) && readMeshCache(m_cache, contentHash, m_view)) {
+            return true;
+        }
+        m_cache.close();
+
+        if (!parseObj(objFile.text(), mtlFile.text(), m_data)) {
+            return false;
+        }
+        buildLodChain(m_data);
+        writeMeshCache(cachePath, m_data, contentHash);
+        m_view = m_data.view();
+        return true;
+    }
+
+private:
+    MappedFile m_cache;
+    MeshData   m_data;
+    MeshView   m_view;
+};
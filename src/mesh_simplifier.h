@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "glm/glm.hpp"
+#include "mesh.h"
+
+// Simplification de maillage par contraction d'arêtes guidée par les quadriques d'erreur
+// (Garland & Heckbert). Chaque contraction ramène un sommet sur un sommet voisin déjà
+// existant : les indices simplifiés désignent toujours des sommets du maillage
+// d'origine, si bien que tous les niveaux de détail partagent le même tampon de sommets.
+namespace simplify {
+
+// Somme de carrés de distances à des plans, pondérée par l'aire des triangles
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+    double weight = 0;
+
+    // Plan de normale unitaire n passant par point
+    static Quadric fromPlane(const glm::vec3& n, const glm::vec3& point, double weight)
+    {
+        double  a = n.x, b = n.y, c = n.z;
+        double  d = -(a * point.x + b * point.y + c * point.z);
+        Quadric q;
+        q.a2 = a * a * weight, q.ab = a * b * weight, q.ac = a * c * weight, q.ad = a * d * weight;
+        q.b2 = b * b * weight, q.bc = b * c * weight, q.bd = b * d * weight;
+        q.c2 = c * c * weight, q.cd = c * d * weight, q.d2 = d * d * weight;
+        q.weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        a2 += other.a2, ab += other.ab, ac += other.ac, ad += other.ad, b2 += other.b2;
+        bc += other.bc, bd += other.bd, c2 += other.c2, cd += other.cd, d2 += other.d2;
+        weight += other.weight;
+        return *this;
+    }
+
+    double evaluate(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                       + c2 * z * z + 2 * cd * z + d2;
+        return std::max(error, 0.0);
+    }
+};
+
+// Identifiant commun aux sommets de même position (séparés par leurs normales ou leurs
+// coordonnées de texture), pour que la simplification ne déchire pas les arêtes vives
+inline std::vector<std::uint32_t> weldPositions(const MeshVertex* vertices, std::size_t vertexCount, std::vector<std::uint32_t>& representative)
+{
+    struct PositionHash {
+        std::size_t operator()(const glm::vec3& p) const
+        {
+            std::uint32_t bits[3];
+            std::memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+    struct PositionEqual {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    };
+
+    std::unordered_map<glm::vec3, std::uint32_t, PositionHash, PositionEqual> ids;
+    ids.reserve(vertexCount);
+    std::vector<std::uint32_t> positionOf(vertexCount);
+    representative.clear();
+    for (std::size_t i = 0; i < vertexCount; ++i) {
+        auto [it, inserted] = ids.try_emplace(vertices[i].position, static_cast<std::uint32_t>(representative.size()));
+        if (inserted) {
+            representative.push_back(static_cast<std::uint32_t>(i));
+        }
+        positionOf[i] = it->second;
+    }
+    return positionOf;
+}
+
+} // namespace simplify
+
+// Simplifie les triangles `indices` jusqu'à au plus targetIndexCount indices (moins si
+// possible, plus si aucune contraction valide ne reste). Les triangles gardent leur ordre
+// d'origine, donc leur regroupement par matériau. Renvoie l'erreur géométrique du
+// résultat, en distance (racine de l'erreur quadrique moyenne de la pire contraction).
+inline float simplifyMesh(const MeshVertex* vertices, std::size_t vertexCount, const std::uint32_t* indices, std::size_t indexCount,
+                          std::size_t targetIndexCount, std::vector<std::uint32_t>& result)
+{
+    using simplify::Quadric;
+
+    std::vector<std::uint32_t> representative;
+    std::vector<std::uint32_t> positionOf = simplify::weldPositions(vertices, vertexCount, representative);
+    std::size_t                positionCount = representative.size();
+    auto                       positionAt    = [&](std::uint32_t p) -> const glm::vec3& { return vertices[representative[p]].position; };
+
+    // Sommets rattachés à chaque position, pour choisir les attributs après une contraction
+    std::vector<std::vector<std::uint32_t>> verticesAt(positionCount);
+    for (std::size_t i = 0; i < vertexCount; ++i) {
+        verticesAt[positionOf[i]].push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // Triangles : sommets (attributs) et positions, les dégénérés sont écartés
+    std::size_t                triangleCount = indexCount / 3;
+    std::vector<std::uint32_t> corners(indices, indices + triangleCount * 3);
+    std::vector<std::uint32_t> cornerPositions(triangleCount * 3);
+    std::vector<char>          alive(triangleCount, 1);
+    std::size_t                aliveCount = 0;
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            cornerPositions[t * 3 + k] = positionOf[corners[t * 3 + k]];
+        }
+        std::uint32_t* p = &cornerPositions[t * 3];
+        alive[t]         = p[0] != p[1] && p[1] != p[2] && p[0] != p[2];
+        aliveCount += alive[t];
+    }
+
+    // Quadriques des plans des triangles, et triangles autour de chaque position
+    std::vector<Quadric>                    quadrics(positionCount);
+    std::vector<std::vector<std::uint32_t>> trianglesAt(positionCount);
+    std::unordered_map<std::uint64_t, int>  edgeUses; // Arêtes (positions triées) -> nombre de triangles
+    auto edgeKey = [](std::uint32_t a, std::uint32_t b) {
+        return static_cast<std::uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+    };
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        if (!alive[t]) {
+            continue;
+        }
+        const std::uint32_t* p      = &cornerPositions[t * 3];
+        glm::vec3            normal = glm::cross(positionAt(p[1]) - positionAt(p[0]), positionAt(p[2]) - positionAt(p[0]));
+        float                area   = glm::length(normal);
+        if (area > 0.0f) {
+            Quadric plane = Quadric::fromPlane(normal / area, positionAt(p[0]), 0.5 * area);
+            for (int k = 0; k < 3; ++k) {
+                quadrics[p[k]] += plane;
+            }
+        }
+        for (int k = 0; k < 3; ++k) {
+            trianglesAt[p[k]].push_back(static_cast<std::uint32_t>(t));
+            ++edgeUses[edgeKey(p[k], p[(k + 1) % 3])];
+        }
+    }
+
+    // Bords ouverts : plan perpendiculaire au triangle le long de l'arête, fortement
+    // pondéré, pour que le contour du maillage ne se rétracte pas
+    constexpr double BORDER_WEIGHT = 10.0;
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        if (!alive[t]) {
+            continue;
+        }
+        const std::uint32_t* p      = &cornerPositions[t * 3];
+        glm::vec3            normal = glm::cross(positionAt(p[1]) - positionAt(p[0]), positionAt(p[2]) - positionAt(p[0]));
+        for (int k = 0; k < 3; ++k) {
+            if (edgeUses[edgeKey(p[k], p[(k + 1) % 3])] != 1) {
+                continue;
+            }
+            glm::vec3 edge      = positionAt(p[(k + 1) % 3]) - positionAt(p[k]);
+            glm::vec3 border    = glm::cross(edge, normal);
+            float     length    = glm::length(border);
+            float     edgeSize2 = glm::dot(edge, edge);
+            if (length > 0.0f) {
+                Quadric plane = Quadric::fromPlane(border / length, positionAt(p[k]), BORDER_WEIGHT * edgeSize2);
+                plane.weight  = 0.0; // Contrainte seulement, sans compter dans l'aire moyenne
+                quadrics[p[k]] += plane;
+                quadrics[p[(k + 1) % 3]] += plane;
+            }
+        }
+    }
+
+    // Contractions candidates, les moins coûteuses d'abord. Une entrée devient caduque
+    // dès que l'une de ses deux positions a changé (numéro de version).
+    struct Collapse {
+        double        cost;
+        std::uint32_t from, to;
+        std::uint32_t fromVersion, toVersion;
+        bool          operator<(const Collapse& other) const { return cost > other.cost; }
+    };
+    std::vector<std::uint32_t>    version(positionCount, 0);
+    std::priority_queue<Collapse> queue;
+    auto                          pushEdge = [&](std::uint32_t a, std::uint32_t b) {
+        Quadric sum = quadrics[a];
+        sum += quadrics[b];
+        double toB = sum.evaluate(positionAt(b));
+        double toA = sum.evaluate(positionAt(a));
+        if (toB <= toA) {
+            queue.push({toB, a, b, version[a], version[b]});
+        } else {
+            queue.push({toA, b, a, version[b], version[a]});
+        }
+    };
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        if (alive[t]) {
+            const std::uint32_t* p = &cornerPositions[t * 3];
+            for (int k = 0; k < 3; ++k) {
+                if (p[k] < p[(k + 1) % 3]) {
+                    pushEdge(p[k], p[(k + 1) % 3]);
+                }
+            }
+        }
+    }
+
+    // Refuse une contraction qui retournerait ou écraserait un triangle voisin
+    auto collapseIsValid = [&](std::uint32_t from, std::uint32_t to) {
+        for (std::uint32_t t : trianglesAt[from]) {
+            const std::uint32_t* p = &cornerPositions[t * 3];
+            if (!alive[t] || p[0] == to || p[1] == to || p[2] == to) {
+                continue;
+            }
+            glm::vec3 before[3], after[3];
+            for (int k = 0; k < 3; ++k) {
+                before[k] = positionAt(p[k]);
+                after[k]  = p[k] == from ? positionAt(to) : before[k];
+            }
+            glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+            float     lengths      = glm::length(normalBefore) * glm::length(normalAfter);
+            if (lengths == 0.0f || glm::dot(normalBefore, normalAfter) < 0.25f * lengths) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::size_t targetTriangles = targetIndexCount / 3;
+    double      worstError      = 0.0;
+    while (aliveCount > targetTriangles && !queue.empty()) {
+        Collapse collapse = queue.top();
+        queue.pop();
+        if (collapse.fromVersion != version[collapse.from] || collapse.toVersion != version[collapse.to]
+            || !collapseIsValid(collapse.from, collapse.to)) {
+            continue;
+        }
+
+        std::uint32_t from = collapse.from;
+        std::uint32_t to   = collapse.to;
+        Quadric       sum  = quadrics[from];
+        sum += quadrics[to];
+        worstError = std::max(worstError, sum.weight > 0.0 ? collapse.cost / sum.weight : collapse.cost);
+
+        for (std::uint32_t t : trianglesAt[from]) {
+            if (!alive[t]) {
+                continue;
+            }
+            std::uint32_t* p = &cornerPositions[t * 3];
+            if (p[0] == to || p[1] == to || p[2] == to) {
+                alive[t] = 0;
+                --aliveCount;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                if (p[k] != from) {
+                    continue;
+                }
+                // Sommet d'arrivée dont la normale ressemble le plus à celle du coin déplacé
+                const glm::vec3& normal = vertices[corners[t * 3 + k]].normal;
+                std::uint32_t    best   = verticesAt[to].front();
+                for (std::uint32_t candidate : verticesAt[to]) {
+                    if (glm::dot(vertices[candidate].normal, normal) > glm::dot(vertices[best].normal, normal)) {
+                        best = candidate;
+                    }
+                }
+                p[k]               = to;
+                corners[t * 3 + k] = best;
+            }
+            trianglesAt[to].push_back(t);
+        }
+        trianglesAt[from].clear();
+        quadrics[to] = sum;
+        ++version[from];
+        ++version[to];
+
+        // Nouvelles contractions autour de la position d'arrivée
+        auto& around = trianglesAt[to];
+        around.erase(std::remove_if(around.begin(), around.end(), [&](std::uint32_t t) { return !alive[t]; }), around.end());
+        for (std::uint32_t t : around) {
+            const std::uint32_t* p = &cornerPositions[t * 3];
+            for (int k = 0; k < 3; ++k) {
+                if (p[k] != to) {
+                    pushEdge(to, p[k]);
+                }
+            }
+        }
+    }
+
+    result.clear();
+    result.reserve(aliveCount * 3);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        if (alive[t]) {
+            result.insert(result.end(), &corners[t * 3], &corners[t * 3] + 3);
+        }
+    }
+    return static_cast<float>(std::sqrt(worstError));
+}
+
+// Chaîne de niveaux de détail : chaque niveau vise la moitié des triangles du précédent,
+// jusqu'à MAX_LODS niveaux ou tant que la simplification progresse. MAX_LODS laisse
+// descendre un maillage de quelques dizaines de milliers de triangles jusqu'à
+// MIN_TRIANGLES : ce niveau fixe le nombre d'instances que le budget de triangles de
+// LodSelection peut dessiner. Les indices des
+// niveaux sont ajoutés à la suite de ceux du maillage complet (niveau 0).
+inline void buildLodChain(MeshData& mesh)
+{
+    constexpr std::size_t MAX_LODS      = 10;
+    constexpr std::size_t MIN_TRIANGLES = 64;
+
+    std::uint32_t baseCount = static_cast<std::uint32_t>(mesh.indices.size());
+    mesh.lods.assign(1, {0, baseCount, 0.0f});
+
+    std::vector<std::uint32_t> previous(mesh.indices.begin(), mesh.indices.end());
+    std::vector<std::uint32_t> simplified;
+    float                      error = 0.0f;
+    while (mesh.lods.size() < MAX_LODS && previous.size() / 3 > MIN_TRIANGLES) {
+        std::size_t target = previous.size() / 6 * 3;
+        error += simplifyMesh(mesh.vertices.data(), mesh.vertices.size(), previous.data(), previous.size(), target, simplified);
+        if (simplified.size() > previous.size() * 8 / 10) {
+            break; // Plus assez de contractions valides
+        }
+        mesh.lods.push_back({static_cast<std::uint32_t>(mesh.indices.size()), static_cast<std::uint32_t>(simplified.size()), error});
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+}
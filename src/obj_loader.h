@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "glm/glm.hpp"
+#include "mesh.h"
+
+// Analyse des fichiers OBJ / MTL directement sur leur texte (en général un fichier
+// projeté en mémoire), sans std::string ni flux, en un seul passage : les nombres
+// courts sont lus à la main, les autres avec std::from_chars.
+namespace obj {
+
+// Curseur sur une ligne du fichier. La fin de ligne n'est pas cherchée à l'avance :
+// chaque lecture s'arrête d'elle-même sur le '\n', m_end n'est que la fin du texte.
+class LineReader {
+public:
+    LineReader(const char* begin, const char* end)
+        : m_p(begin), m_end(end)
+    {}
+
+    const char* position() const { return m_p; }
+
+    // Les boucles avancent un pointeur local : un membre serait relu et réécrit en
+    // mémoire à chaque caractère dès que le compilateur ne peut exclure un alias
+    void skipSpaces()
+    {
+        const char* p = m_p;
+        while (p < m_end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            ++p;
+        }
+        m_p = p;
+    }
+
+    bool atEnd()
+    {
+        skipSpaces();
+        return m_p == m_end || *m_p == '\n';
+    }
+
+    // Mot suivant (jusqu'au prochain espace)
+    std::string_view word()
+    {
+        skipSpaces();
+        const char* begin = m_p;
+        const char* p     = begin;
+        while (p < m_end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            ++p;
+        }
+        m_p = p;
+        return {begin, static_cast<std::size_t>(p - begin)};
+    }
+
+    // Reste de la ligne sans les espaces de fin (noms pouvant contenir des espaces)
+    std::string_view rest()
+    {
+        skipSpaces();
+        const char* end = m_p;
+        while (end < m_end && *end != '\n') {
+            ++end;
+        }
+        while (end > m_p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+            --end;
+        }
+        return {m_p, static_cast<std::size_t>(end - m_p)};
+    }
+
+    bool readFloat(float& value)
+    {
+        skipSpaces();
+        if (m_p < m_end && *m_p == '+') {
+            ++m_p;
+        }
+        if (readShortDecimal(value)) {
+            return true;
+        }
+        auto [next, error] = std::from_chars(m_p, m_end, value);
+        m_p = next;
+        return error == std::errc{};
+    }
+
+    // Entier signé court (indice de face) : plus rapide que std::from_chars sur ces cas
+    bool readInt(int& value)
+    {
+        const char* p        = m_p;
+        bool        negative = p < m_end && *p == '-';
+        p += negative;
+        const char* digits = p;
+        unsigned    result = 0;
+        while (p < m_end && static_cast<unsigned>(*p - '0') < 10 && p - digits < 9) {
+            result = result * 10 + static_cast<unsigned>(*p - '0');
+            ++p;
+        }
+        m_p   = p;
+        value = negative ? -static_cast<int>(result) : static_cast<int>(result);
+        return p != digits && (p == m_end || static_cast<unsigned>(*p - '0') >= 10);
+    }
+
+    // Référence de sommet d'une face : v, v/vt, v//vn ou v/vt/vn (0 pour un indice absent)
+    bool readVertexRef(int& position, int& texCoord, int& normal)
+    {
+        skipSpaces();
+        texCoord = normal = 0;
+        if (!readInt(position)) {
+            return false;
+        }
+        if (m_p < m_end && *m_p == '/') {
+            ++m_p;
+            if (m_p < m_end && *m_p != '/' && !readInt(texCoord)) {
+                return false;
+            }
+            if (m_p < m_end && *m_p == '/') {
+                ++m_p;
+                if (!readInt(normal)) {
+                    return false;
+                }
+            }
+        }
+        return m_p == m_end || *m_p == ' ' || *m_p == '\t' || *m_p == '\r' || *m_p == '\n';
+    }
+
+private:
+    // Cas courant des exportateurs, « -0.123456 » : au plus 9 chiffres significatifs et
+    // pas d'exposant. La mantisse entière et la puissance de 10 sont exactes en double,
+    // le quotient est donc correctement arrondi. Les autres écritures passent par from_chars.
+    bool readShortDecimal(float& value)
+    {
+        static constexpr double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+        const char*   p        = m_p;
+        bool          negative = p < m_end && *p == '-';
+        std::uint32_t mantissa = 0;
+        int           digits   = 0;
+        int           decimals = 0;
+        p += negative;
+        for (; p < m_end && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits) {
+            mantissa = mantissa * 10 + static_cast<std::uint32_t>(*p - '0');
+        }
+        if (p < m_end && *p == '.') {
+            for (++p; p < m_end && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits, ++decimals) {
+                mantissa = mantissa * 10 + static_cast<std::uint32_t>(*p - '0');
+            }
+        }
+        if (digits == 0 || digits > 9 || (p < m_end && (*p == 'e' || *p == 'E'))) {
+            return false;
+        }
+        double result = static_cast<double>(mantissa) / POWERS_OF_TEN[decimals];
+        value         = static_cast<float>(negative ? -result : result);
+        m_p           = p;
+        return true;
+    }
+
+    const char* m_p;
+    const char* m_end;
+};
+
+// Appelle fn(LineReader&, std::string_view keyword) pour chaque ligne non vide qui
+// n'est pas un commentaire
+template<typename Fn>
+void forEachLine(std::string_view text, Fn&& fn)
+{
+    const char* p   = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        LineReader       line(p, end);
+        std::string_view keyword = line.word();
+        if (!keyword.empty() && keyword[0] != '#') {
+            fn(line, keyword);
+        }
+        // Après une ligne lue en entier, le curseur est déjà sur son '\n'
+        p = line.position();
+        while (p < end && *p != '\n') {
+            ++p;
+        }
+        ++p;
+    }
+}
+
+// Convertit un indice OBJ (à partir de 1, ou négatif depuis la fin) en indice C++.
+// Renvoie -1 s'il est nul ou hors limites.
+inline std::int64_t resolveIndex(int index, std::size_t count)
+{
+    std::int64_t resolved = index > 0 ? std::int64_t{index} - 1 : static_cast<std::int64_t>(count) + index;
+    return (index != 0 && resolved >= 0 && resolved < static_cast<std::int64_t>(count)) ? resolved : -1;
+}
+
+// Fusion des triplets (v, vt, vn) identiques. Les sommets créés pour une même position
+// sont chaînés entre eux : une recherche ne parcourt que les quelques variantes
+// (coordonnées de texture, normale) de cette position, dans des tableaux compacts.
+class VertexDeduplicator {
+public:
+    explicit VertexDeduplicator(std::size_t positionCount, std::size_t expectedVertices = 0)
+        : m_firstVertex(positionCount, NONE)
+    {
+        m_vertices.reserve(expectedVertices);
+    }
+
+    // Renvoie l'indice du sommet, ou l'ajoute avec makeVertex() s'il est nouveau
+    template<typename MakeVertexFn>
+    std::uint32_t find(std::uint32_t position, std::uint32_t texCoord, std::uint32_t normal, MakeVertexFn&& makeVertex)
+    {
+        if (position >= m_firstVertex.size()) {
+            m_firstVertex.resize(position + 1, NONE);
+        }
+        for (std::uint32_t v = m_firstVertex[position]; v != NONE; v = m_vertices[v].next) {
+            if (m_vertices[v].texCoord == texCoord && m_vertices[v].normal == normal) {
+                return v;
+            }
+        }
+        std::uint32_t vertex = makeVertex();
+        if (vertex >= m_vertices.size()) {
+            m_vertices.resize(vertex + 1);
+        }
+        m_vertices[vertex]      = {texCoord, normal, m_firstVertex[position]};
+        m_firstVertex[position] = vertex;
+        return vertex;
+    }
+
+private:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Key {
+        std::uint32_t texCoord;
+        std::uint32_t normal;
+        std::uint32_t next; // Sommet suivant de la même position
+    };
+
+    std::vector<std::uint32_t> m_firstVertex; // Dernier sommet créé pour chaque position
+    std::vector<Key>           m_vertices;
+};
+
+} // namespace obj
+
+// Lit les matériaux d'un fichier MTL (newmtl, Kd, map_Kd avec l'option -s)
+inline void parseMtl(std::string_view mtlText, std::vector<MeshMaterial>& materials)
+{
+    obj::forEachLine(mtlText, [&](obj::LineReader& line, std::string_view keyword) {
+        if (keyword == "newmtl") {
+            MeshMaterial material{};
+            MeshMaterial::copyString(material.name, MeshMaterial::NAME_SIZE, line.rest());
+            material.diffuse      = glm::vec3(1.0f);
+            material.textureScale = glm::vec3(1.0f);
+            materials.push_back(material);
+        }
+        else if (materials.empty()) {
+            return;
+        }
+        else if (keyword == "Kd") {
+            glm::vec3& diffuse = materials.back().diffuse;
+            line.readFloat(diffuse.r) && line.readFloat(diffuse.g) && line.readFloat(diffuse.b);
+        }
+        else if (keyword == "map_Kd") {
+            std::string_view texturePath = line.rest();
+            // Check if there are scaling parameters
+            if (line.word() == "-s") {
+                glm::vec3& scale = materials.back().textureScale;
+                line.readFloat(scale.x) && line.readFloat(scale.y) && line.readFloat(scale.z);
+                // Read the actual texture path
+                texturePath = line.rest();
+            }
+            MeshMaterial::copyString(materials.back().texturePath, MeshMaterial::PATH_SIZE, texturePath);
+        }
+    });
+}
+
+// Construit un maillage indexé à partir d'un fichier OBJ. Les faces peuvent s'écrire
+// v, v/vt, v//vn ou v/vt/vn, avec des indices négatifs (relatifs à la fin), et les
+// polygones sont découpés en éventail. Chaque triplet (position, coordonnées de
+// texture, normale) distinct devient un sommet. Les faces mal formées sont ignorées.
+// Renvoie false si le fichier ne contient aucune face.
+inline bool parseObj(std::string_view objText, std::string_view mtlText, MeshData& mesh)
+{
+    mesh = MeshData{};
+    parseMtl(mtlText, mesh.materials);
+
+    // Un seul passage : les tableaux grandissent au fil de la lecture, ce qui coûte moins
+    // qu'un premier parcours du texte pour compter les lignes
+    std::vector<glm::vec3>  positions;
+    std::vector<glm::vec3>  normals;
+    std::vector<glm::vec2>  texCoords;
+    obj::VertexDeduplicator deduplicator(0);
+
+    // Faces rangées par matériau (la dernière liste reçoit les faces sans matériau),
+    // pour que chaque matériau occupe une plage d'indices contiguë
+    std::vector<std::vector<std::uint32_t>> indicesByMaterial(mesh.materials.size() + 1);
+    std::size_t                             currentMaterial = mesh.materials.size();
+
+    // Polygone courant (références lues puis sommets), réutilisés d'une face à l'autre
+    struct FaceRef {
+        std::uint32_t position, texCoord, normal;
+    };
+    constexpr std::uint32_t    NO_INDEX = 0xFFFFFFFFu;
+    std::vector<FaceRef>       faceRefs;
+    std::vector<std::uint32_t> face;
+
+    obj::forEachLine(objText, [&](obj::LineReader& line, std::string_view keyword) {
+        if (keyword == "v") {
+            glm::vec3 vertex{0.0f};
+            line.readFloat(vertex.x) && line.readFloat(vertex.y) && line.readFloat(vertex.z);
+            positions.push_back(vertex);
+        }
+        else if (keyword == "vn") {
+            glm::vec3 normal{0.0f};
+            line.readFloat(normal.x) && line.readFloat(normal.y) && line.readFloat(normal.z);
+            normals.push_back(normal);
+        }
+        else if (keyword == "vt") {
+            glm::vec2 texCoord{0.0f};
+            line.readFloat(texCoord.s) && line.readFloat(texCoord.t);
+            texCoords.push_back(texCoord);
+        }
+        else if (keyword == "usemtl") {
+            std::string_view name = line.rest();
+            currentMaterial       = mesh.materials.size();
+            for (std::size_t m = 0; m < mesh.materials.size(); ++m) {
+                if (mesh.materials[m].nameView() == name) {
+                    currentMaterial = m;
+                }
+            }
+        }
+        else if (keyword == "f") {
+            // Valider toute la face avant de créer ses sommets. Les indices absents
+            // sont codés par 0xFFFFFFFF.
+            faceRefs.clear();
+            while (!line.atEnd()) {
+                int position, texCoord, normal;
+                if (!line.readVertexRef(position, texCoord, normal)) {
+                    return;
+                }
+                std::int64_t p = obj::resolveIndex(position, positions.size());
+                std::int64_t t = texCoord != 0 ? obj::resolveIndex(texCoord, texCoords.size()) : -1;
+                std::int64_t n = normal != 0 ? obj::resolveIndex(normal, normals.size()) : -1;
+                if (p < 0 || (texCoord != 0 && t < 0) || (normal != 0 && n < 0)) {
+                    return;
+                }
+                faceRefs.push_back({static_cast<std::uint32_t>(p), static_cast<std::uint32_t>(t), static_cast<std::uint32_t>(n)});
+            }
+
+            face.clear();
+            for (const FaceRef& ref : faceRefs) {
+                face.push_back(deduplicator.find(ref.position, ref.texCoord, ref.normal, [&] {
+                    MeshVertex vertex{};
+                    vertex.position  = positions[ref.position];
+                    vertex.texCoords = ref.texCoord != NO_INDEX ? texCoords[ref.texCoord] : glm::vec2(0.0f);
+                    vertex.normal    = ref.normal != NO_INDEX ? normals[ref.normal] : glm::vec3(0.0f);
+                    mesh.vertices.push_back(vertex);
+                    return static_cast<std::uint32_t>(mesh.vertices.size() - 1);
+                }));
+            }
+            std::vector<std::uint32_t>& indices = indicesByMaterial[currentMaterial];
+            for (std::size_t k = 2; k < face.size(); ++k) {
+                indices.push_back(face[0]);
+                indices.push_back(face[k - 1]);
+                indices.push_back(face[k]);
+            }
+        }
+    });
+
+    std::size_t indexCount = 0;
+    for (const auto& indices : indicesByMaterial) {
+        indexCount += indices.size();
+    }
+    for (std::size_t m = 0; m < indicesByMaterial.size(); ++m) {
+        if (m < mesh.materials.size()) {
+            mesh.materials[m].firstIndex = static_cast<std::uint32_t>(mesh.indices.size());
+            mesh.materials[m].indexCount = static_cast<std::uint32_t>(indicesByMaterial[m].size());
+        }
+        if (mesh.indices.empty()) {
+            // La première liste non vide est reprise sans copie (souvent la seule)
+            mesh.indices = std::move(indicesByMaterial[m]);
+            mesh.indices.reserve(indexCount);
+        }
+        else {
+            mesh.indices.insert(mesh.indices.end(), indicesByMaterial[m].begin(), indicesByMaterial[m].end());
+        }
+    }
+
+    mesh.computeBounds();
+    return !mesh.indices.empty();
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Intervalle mesuré par une ProfileScope (ou un minuteur GPU), en nanosecondes depuis
+// le démarrage du profileur. depth : nombre de portées ouvertes autour, sur le même fil.
+struct ProfileEvent {
+    const char*   name;
+    std::int64_t  start;
+    std::int64_t  end;
+    std::uint32_t depth;
+};
+
+// Profileur de frame : chaque fil range ses événements dans son propre anneau (les plus
+// anciens sont écrasés), que le fil de rendu relit pour l'affichage ou l'export au format
+// Chrome (chrome://tracing, Perfetto). Désactivé, une portée coûte une lecture atomique.
+class Profiler {
+public:
+    static constexpr std::size_t RING_SIZE = 1 << 14; // Événements conservés par fil
+
+    // Événements d'un fil dans l'ordre de fin
+    struct ThreadEvents {
+        std::uint32_t             id = 0;
+        std::string               name;
+        std::vector<ProfileEvent> events;
+    };
+
+    Profiler()
+        : m_epoch(Clock::now())
+    {}
+
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    std::int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count(); }
+
+    // Marque le début d'une frame : la précédente devient la dernière frame complète
+    void beginFrame()
+    {
+        std::int64_t start = now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastFrame  = {m_frameStart, start};
+        m_frameStart = start;
+    }
+
+    // Début et fin de la dernière frame complète
+    std::pair<std::int64_t, std::int64_t> lastFrame() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lastFrame;
+    }
+
+    // Nom affiché pour le fil appelant
+    void setThreadName(const char* name)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    // Ajoute un événement à l'anneau du fil appelant (name doit rester valide : un littéral)
+    void record(const char* name, std::int64_t start, std::int64_t end, std::uint32_t depth) { threadBuffer().push({name, start, end, depth}); }
+
+    // Piste qui n'est celle d'aucun fil (mesures GPU) : ses événements sont ajoutés par recordOnTrack
+    std::size_t createTrack(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return addBuffer(name).id - 1;
+    }
+
+    void recordOnTrack(std::size_t track, const char* name, std::int64_t start, std::int64_t end)
+    {
+        ThreadBuffer* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            buffer = m_threads[track].get();
+        }
+        buffer->push({name, start, end, 0});
+    }
+
+    // Événements de chaque fil qui se terminent dans [from, to), rangés dans threads. Les
+    // tampons laissés par l'appel précédent sont réutilisés : appelée à chaque frame avec
+    // le même vecteur, elle n'alloue plus rien une fois les tailles de régime atteintes.
+    void collect(std::int64_t from, std::int64_t to, std::vector<ThreadEvents>& threads) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        threads.resize(m_threads.size());
+        for (std::size_t t = 0; t < m_threads.size(); ++t) {
+            ThreadBuffer&               buffer = *m_threads[t];
+            ThreadEvents&               thread = threads[t];
+            std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+            thread.id   = buffer.id;
+            thread.name = buffer.name;
+            thread.events.clear();
+            std::size_t first = buffer.written > RING_SIZE ? buffer.written - RING_SIZE : 0;
+            for (std::size_t i = first; i < buffer.written; ++i) {
+                const ProfileEvent& event = buffer.ring[i % RING_SIZE];
+                if (event.end >= from && event.end < to) {
+                    thread.events.push_back(event);
+                }
+            }
+        }
+    }
+
+    std::vector<ThreadEvents> collect(std::int64_t from, std::int64_t to) const
+    {
+        std::vector<ThreadEvents> threads;
+        collect(from, to, threads);
+        return threads;
+    }
+
+    // Tous les événements encore en mémoire, au format JSON « Trace Event » de Chrome
+    void writeChromeTrace(std::ostream& out) const
+    {
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const ThreadEvents& thread : collect(INT64_MIN, INT64_MAX)) {
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+                << ",\"args\":{\"name\":\"" << thread.name << "\"}}";
+            first = false;
+            for (const ProfileEvent& event : thread.events) {
+                // Horodatages en microsecondes
+                out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id
+                    << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    // Profondeur de portée du fil appelant (voir ProfileScope)
+    static std::uint32_t& threadDepth()
+    {
+        static thread_local std::uint32_t depth = 0;
+        return depth;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadBuffer {
+        std::mutex                mutex; // Pris par le fil propriétaire à chaque ajout, jamais disputé hors lecture
+        std::vector<ProfileEvent> ring = std::vector<ProfileEvent>(RING_SIZE);
+        std::size_t               written = 0;
+        std::uint32_t             id = 0;
+        std::string               name;
+
+        void push(const ProfileEvent& event)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ring[written % RING_SIZE] = event;
+            ++written;
+        }
+    };
+
+    // m_mutex doit être pris
+    ThreadBuffer& addBuffer(std::string name)
+    {
+        m_threads.push_back(std::make_unique<ThreadBuffer>());
+        ThreadBuffer& buffer = *m_threads.back();
+        buffer.id            = static_cast<std::uint32_t>(m_threads.size());
+        buffer.name          = std::move(name);
+        return buffer;
+    }
+
+    // Anneau du fil appelant, créé à sa première utilisation. Les anneaux vivent aussi
+    // longtemps que le profileur : un fil terminé garde ses événements.
+    ThreadBuffer& threadBuffer()
+    {
+        thread_local Profiler*     owner  = nullptr;
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (owner != this) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            buffer = &addBuffer("Thread " + std::to_string(m_threads.size() + 1));
+            owner  = this;
+        }
+        return *buffer;
+    }
+
+    Clock::time_point                          m_epoch;
+    std::atomic<bool>                          m_enabled{false};
+    mutable std::mutex                         m_mutex; // Protège m_threads et les frames
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+    std::int64_t                               m_frameStart = 0;
+    std::pair<std::int64_t, std::int64_t>      m_lastFrame{0, 0};
+};
+
+// Profileur partagé par toute l'application
+inline Profiler& profiler()
+{
+    static Profiler instance;
+    return instance;
+}
+
+// Mesure la durée de vie de la portée qui la contient (voir PROFILE_SCOPE)
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : m_name(profiler().enabled() ? name : nullptr)
+    {
+        if (m_name != nullptr) {
+            m_depth = Profiler::threadDepth()++;
+            m_start = profiler().now();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (m_name != nullptr) {
+            --Profiler::threadDepth();
+            profiler().record(m_name, m_start, profiler().now(), m_depth);
+        }
+    }
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char*   m_name;
+    std::int64_t  m_start = 0;
+    std::uint32_t m_depth = 0;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
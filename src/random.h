@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+#include "simd.h"
+
+// Générateur à compteur Philox4x32-10 (Salmon et al., « Parallel random numbers: as easy
+// as 1, 2, 3 ») : chaque bloc de 4 mots de 32 bits est une fonction pure de la clé (la
+// graine) et d'un compteur de 128 bits. Il n'y a pas d'état à partager : deux fils qui
+// utilisent des compteurs différents tirent des suites indépendantes et reproductibles.
+namespace philox {
+
+constexpr std::uint32_t MULTIPLIER_0 = 0xD2511F53u;
+constexpr std::uint32_t MULTIPLIER_1 = 0xCD9E8D57u;
+constexpr std::uint32_t WEYL_0       = 0x9E3779B9u;
+constexpr std::uint32_t WEYL_1       = 0xBB67AE85u;
+constexpr int           ROUNDS       = 10;
+
+inline void block(const std::uint32_t counter[4], std::uint64_t key, std::uint32_t out[4])
+{
+    std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    std::uint32_t k0 = static_cast<std::uint32_t>(key), k1 = static_cast<std::uint32_t>(key >> 32);
+    for (int round = 0; round < ROUNDS; ++round) {
+        std::uint64_t p0 = static_cast<std::uint64_t>(MULTIPLIER_0) * c0;
+        std::uint64_t p1 = static_cast<std::uint64_t>(MULTIPLIER_1) * c2;
+        c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        c1 = static_cast<std::uint32_t>(p1);
+        c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c3 = static_cast<std::uint32_t>(p0);
+        k0 += WEYL_0;
+        k1 += WEYL_1;
+    }
+    out[0] = c0, out[1] = c1, out[2] = c2, out[3] = c3;
+}
+
+// Mot de 32 bits -> flottant uniforme dans [0, 1) (24 bits de mantisse)
+inline float toUnit(std::uint32_t word)
+{
+    return static_cast<float>(word >> 8) * (1.0f / 16777216.0f);
+}
+
+} // namespace philox
+
+// Suite de tirages identifiée par (graine, flux, indice) : le flux distingue les usages
+// (apparition, chaîne de Markov...), l'indice l'objet tiré (un boid, un pas de
+// simulation). Les mots sont lus dans l'ordre des blocs ; seek() place la lecture
+// n'importe où, ce qui permet de remplir un tableau par tranches sur plusieurs fils
+// avec exactement les valeurs d'un remplissage séquentiel.
+class CounterRng {
+public:
+    CounterRng() = default;
+    CounterRng(std::uint64_t seed, std::uint32_t stream, std::uint64_t index = 0)
+        : m_seed(seed)
+        , m_stream(stream)
+        , m_index(index)
+    {}
+
+    // Place la lecture sur le mot n de la suite
+    void seek(std::uint64_t word)
+    {
+        m_block = static_cast<std::uint32_t>(word / 4);
+        m_used  = 4;
+        if (word % 4 != 0) {
+            refill();
+            m_used = static_cast<std::uint32_t>(word % 4);
+        }
+    }
+
+    std::uint32_t nextUint()
+    {
+        if (m_used == 4) {
+            refill();
+        }
+        return m_words[m_used++];
+    }
+
+    // Uniforme dans [0, 1)
+    float uniform() { return philox::toUnit(nextUint()); }
+    float uniform(float min, float max) { return min + uniform() * (max - min); }
+
+    // Loi exponentielle de paramètre lambda (1 - u est dans (0, 1] : le logarithme est fini)
+    float exponential(float lambda) { return -std::log(1.0f - uniform()) / lambda; }
+
+    // Loi de Poisson (méthode de Knuth, adaptée aux petits lambda)
+    int poisson(float lambda)
+    {
+        const float limit = std::exp(-lambda);
+        int         k     = 0;
+        float       p     = uniform();
+        while (p > limit) {
+            ++k;
+            p *= uniform();
+        }
+        return k;
+    }
+
+    // Point uniforme sur la sphère de rayon donné (z uniforme, angle uniforme autour de z)
+    glm::vec3 onSphere(float radius)
+    {
+        float z     = uniform(-1.0f, 1.0f);
+        float angle = uniform(0.0f, 2.0f * static_cast<float>(M_PI));
+        float r     = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        return glm::vec3(r * std::cos(angle), r * std::sin(angle), z) * radius;
+    }
+
+    // Remplissages par lots : 16 mots par itération avec SSE2. Le résultat est le même
+    // que celui d'autant d'appels successifs à uniform(min, max).
+    void fillUniform(float* out, std::size_t count, float min = 0.0f, float max = 1.0f)
+    {
+        const float range = max - min;
+        std::size_t i     = 0;
+        // Finir le bloc entamé
+        for (; i < count && m_used < 4; ++i) {
+            out[i] = min + uniform() * range;
+        }
+#if SIMD_HAS_SSE2
+        const __m128 scale = _mm_set1_ps(range * (1.0f / 16777216.0f));
+        const __m128 base  = _mm_set1_ps(min);
+        for (; i + 16 <= count; i += 16) {
+            __m128i words[4];
+            blocks4(words);
+            __m128 rows[4];
+            for (int w = 0; w < 4; ++w) {
+                rows[w] = _mm_add_ps(base, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(words[w], 8)), scale));
+            }
+            // Mot w du bloc b dans rows[w][b] : transposer pour ranger les blocs à la suite
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+            for (int b = 0; b < 4; ++b) {
+                _mm_storeu_ps(out + i + 4 * b, rows[b]);
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = min + uniform() * range;
+        }
+    }
+
+    void fillExponential(float* out, std::size_t count, float lambda)
+    {
+        fillUniform(out, count);
+        const float inverse = 1.0f / lambda;
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = -std::log(1.0f - out[i]) * inverse;
+        }
+    }
+
+    // Le nombre de mots consommés par tirage varie : pas de version par paquets
+    void fillPoisson(int* out, std::size_t count, float lambda)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = poisson(lambda);
+        }
+    }
+
+    // Points sur la sphère, en colonnes : les hauteurs puis les angles sont tirés par lots
+    void fillOnSphere(float* x, float* y, float* z, std::size_t count, float radius)
+    {
+        fillUniform(z, count, -1.0f, 1.0f);
+        fillUniform(x, count, 0.0f, 2.0f * static_cast<float>(M_PI));
+        for (std::size_t i = 0; i < count; ++i) {
+            float r = std::sqrt(std::max(0.0f, 1.0f - z[i] * z[i])) * radius;
+            y[i]    = r * std::sin(x[i]);
+            x[i]    = r * std::cos(x[i]);
+            z[i] *= radius;
+        }
+    }
+
+private:
+    void counter(std::uint32_t block, std::uint32_t out[4]) const
+    {
+        out[0] = block;
+        out[1] = static_cast<std::uint32_t>(m_index);
+        out[2] = static_cast<std::uint32_t>(m_index >> 32);
+        out[3] = m_stream;
+    }
+
+    void refill()
+    {
+        std::uint32_t c[4];
+        counter(m_block++, c);
+        philox::block(c, m_seed, m_words);
+        m_used = 0;
+    }
+
+#if SIMD_HAS_SSE2
+    // Produit 32 x 32 -> 64 bits de chaque voie par une constante : moitiés basse et haute
+    static void mulHiLo(__m128i a, std::uint32_t multiplier, __m128i& lo, __m128i& hi)
+    {
+        const __m128i m        = _mm_set1_epi32(static_cast<int>(multiplier));
+        const __m128i lowMask  = _mm_set_epi32(0, -1, 0, -1);
+        const __m128i even     = _mm_mul_epu32(a, m);                     // Voies 0 et 2
+        const __m128i odd      = _mm_mul_epu32(_mm_srli_epi64(a, 32), m); // Voies 1 et 3
+        lo = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+        hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+    }
+
+    // Quatre blocs consécutifs calculés ensemble : words[w] contient le mot w de chacun
+    void blocks4(__m128i words[4])
+    {
+        std::uint32_t c[4];
+        counter(m_block, c);
+        __m128i c0 = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(c[0])), _mm_set_epi32(3, 2, 1, 0));
+        __m128i c1 = _mm_set1_epi32(static_cast<int>(c[1]));
+        __m128i c2 = _mm_set1_epi32(static_cast<int>(c[2]));
+        __m128i c3 = _mm_set1_epi32(static_cast<int>(c[3]));
+        std::uint32_t k0 = static_cast<std::uint32_t>(m_seed), k1 = static_cast<std::uint32_t>(m_seed >> 32);
+        for (int round = 0; round < philox::ROUNDS; ++round) {
+            __m128i lo0, hi0, lo1, hi1;
+            mulHiLo(c0, philox::MULTIPLIER_0, lo0, hi0);
+            mulHiLo(c2, philox::MULTIPLIER_1, lo1, hi1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+            c3 = lo0;
+            k0 += philox::WEYL_0;
+            k1 += philox::WEYL_1;
+        }
+        words[0] = c0, words[1] = c1, words[2] = c2, words[3] = c3;
+        m_block += 4;
+    }
+#endif
+
+    std::uint64_t m_seed   = 0;
+    std::uint32_t m_stream = 0;
+    std::uint64_t m_index  = 0;
+    std::uint32_t m_block  = 0; // Prochain bloc à calculer
+    std::uint32_t m_words[4]{};
+    std::uint32_t m_used = 4; // Mots déjà lus dans m_words
+};
+
+// Flux des générateurs propres à chaque fil (voir threadRandom)
+constexpr std::uint32_t THREAD_RANDOM_STREAM = 0xFFFFFFFFu;
+
+// Graine commune des générateurs de fil
+inline std::atomic<std::uint64_t>& randomSeed()
+{
+    static std::atomic<std::uint64_t> seed{0};
+    return seed;
+}
+
+// Rang du fil appelant dans l'ordre où les fils ont tiré leur premier nombre
+inline std::uint64_t threadOrdinal()
+{
+    static std::atomic<std::uint64_t> next{0};
+    thread_local std::uint64_t        ordinal = next++;
+    return ordinal;
+}
+
+// Générateur du fil appelant : chaque fil a sa propre suite, sans état partagé
+inline CounterRng& threadRandom()
+{
+    thread_local CounterRng rng(randomSeed().load(), THREAD_RANDOM_STREAM, threadOrdinal());
+    return rng;
+}
+
+// Change la graine commune et réinitialise le générateur du fil appelant
+inline void seedRandom(std::uint64_t seed)
+{
+    randomSeed()   = seed;
+    threadRandom() = CounterRng(seed, THREAD_RANDOM_STREAM, threadOrdinal());
+}
+
+// Génère un nombre aléatoire dans l'intervalle [min, max)
+inline float linearRand(float min, float max) {
+    return threadRandom().uniform(min, max);
+}
+
+inline glm::vec3 customSphericalRand(float radius) {
+    return threadRandom().onSphere(radius);
+}
+
+// Définir une fonction pour générer aléatoirement l'état de l'interrupteur (jour ou nuit) avec une distribution de Poisson
+inline bool generateSwitchState(float lambda) {
+    // Si le nombre de "cliques" est impair, c'est la nuit, sinon c'est le jour
+    return threadRandom().poisson(lambda) % 2 == 0;
+}
+
+inline float generateStateChangeTime(float lambda) {
+    return threadRandom().exponential(lambda);
+}
+
+inline float generateExp(float lambda) {
+    return threadRandom().exponential(lambda);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+#include "instance_buffer.h"
+#include "p6/p6.h"
+#include "shader_program.h"
+
+// Paquet de dessin enregistré pendant la frame : tout l'état nécessaire au dessin, sans
+// appel OpenGL. Program doit fournir id() (ShaderProgram en pratique).
+template<typename Program>
+struct DrawPacket {
+    const Program* program = nullptr;
+    GLuint         vao     = 0;
+    GLenum         textureTarget = GL_TEXTURE_2D; // Matériau lié à l'unité 0 (0 : aucun)
+    GLuint         texture       = 0;
+    bool           transparent   = false; // Mélange alpha, dessiné après tous les objets opaques
+    float          depth         = 0.0f;  // Distance à la caméra
+
+    // Plage d'indices (un niveau de détail)
+    GLuint  firstIndex = 0;
+    GLsizei indexCount = 0;
+
+    // Dessin instancié si instanceCount > 0 : instances [firstInstance, firstInstance + instanceCount) du tampon
+    const InstanceBuffer* instances     = nullptr;
+    GLsizei               firstInstance = 0;
+    GLsizei               instanceCount = 0;
+
+    // Uniformes propres à l'objet (uModelMatrix, uColor et uDomeColor), envoyés juste avant le dessin
+    bool      hasObjectUniforms = false;
+    glm::mat4 modelMatrix{1.0f};
+    glm::vec4 color{1.0f};
+};
+
+// File de dessin d'une frame : les paquets sont triés par une clé de 64 bits puis soumis
+// à un Backend, qui n'est appelé que lorsqu'un état change réellement.
+//
+// Clé, du bit de poids fort au bit de poids faible :
+//   opaque      : 0 | programme (8) | VAO (12) | matériau (12) | profondeur croissante (24) | -
+//   transparent : 1 | profondeur décroissante (24) | programme (8) | VAO (12) | matériau (12) | -
+// Les opaques sont regroupés par état puis dessinés de l'avant vers l'arrière ; les
+// transparents viennent ensuite, de l'arrière vers l'avant. Les noms OpenGL sont tronqués
+// dans la clé : deux objets peuvent partager un groupe, mais submit compare les vrais
+// noms avant de sauter un changement d'état.
+//
+// Backend : setBlend(bool), useProgram(const Program&), bindVertexArray(GLuint),
+// bindTexture(GLenum, GLuint), setObjectUniforms(const Program&, const glm::mat4&,
+// const glm::vec4&) et draw(const DrawPacket<Program>&).
+template<typename Program>
+class RenderQueue {
+public:
+    using Packet = DrawPacket<Program>;
+
+    static std::uint64_t sortKey(const Packet& packet)
+    {
+        std::uint64_t program  = packet.program->id() & 0xFFu;
+        std::uint64_t vao      = packet.vao & 0xFFFu;
+        std::uint64_t material = packet.texture & 0xFFFu;
+        // Les flottants positifs se comparent comme leurs bits : on garde les 24 bits de poids fort
+        std::uint64_t depth = std::bit_cast<std::uint32_t>(std::max(packet.depth, 0.0f)) >> 7;
+        if (!packet.transparent) {
+            return program << 55 | vao << 43 | material << 31 | depth << 7;
+        }
+        return std::uint64_t{1} << 63 | (0xFFFFFFu - depth) << 39 | program << 31 | vao << 19 | material << 7;
+    }
+
+    void push(const Packet& packet) { m_packets.push_back(packet); }
+
+    std::size_t size() const { return m_packets.size(); }
+
+    // Trie les paquets, les soumet puis vide la file. Le premier paquet fixe tout l'état ;
+    // à la fin, le mélange est désactivé et le VAO délié.
+    template<typename Backend>
+    void submit(Backend& backend)
+    {
+        // La position d'enregistrement départage les clés égales : le tri reste stable
+        m_order.clear();
+        for (std::size_t i = 0; i < m_packets.size(); ++i) {
+            m_order.emplace_back(sortKey(m_packets[i]), static_cast<std::uint32_t>(i));
+        }
+        std::sort(m_order.begin(), m_order.end());
+
+        bool first = true;
+        bool blend = false;
+        const Program* program = nullptr;
+        GLuint vao = 0;
+        GLenum textureTarget = 0;
+        GLuint texture = 0;
+        for (const auto& [key, index] : m_order) {
+            const Packet& packet = m_packets[index];
+            if (first || packet.transparent != blend) {
+                blend = packet.transparent;
+                backend.setBlend(blend);
+            }
+            if (first || packet.program != program) {
+                program = packet.program;
+                backend.useProgram(*program);
+            }
+            if (first || packet.vao != vao) {
+                vao = packet.vao;
+                backend.bindVertexArray(vao);
+            }
+            if (first || packet.textureTarget != textureTarget || packet.texture != texture) {
+                textureTarget = packet.textureTarget;
+                texture = packet.texture;
+                backend.bindTexture(textureTarget, texture);
+            }
+            if (packet.hasObjectUniforms) {
+                backend.setObjectUniforms(*program, packet.modelMatrix, packet.color);
+            }
+            backend.draw(packet);
+            first = false;
+        }
+        if (!first) {
+            if (blend) {
+                backend.setBlend(false);
+            }
+            backend.bindVertexArray(0);
+        }
+        m_packets.clear();
+    }
+
+private:
+    std::vector<Packet>                                  m_packets;
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> m_order;
+};
+
+// Backend OpenGL de RenderQueue<ShaderProgram>
+struct GlRenderBackend {
+    void setBlend(bool enabled) const
+    {
+        if (enabled) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            glDisable(GL_BLEND);
+        }
+    }
+
+    void useProgram(const ShaderProgram& program) const { program.use(); }
+
+    void bindVertexArray(GLuint vao) const { glBindVertexArray(vao); }
+
+    void bindTexture(GLenum target, GLuint texture) const
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(target, texture);
+    }
+
+    // uColor donne la couleur de l'objet, l'alpha de uDomeColor sa transparence
+    void setObjectUniforms(const ShaderProgram& program, const glm::mat4& modelMatrix, const glm::vec4& color) const
+    {
+        program.set("uModelMatrix"_uniform, modelMatrix);
+        program.set("uColor"_uniform, glm::vec3(color));
+        program.set("uDomeColor"_uniform, color);
+    }
+
+    void draw(const DrawPacket<ShaderProgram>& packet) const
+    {
+        if (packet.instanceCount > 0) {
+            packet.instances->drawBound(packet.firstIndex, packet.indexCount, packet.firstInstance, packet.instanceCount);
+        } else {
+            glDrawElements(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, (const GLvoid*)(packet.firstIndex * sizeof(GLuint)));
+        }
+    }
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include "p6/p6.h"
+
+// Identifiant d'uniforme : empreinte FNV-1a du nom, calculée à la compilation quand le
+// nom est une constante
+using UniformId = std::uint32_t;
+
+constexpr UniformId uniformId(std::string_view name)
+{
+    std::uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// Forme littérale, toujours évaluée à la compilation : "uModelMatrix"_uniform
+consteval UniformId operator""_uniform(const char* name, std::size_t length)
+{
+    return uniformId(std::string_view(name, length));
+}
+
+// Données de caméra communes à tous les shaders, envoyées une fois par frame dans le
+// bloc `Camera` (disposition std140, voir shaders/*.glsl)
+struct CameraUniforms {
+    static constexpr GLuint BINDING = 0;
+    static constexpr UniformId BLOCK = "Camera"_uniform;
+
+    glm::mat4 mvpMatrix;        // uMVPMatrix : projection * vue
+    glm::mat4 mvMatrix;         // uMVMatrix : vue
+    glm::mat4 normalMatrix;     // uNormalMatrix : inverse transposée de la vue
+    glm::vec4 surveyorPosition; // uSurveyorPosition : lumière portée par l'arpenteur (w inutilisé)
+};
+static_assert(offsetof(CameraUniforms, mvMatrix) == 64 && offsetof(CameraUniforms, normalMatrix) == 128
+                  && offsetof(CameraUniforms, surveyorPosition) == 192 && sizeof(CameraUniforms) == 208,
+              "CameraUniforms doit suivre la disposition std140 du bloc Camera");
+
+// Tampon d'uniformes (UBO) lié une fois pour toutes à un point de liaison ; update()
+// le réécrit en un seul appel
+template<typename T>
+class UniformBuffer {
+public:
+    explicit UniformBuffer(GLuint binding)
+    {
+        glGenBuffers(1, &m_ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    ~UniformBuffer() { glDeleteBuffers(1, &m_ubo); }
+
+    UniformBuffer(const UniformBuffer&)            = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    void update(const T& data) const
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    GLuint m_ubo = 0;
+};
+
+// Programme de shader dont les uniformes actifs sont relevés une fois, après l'édition
+// de liens : set() retrouve l'emplacement dans une table triée par identifiant, sans
+// appeler glGetUniformLocation. Les blocs d'uniformes sont reliés à leur point de
+// liaison avec bindBlock.
+class ShaderProgram {
+public:
+    explicit ShaderProgram(p6::Shader shader)
+        : m_shader(std::move(shader))
+    {
+        GLuint program = m_shader.id();
+
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint   size   = 0;
+            GLenum  type   = 0;
+            glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+            GLint location = glGetUniformLocation(program, name.c_str());
+            if (location < 0) {
+                continue; // Membre d'un bloc d'uniformes
+            }
+            // Les tableaux sont nommés « nom[0] » : on les range sous « nom »
+            std::string_view view(name.data(), static_cast<std::size_t>(length));
+            if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") {
+                view.remove_suffix(3);
+            }
+            m_uniforms.push_back({uniformId(view), location});
+        }
+        std::sort(m_uniforms.begin(), m_uniforms.end());
+        for (std::size_t i = 1; i < m_uniforms.size(); ++i) {
+            if (m_uniforms[i].id == m_uniforms[i - 1].id) {
+                std::cerr << "Shader: two uniforms share the same name hash" << std::endl;
+            }
+        }
+
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+        name.assign(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(program, static_cast<GLuint>(i), maxLength, &length, name.data());
+            m_blocks.push_back({uniformId(std::string_view(name.data(), static_cast<std::size_t>(length))), static_cast<GLint>(i)});
+        }
+    }
+
+    void use() const { glUseProgram(m_shader.id()); }
+
+    GLuint id() const { return m_shader.id(); }
+
+    // Emplacement d'un uniforme actif, -1 s'il n'existe pas (ou a été retiré par le compilateur)
+    GLint location(UniformId id) const
+    {
+        auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), Entry{id, -1});
+        return it != m_uniforms.end() && it->id == id ? it->location : -1;
+    }
+
+    // Relie un bloc d'uniformes à un point de liaison ; sans effet si le bloc est absent
+    void bindBlock(UniformId block, GLuint binding) const
+    {
+        for (const Entry& entry : m_blocks) {
+            if (entry.id == block) {
+                glUniformBlockBinding(m_shader.id(), static_cast<GLuint>(entry.location), binding);
+            }
+        }
+    }
+
+    // À appeler sur le programme en cours d'utilisation (use)
+    void set(UniformId id, int value) const { glUniform1i(location(id), value); }
+    void set(UniformId id, float value) const { glUniform1f(location(id), value); }
+    void set(UniformId id, const glm::vec3& value) const { glUniform3fv(location(id), 1, glm::value_ptr(value)); }
+    void set(UniformId id, const glm::vec4& value) const { glUniform4fv(location(id), 1, glm::value_ptr(value)); }
+    void set(UniformId id, const glm::mat3& value) const { glUniformMatrix3fv(location(id), 1, GL_FALSE, glm::value_ptr(value)); }
+    void set(UniformId id, const glm::mat4& value) const { glUniformMatrix4fv(location(id), 1, GL_FALSE, glm::value_ptr(value)); }
+
+private:
+    // Uniforme (identifiant, emplacement) ou bloc (identifiant, indice du bloc)
+    struct Entry {
+        UniformId id;
+        GLint     location;
+        bool      operator<(const Entry& other) const { return id < other.id; }
+    };
+
+    p6::Shader         m_shader;
+    std::vector<Entry> m_uniforms;
+    std::vector<Entry> m_blocks;
+};
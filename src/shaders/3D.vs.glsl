@@ -7,11 +7,19 @@ layout(location = 2) in vec2 in_TexCoord;
 out vec3 frag_Normal;
 out vec3 frag_Position;
 out vec2 frag_TexCoord;
+out vec3 frag_Color;
+out vec3 frag_BoidPosition;
 
-uniform mat4 uMVPMatrix;
-uniform mat4 uMVMatrix;
-uniform mat4 uNormalMatrix;
+// Données de caméra communes, mises à jour une fois par frame (voir CameraUniforms)
+layout(std140) uniform Camera {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+    vec4 uSurveyorPosition; // Position de l'arpenteur (xyz)
+};
 uniform mat4 uModelMatrix; // New uniform for model matrix
+uniform vec3 uColor; // Couleur de l'objet
+uniform vec3 boidPosition; // Position du boid
 
 void main() {
     // Compute transformed normal
@@ -23,6 +31,10 @@ void main() {
     // Pass texture coordinates to fragment shader
     frag_TexCoord = in_TexCoord;
 
+    // Couleur et position du boid, pour l'éclairage
+    frag_Color = uColor;
+    frag_BoidPosition = boidPosition;
+
     // Compute final vertex position in clip space
     gl_Position = uMVPMatrix * uModelMatrix * vec4(in_Position, 1.0);
 }
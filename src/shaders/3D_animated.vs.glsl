@@ -0,0 +1,76 @@
+#version 330 core
+
+// Animation par sommets : positions et normales lues dans la texture d'animation
+// (voir VertexAnimation) et interpolées entre la frame k et la frame k + 1
+layout(location = 2) in vec2 in_TexCoord;
+layout(location = 3) in uint in_AnimationSlot; // Emplacement du sommet dans la texture
+
+out vec3 frag_Normal;
+out vec3 frag_Position;
+out vec2 frag_TexCoord;
+out vec3 frag_Color;
+out vec3 frag_BoidPosition;
+
+// Données de caméra communes, mises à jour une fois par frame (voir CameraUniforms)
+layout(std140) uniform Camera {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+    vec4 uSurveyorPosition; // Position de l'arpenteur (xyz)
+};
+uniform mat4 uModelMatrix;
+uniform vec3 uColor; // Couleur de l'objet
+uniform vec3 boidPosition; // Position du boid
+
+uniform usamplerBuffer uAnimationTexels; // x, y, z quantifiés puis normale octaédrique
+uniform int uFrameCount;
+uniform int uStaticCount; // Sommets immobiles, rangés une seule fois en tête de texture
+uniform int uMovingCount; // Sommets animés, rangés frame par frame ensuite
+uniform vec3 uBoundsMin; // Boîte englobante de l'animation, pour déquantifier les positions
+uniform vec3 uBoundsExtent;
+uniform float uElapsedTime;
+uniform float uAnimationDuration;
+
+int texelIndex(int slot, int frame) {
+    return slot < uStaticCount ? slot : uStaticCount + frame * uMovingCount + (slot - uStaticCount);
+}
+
+vec3 decodeNormal(uint packed) {
+    vec2 e = vec2(float(packed >> 8u), float(packed & 255u)) / 127.5 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    // Frame courante et suivante d'après le temps écoulé
+    float time = fract(uElapsedTime / uAnimationDuration) * float(uFrameCount);
+    int frame = min(int(time), uFrameCount - 1);
+    int nextFrame = (frame + 1) % uFrameCount;
+    float blend = time - float(frame);
+
+    int slot = int(in_AnimationSlot);
+    uvec4 texel = texelFetch(uAnimationTexels, texelIndex(slot, frame));
+    uvec4 nextTexel = texelFetch(uAnimationTexels, texelIndex(slot, nextFrame));
+
+    vec3 position = uBoundsMin + mix(vec3(texel.xyz), vec3(nextTexel.xyz), blend) / 65535.0 * uBoundsExtent;
+    vec3 normal = normalize(mix(decodeNormal(texel.w), decodeNormal(nextTexel.w), blend));
+
+    // Compute transformed normal
+    frag_Normal = mat3(uNormalMatrix) * normal;
+
+    // Compute transformed position
+    frag_Position = vec3(uMVMatrix * vec4(position, 1.0));
+
+    // Pass texture coordinates to fragment shader
+    frag_TexCoord = in_TexCoord;
+
+    // Couleur et position du boid, pour l'éclairage
+    frag_Color = uColor;
+    frag_BoidPosition = boidPosition;
+
+    // Compute final vertex position in clip space
+    gl_Position = uMVPMatrix * uModelMatrix * vec4(position, 1.0);
+}
@@ -0,0 +1,42 @@
+#version 330 core
+
+layout(location = 0) in vec3 in_Position;
+layout(location = 1) in vec3 in_Normal;
+layout(location = 2) in vec2 in_TexCoord;
+
+// Attributs par instance (voir instance_buffer.h)
+layout(location = 3) in mat4 in_ModelMatrix;
+layout(location = 7) in mat3 in_NormalMatrix;
+layout(location = 10) in vec3 in_Color;
+
+out vec3 frag_Normal;
+out vec3 frag_Position;
+out vec2 frag_TexCoord;
+out vec3 frag_Color;
+out vec3 frag_BoidPosition;
+
+// Données de caméra communes, mises à jour une fois par frame (voir CameraUniforms)
+layout(std140) uniform Camera {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+    vec4 uSurveyorPosition; // Position de l'arpenteur (xyz)
+};
+
+void main() {
+    // Compute transformed normal
+    frag_Normal = mat3(uNormalMatrix) * in_NormalMatrix * in_Normal;
+
+    // Compute transformed position
+    frag_Position = vec3(uMVMatrix * in_ModelMatrix * vec4(in_Position, 1.0));
+
+    // Pass texture coordinates to fragment shader
+    frag_TexCoord = in_TexCoord;
+
+    // Couleur et position de l'instance, pour l'éclairage
+    frag_Color = in_Color;
+    frag_BoidPosition = in_ModelMatrix[3].xyz;
+
+    // Compute final vertex position in clip space
+    gl_Position = uMVPMatrix * in_ModelMatrix * vec4(in_Position, 1.0);
+}
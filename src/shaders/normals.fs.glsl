@@ -3,13 +3,19 @@
 in vec3 frag_Normal;
 in vec3 frag_Position;
 in vec2 frag_TexCoord;
+in vec3 frag_Color; // Couleur de l'objet
+in vec3 frag_BoidPosition; // Position du boid
 
 out vec4 out_Color;
 
-uniform vec3 uColor; // Couleur de l'objet
 uniform vec4 uDomeColor; // Couleur du dome avec alpha
-uniform vec3 surveyorPosition; // Position de l'arpenteur
-uniform vec3 boidPosition; // Position de l'arpenteur
+// Données de caméra communes, mises à jour une fois par frame (voir CameraUniforms)
+layout(std140) uniform Camera {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+    vec4 uSurveyorPosition; // Position de l'arpenteur (xyz)
+};
 
 void main() {
     vec3 lightColor1 = vec3(0.0, 0.0, 1.0); // Couleur de la première lumière
@@ -19,10 +25,10 @@ void main() {
 
     vec3 lightPos1 = vec3(5.0, 0.0, 0.0); // Position de la première lumière (fixe)
     vec3 lightPos2 = vec3(0.0, -5.0, 0.0); // Position de la deuxième lumière (fixe)
-    vec3 lightPosSurveyor = surveyorPosition; // Position de la lumière sur l'arpenteur
-    vec3 lightPosBoid = boidPosition; // Position de la lumière sur le boid
+    vec3 lightPosSurveyor = uSurveyorPosition.xyz; // Position de la lumière sur l'arpenteur
+    vec3 lightPosBoid = frag_BoidPosition; // Position de la lumière sur le boid
 
-    vec3 objectColor = uColor; // Utilisation de la couleur définie par la variable uniforme
+    vec3 objectColor = frag_Color; // Couleur transmise par le vertex shader
 
     // Calcul de la lumière diffuse pour la première lumière
     vec3 normal = normalize(frag_Normal);
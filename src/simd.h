@@ -0,0 +1,10 @@
+#pragma once
+
+// Détection de SSE2 à la compilation, commune à tous les chemins vectoriels. SIMD_HAS_SSE2
+// vaut toujours 0 ou 1 : à tester avec #if, chaque chemin SSE2 garde son repli scalaire.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_HAS_SSE2 1
+#include <emmintrin.h>
+#else
+#define SIMD_HAS_SSE2 0
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include "flock_simulator.h"
+
+// Entrées envoyées par le rendu à la simulation (dernière valeur connue)
+struct SimulationInputs {
+    FlockParams params;
+    int         numBoids   = 0;
+    float       speedBoids = 0.0f;
+};
+
+// Amène le troupeau à inputs.numBoids boids, répartis entre les espèces selon leur part
+// (la dernière espèce reçoit le reste des arrondis) : n'ajoute que les boids manquants
+// (tirés par FlockSimulator::randomBoid, donc reproductibles), ou retire les derniers de
+// chaque espèce
+inline void resizeFlock(FlockSimulator& simulator, const SimulationInputs& inputs)
+{
+    const auto          total   = static_cast<std::size_t>(std::max(0, inputs.numBoids));
+    const SpeciesTable& species = simulator.species();
+    float               shares  = 0.0f;
+    for (std::size_t s = 0; s < species.size(); ++s) {
+        shares += std::max(0.0f, species[s].share);
+    }
+    std::size_t assigned = 0;
+    for (std::size_t s = 0; s < species.size(); ++s) {
+        std::size_t target = total - assigned;
+        if (s + 1 < species.size()) {
+            float share = shares > 0.0f ? std::max(0.0f, species[s].share) / shares : 0.0f;
+            target      = std::min(target, static_cast<std::size_t>(static_cast<float>(total) * share));
+        }
+        assigned += target;
+
+        const BoidPool& flock = simulator.flock();
+        while (flock.speciesEnd(s) - flock.speciesBegin(s) < target) {
+            simulator.spawn(simulator.randomBoid(inputs.speedBoids, s));
+        }
+        while (flock.speciesEnd(s) - flock.speciesBegin(s) > target) {
+            simulator.kill(flock.handleAt(flock.speciesEnd(s) - 1));
+        }
+    }
+}
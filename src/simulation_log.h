@@ -0,0 +1,420 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "boid_soa.h"
+#include "flock_simulator.h"
+#include "hash.h"
+#include "mapped_file.h"
+#include "simulation_inputs.h"
+#include "species.h"
+#include "steering.h"
+
+// Journal binaire d'une partie, pour la rejouer à l'identique sans fenêtre : la graine,
+// puis pour chaque pas les entrées qui ont changé depuis le pas précédent et la durée du
+// pas, et de temps en temps une empreinte de l'état du troupeau. Le rejeu refait les
+// mêmes pas et compare les empreintes : une optimisation qui change le résultat est
+// repérée au premier pas vérifié qui diffère.
+// Les touches ne sont pas enregistrées telles quelles : la simulation n'en voit que
+// l'effet, les positions de la caméra et de l'arpenteur dans FlockParams.
+// La table des espèces est fixée pour toute la partie : elle est écrite dans l'en-tête.
+struct SimulationLogHeader {
+    static constexpr char          MAGIC[8]       = {'F', 'L', 'O', 'C', 'K', 'L', 'O', 'G'};
+    static constexpr std::uint32_t VERSION        = 4;
+    static constexpr std::size_t   SPECIES_FIELDS = 8;
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t checksumInterval; // Pas entre deux empreintes
+    std::uint64_t seed;
+    char          kernels[16]; // Noyaux de pilotage utilisés : le rejeu n'est exact qu'avec les mêmes
+    std::uint32_t speciesCount;
+    float         species[SpeciesTable::MAX_SPECIES][SPECIES_FIELDS]; // Champs de SpeciesParams, dans l'ordre de déclaration
+    float         interactions[SpeciesTable::MAX_SPECIES * SpeciesTable::MAX_SPECIES]; // Ligne par espèce, speciesCount colonnes
+};
+
+// Chaque enregistrement commence par son type, sur un octet :
+//   Inputs   : masque des champs modifiés (32 bits) puis leurs valeurs, un mot par champ
+//   Step     : durée du pas (float)
+//   Checksum : numéro du pas atteint puis empreinte de l'état (64 bits chacun)
+enum class SimulationRecordKind : std::uint8_t { Inputs = 1, Step = 2, Checksum = 3 };
+
+namespace detail {
+
+// Appelle fn sur chaque champ de inputs, dans l'ordre du journal. Les champs sont écrits
+// un par un, sans les octets de remplissage des structures.
+template<typename Inputs, typename Fn>
+void forEachInputField(Inputs& inputs, Fn&& fn)
+{
+    static_assert(sizeof(FlockParams) == 18 * sizeof(float), "Champ ajouté à FlockParams : l'ajouter ici et changer SimulationLogHeader::VERSION");
+    auto& params = inputs.params;
+    fn(params.separationDistance);
+    fn(params.interactionRadius);
+    fn(params.alignmentWeight);
+    fn(params.cohesionWeight);
+    fn(params.distanceMinToCamera);
+    fn(params.avoidanceWeight);
+    fn(params.domeRadius);
+    fn(params.markovRadius);
+    fn(params.markovThreshold);
+    fn(params.meanLifespan);
+    fn(params.autoMode);
+    fn(params.dayNightInterval);
+    for (int axis = 0; axis < 3; ++axis) {
+        fn(params.cameraPosition[axis]);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        fn(params.surveyorPosition[axis]);
+    }
+    fn(inputs.numBoids);
+    fn(inputs.speedBoids);
+}
+
+constexpr std::size_t INPUT_FIELDS = 20;
+using InputWords                   = std::array<std::uint32_t, INPUT_FIELDS>;
+
+inline InputWords toInputWords(const SimulationInputs& inputs)
+{
+    InputWords  words{};
+    std::size_t field = 0;
+    forEachInputField(inputs, [&](const auto& value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, bool>) {
+            words[field++] = value ? 1 : 0;
+        } else {
+            static_assert(sizeof(value) == sizeof(std::uint32_t));
+            std::memcpy(&words[field++], &value, sizeof(value));
+        }
+    });
+    return words;
+}
+
+inline SimulationInputs fromInputWords(const InputWords& words)
+{
+    SimulationInputs inputs;
+    std::size_t      field = 0;
+    forEachInputField(inputs, [&](auto& value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, bool>) {
+            value = words[field++] != 0;
+        } else {
+            std::memcpy(&value, &words[field++], sizeof(value));
+        }
+    });
+    return inputs;
+}
+
+inline void writeSpecies(const SpeciesTable& table, SimulationLogHeader& header)
+{
+    static_assert(sizeof(SpeciesParams) == SimulationLogHeader::SPECIES_FIELDS * sizeof(float),
+                  "Champ ajouté à SpeciesParams : l'ajouter ici et changer SimulationLogHeader::VERSION");
+    header.speciesCount = static_cast<std::uint32_t>(table.size());
+    for (std::size_t s = 0; s < table.size(); ++s) {
+        const SpeciesParams& species = table[s];
+        const float          fields[] = {species.interactionRadius, species.separationWeight, species.alignmentWeight, species.cohesionWeight, species.share,
+                                         species.color.r,           species.color.g,          species.color.b};
+        std::memcpy(header.species[s], fields, sizeof(fields));
+        for (std::size_t other = 0; other < table.size(); ++other) {
+            header.interactions[s * table.size() + other] = table.interaction(s, other);
+        }
+    }
+}
+
+inline SpeciesTable readSpecies(const SimulationLogHeader& header)
+{
+    std::vector<SpeciesParams> params(header.speciesCount);
+    for (std::size_t s = 0; s < params.size(); ++s) {
+        const float* fields         = header.species[s];
+        params[s].interactionRadius = fields[0];
+        params[s].separationWeight  = fields[1];
+        params[s].alignmentWeight   = fields[2];
+        params[s].cohesionWeight    = fields[3];
+        params[s].share             = fields[4];
+        params[s].color             = glm::vec3(fields[5], fields[6], fields[7]);
+    }
+    SpeciesTable table(std::move(params));
+    for (std::size_t s = 0; s < table.size(); ++s) {
+        for (std::size_t other = 0; other < table.size(); ++other) {
+            table.setInteraction(s, other, header.interactions[s * table.size() + other]);
+        }
+    }
+    return table;
+}
+
+} // namespace detail
+
+// Empreinte de l'état simulé : horloge, positions, vitesses, espèce et données de la
+// chaîne de Markov et du cycle de vie de chaque boid
+inline std::uint64_t stateChecksum(const FlockSimulator& simulator)
+{
+    const BoidSoA& boids = simulator.boids();
+    double         time  = simulator.time();
+    std::uint64_t  hash  = hashArray(&time, 1);
+    for (const auto* array : {&boids.px, &boids.py, &boids.pz, &boids.vx, &boids.vy, &boids.vz, &boids.lifespan}) {
+        hash = hashArray(array->data(), array->size(), hash);
+    }
+    hash = hashArray(boids.markovTime.data(), boids.markovTime.size(), hash);
+    hash = hashArray(boids.markovState.data(), boids.markovState.size(), hash);
+    hash = hashArray(boids.species.data(), boids.species.size(), hash);
+    return hashArray(boids.isFemale.data(), boids.isFemale.size(), hash);
+}
+
+// Écrit le journal d'une partie, depuis le thread de simulation
+class SimulationRecorder {
+public:
+    SimulationRecorder() = default;
+    ~SimulationRecorder() { close(); }
+
+    SimulationRecorder(const SimulationRecorder&)            = delete;
+    SimulationRecorder& operator=(const SimulationRecorder&) = delete;
+
+    // simulator ne doit encore avoir fait aucun pas : sa graine et ses espèces sont
+    // celles de toute la partie
+    bool open(const std::string& path, const FlockSimulator& simulator, std::uint32_t checksumInterval = 60)
+    {
+        close();
+        m_file = std::fopen(path.c_str(), "wb");
+        if (m_file == nullptr) {
+            return false;
+        }
+        SimulationLogHeader header{};
+        std::memcpy(header.magic, SimulationLogHeader::MAGIC, sizeof(header.magic));
+        header.version          = SimulationLogHeader::VERSION;
+        header.checksumInterval = std::max(1u, checksumInterval);
+        header.seed             = simulator.seed();
+        std::strncpy(header.kernels, steeringKernels().name, sizeof(header.kernels) - 1);
+        detail::writeSpecies(simulator.species(), header);
+
+        m_checksumInterval = header.checksumInterval;
+        m_failed           = false;
+        m_hasInputs        = false;
+        m_bytes            = 0;
+        write(&header, sizeof(header));
+        return !m_failed;
+    }
+
+    bool isOpen() const { return m_file != nullptr; }
+
+    // Avant chaque pas : les entrées appliquées (seuls les champs modifiés sont écrits) et dt
+    void recordStep(const SimulationInputs& inputs, float dt)
+    {
+        if (m_file == nullptr) {
+            return;
+        }
+        detail::InputWords words = detail::toInputWords(inputs);
+        std::uint32_t      mask  = 0;
+        for (std::size_t field = 0; field < detail::INPUT_FIELDS; ++field) {
+            if (!m_hasInputs || words[field] != m_inputs[field]) {
+                mask |= 1u << field;
+            }
+        }
+        if (mask != 0) {
+            writeKind(SimulationRecordKind::Inputs);
+            write(&mask, sizeof(mask));
+            for (std::size_t field = 0; field < detail::INPUT_FIELDS; ++field) {
+                if (mask & (1u << field)) {
+                    write(&words[field], sizeof(words[field]));
+                }
+            }
+            m_inputs    = words;
+            m_hasInputs = true;
+        }
+        writeKind(SimulationRecordKind::Step);
+        write(&dt, sizeof(dt));
+    }
+
+    // Après chaque pas : l'empreinte de l'état, tous les checksumInterval pas
+    void recordState(const FlockSimulator& simulator)
+    {
+        if (m_file == nullptr || simulator.steps() % m_checksumInterval != 0) {
+            return;
+        }
+        std::uint64_t step     = simulator.steps();
+        std::uint64_t checksum = stateChecksum(simulator);
+        writeKind(SimulationRecordKind::Checksum);
+        write(&step, sizeof(step));
+        write(&checksum, sizeof(checksum));
+    }
+
+    // Renvoie false si une écriture a échoué
+    bool close()
+    {
+        if (m_file == nullptr) {
+            return !m_failed;
+        }
+        m_failed = (std::fclose(m_file) != 0) || m_failed;
+        m_file   = nullptr;
+        return !m_failed;
+    }
+
+    std::uint64_t bytesWritten() const { return m_bytes; }
+
+private:
+    void writeKind(SimulationRecordKind kind) { write(&kind, sizeof(kind)); }
+
+    void write(const void* data, std::size_t size)
+    {
+        if (std::fwrite(data, 1, size, m_file) != size) {
+            m_failed = true;
+        }
+        m_bytes += size;
+    }
+
+    std::FILE*         m_file             = nullptr;
+    bool               m_failed           = false;
+    std::uint32_t      m_checksumInterval = 60;
+    std::uint64_t      m_bytes            = 0;
+    bool               m_hasInputs        = false;
+    detail::InputWords m_inputs{}; // Dernières entrées écrites
+};
+
+// Lit un journal projeté en mémoire, enregistrement par enregistrement
+class SimulationLogReader {
+public:
+    struct Record {
+        SimulationRecordKind kind;
+        float                dt       = 0.0f; // Step
+        std::uint64_t        step     = 0;    // Checksum
+        std::uint64_t        checksum = 0;
+    };
+
+    // Renvoie false si le fichier est absent, tronqué ou d'une autre version
+    bool open(const char* path)
+    {
+        m_offset    = 0;
+        m_truncated = false;
+        m_words     = {};
+        if (!m_file.open(path) || m_file.size() < sizeof(SimulationLogHeader)) {
+            return false;
+        }
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, SimulationLogHeader::MAGIC, sizeof(m_header.magic)) != 0
+            || m_header.version != SimulationLogHeader::VERSION || m_header.speciesCount == 0 || m_header.speciesCount > SpeciesTable::MAX_SPECIES) {
+            m_file.close();
+            return false;
+        }
+        m_header.kernels[sizeof(m_header.kernels) - 1] = '\0';
+        m_offset                                        = sizeof(SimulationLogHeader);
+        return true;
+    }
+
+    const SimulationLogHeader& header() const { return m_header; }
+
+    SpeciesTable species() const { return detail::readSpecies(m_header); }
+
+    // Entrées en vigueur après le dernier enregistrement lu
+    SimulationInputs inputs() const { return detail::fromInputWords(m_words); }
+
+    // Enregistrement suivant. Renvoie false à la fin du journal, ou s'il s'arrête au
+    // milieu d'un enregistrement (truncated() le signale alors).
+    bool next(Record& record)
+    {
+        if (m_offset >= m_file.size()) {
+            return false;
+        }
+        std::uint8_t kind;
+        if (!read(&kind, sizeof(kind))) {
+            return false;
+        }
+        record.kind = static_cast<SimulationRecordKind>(kind);
+        switch (record.kind) {
+        case SimulationRecordKind::Inputs: {
+            std::uint32_t mask;
+            if (!read(&mask, sizeof(mask))) {
+                return false;
+            }
+            for (std::size_t field = 0; field < detail::INPUT_FIELDS; ++field) {
+                if ((mask & (1u << field)) && !read(&m_words[field], sizeof(m_words[field]))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case SimulationRecordKind::Step:
+            return read(&record.dt, sizeof(record.dt));
+        case SimulationRecordKind::Checksum:
+            return read(&record.step, sizeof(record.step)) && read(&record.checksum, sizeof(record.checksum));
+        }
+        m_truncated = true; // Type inconnu : la suite est illisible
+        return false;
+    }
+
+    bool truncated() const { return m_truncated; }
+
+private:
+    bool read(void* data, std::size_t size)
+    {
+        if (size > m_file.size() - m_offset) {
+            m_truncated = true;
+            return false;
+        }
+        std::memcpy(data, m_file.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    MappedFile          m_file;
+    SimulationLogHeader m_header{};
+    std::size_t         m_offset    = 0;
+    bool                m_truncated = false;
+    detail::InputWords  m_words{};
+};
+
+struct ReplayResult {
+    static constexpr std::uint64_t NO_DIVERGENCE = std::numeric_limits<std::uint64_t>::max();
+
+    std::uint64_t steps           = 0;
+    std::uint64_t checksums       = 0; // Empreintes comparées
+    std::uint64_t mismatches      = 0;
+    std::uint64_t firstDivergence = NO_DIVERGENCE; // Pas de la première empreinte différente
+    double        seconds         = 0.0;
+    bool          truncated       = false;
+
+    bool ok() const { return mismatches == 0 && !truncated; }
+};
+
+// Rejoue le journal aussi vite que possible sur simulator, qui doit être neuf (aucun
+// boid, aucun pas). Le rejeu va jusqu'au bout même après une divergence, pour que la
+// durée mesurée couvre toujours la même charge.
+inline ReplayResult replaySimulation(SimulationLogReader& reader, FlockSimulator& simulator)
+{
+    ReplayResult result;
+    simulator.setSeed(reader.header().seed);
+    simulator.setSpecies(reader.species());
+    auto start = std::chrono::steady_clock::now();
+
+    SimulationInputs            inputs;
+    SimulationLogReader::Record record;
+    while (reader.next(record)) {
+        switch (record.kind) {
+        case SimulationRecordKind::Inputs:
+            inputs = reader.inputs();
+            break;
+        case SimulationRecordKind::Step:
+            // Même ordre que SimulationThread::step
+            simulator.params() = inputs.params;
+            resizeFlock(simulator, inputs);
+            simulator.step(record.dt);
+            ++result.steps;
+            break;
+        case SimulationRecordKind::Checksum:
+            ++result.checksums;
+            if (record.step != simulator.steps() || record.checksum != stateChecksum(simulator)) {
+                if (result.mismatches++ == 0) {
+                    result.firstDivergence = record.step;
+                }
+            }
+            break;
+        }
+    }
+    result.seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.truncated = reader.truncated();
+    return result;
+}
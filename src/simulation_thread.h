@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "boid_soa.h"
+#include "flock_simulator.h"
+#include "profiler.h"
+#include "simulation_inputs.h"
+#include "simulation_log.h"
+#include "snapshot_file.h"
+#include "triple_buffer.h"
+
+// Ce dont le rendu a besoin pour dessiner les boids : les positions des deux derniers
+// pas, pour interpoler entre eux, et les données de couleur
+struct BoidSnapshot {
+    std::vector<float>        px, py, pz;                         // Positions après le pas `step`
+    std::vector<float>        previousPx, previousPy, previousPz; // Positions avant ce pas
+    std::vector<int>          markovState;
+    std::vector<std::uint8_t> isFemale;
+    std::vector<std::size_t>  speciesStart; // Les boids de l'espèce s occupent [speciesStart[s], speciesStart[s + 1])
+
+    std::uint64_t step         = 0;
+    double        stepTime     = 0.0; // Instant (horloge de SimulationThread::now) où l'état `step` est atteint
+    float         stepDuration = 0.0f;
+
+    // État jour/nuit tiré par le mode automatique, et nombre de tirages depuis le début :
+    // le rendu n'applique switchState que lorsque le compteur change
+    bool          switchState  = true;
+    std::uint64_t switchEvents = 0;
+
+    std::size_t size() const { return px.size(); }
+
+    // Position à afficher pour le boid i, alpha allant de 0 (pas précédent) à 1 (dernier pas)
+    glm::vec3 interpolatedPosition(std::size_t i, float alpha) const
+    {
+        return glm::mix(glm::vec3(previousPx[i], previousPy[i], previousPz[i]), glm::vec3(px[i], py[i], pz[i]), alpha);
+    }
+
+    // Avancement entre les deux pas pour un affichage à l'instant renderTime. Le rendu a
+    // un pas de retard sur la simulation, ce qui lui laisse toujours deux états encadrants.
+    float interpolationFactor(double renderTime) const
+    {
+        if (stepDuration <= 0.0f) {
+            return 1.0f;
+        }
+        return std::clamp(static_cast<float>((renderTime - stepTime) / stepDuration), 0.0f, 1.0f);
+    }
+};
+
+// Fait tourner un FlockSimulator à pas fixe sur son propre thread. Le temps réel écoulé
+// est accumulé et consommé par pas de 1 / stepRate secondes ; chaque pas publie un
+// BoidSnapshot dans un triple tampon, que le rendu lit sans jamais bloquer la simulation.
+// Si la simulation prend du retard, au plus maxCatchUpSteps pas sont enchaînés par tour
+// de boucle et le temps restant est abandonné, plutôt que de s'enfoncer dans le retard.
+class SimulationThread {
+public:
+    // Appelée sur le thread de simulation avant chaque pas, une fois les paramètres
+    // appliqués, pour ajuster le nombre de boids (FlockSimulator::spawn et kill). Le rejeu
+    // d'un journal utilise resizeFlock : un enregistrement doit s'en tenir à celle-ci.
+    using ResizeFn = std::function<void(FlockSimulator& simulator, const SimulationInputs& inputs)>;
+
+    explicit SimulationThread(FlockSimulator& simulator, ResizeFn resize = resizeFlock)
+        : m_simulator(simulator), m_resizeFlock(std::move(resize))
+    {}
+
+    ~SimulationThread() { stop(); }
+
+    SimulationThread(const SimulationThread&)            = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Les premières entrées doivent avoir été transmises par setInputs
+    void start()
+    {
+        if (m_thread.joinable()) {
+            return;
+        }
+        m_stop = false;
+        m_thread = std::thread([this] { run(); });
+    }
+
+    void stop()
+    {
+        m_stop = true;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    // Horloge commune à la simulation et au rendu, en secondes
+    double now() const { return std::chrono::duration<double>(Clock::now() - m_epoch).count(); }
+
+    // Journal de la partie (voir simulation_log.h), ouvert avant start() et fermé après stop()
+    void setRecorder(SimulationRecorder* recorder) { m_recorder = recorder; }
+
+    // Export de l'état après chaque pas (voir snapshot_file.h), mêmes règles que le journal
+    void setSnapshotWriter(SnapshotWriter* writer) { m_snapshotWriter = writer; }
+
+    // Pas de simulation par seconde et nombre maximal de pas de rattrapage par tour
+    void  setStepRate(float stepsPerSecond) { m_stepRate = std::max(1.0f, stepsPerSecond); }
+    float stepRate() const { return m_stepRate; }
+    void  setMaxCatchUpSteps(int steps) { m_maxCatchUpSteps = std::max(1, steps); }
+
+    // Côté rendu : transmettre les derniers réglages et lire le dernier état publié
+    void setInputs(const SimulationInputs& inputs)
+    {
+        m_inputs.writeBuffer() = inputs;
+        m_inputs.publish();
+    }
+    const BoidSnapshot& latestSnapshot() { return m_snapshots.read(); }
+
+    // Statistiques pour l'interface
+    std::uint64_t droppedSteps() const { return m_droppedSteps; }
+    float         lastStepMilliseconds() const { return m_lastStepMilliseconds; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run()
+    {
+        profiler().setThreadName("Simulation");
+
+        // Publier l'état initial pour que le rendu ait quelque chose à afficher
+        publishSnapshot(0.0f, 0.0);
+
+        double simulatedTime = now();
+        while (!m_stop) {
+            const double stepDuration = 1.0 / m_stepRate;
+            int          steps        = 0;
+            while (simulatedTime + stepDuration <= now() && steps < m_maxCatchUpSteps && !m_stop) {
+                step(m_inputs.read(), static_cast<float>(stepDuration), simulatedTime + stepDuration);
+                simulatedTime += stepDuration;
+                ++steps;
+            }
+
+            // Retard trop important : abandonner les pas en excès (la simulation ralentit
+            // au lieu d'accumuler une dette qu'elle ne pourrait jamais rembourser)
+            double late = now() - simulatedTime;
+            if (late > stepDuration) {
+                auto dropped = static_cast<std::uint64_t>(late / stepDuration);
+                m_droppedSteps += dropped;
+                simulatedTime += static_cast<double>(dropped) * stepDuration;
+            }
+
+            // Attendre l'échéance du prochain pas
+            std::this_thread::sleep_until(m_epoch + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(simulatedTime + stepDuration)));
+        }
+    }
+
+    void step(const SimulationInputs& inputs, float dt, double stepTime)
+    {
+        PROFILE_SCOPE("Simulation step");
+        auto begin = Clock::now();
+
+        if (m_recorder != nullptr) {
+            m_recorder->recordStep(inputs, dt);
+        }
+        m_simulator.params() = inputs.params;
+        m_resizeFlock(m_simulator, inputs);
+        const BoidSoA& boids = m_simulator.boids();
+
+        // Positions avant le pas, pour l'interpolation côté rendu
+        BoidSnapshot& snapshot = m_snapshots.writeBuffer();
+        snapshot.previousPx.assign(boids.px.begin(), boids.px.end());
+        snapshot.previousPy.assign(boids.py.begin(), boids.py.end());
+        snapshot.previousPz.assign(boids.pz.begin(), boids.pz.end());
+
+        if (std::optional<bool> newSwitchState = m_simulator.step(dt)) {
+            m_switchState = *newSwitchState;
+            ++m_switchEvents;
+        }
+        m_lastStepMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+        if (m_recorder != nullptr) {
+            m_recorder->recordState(m_simulator);
+        }
+        if (m_snapshotWriter != nullptr) {
+            // Le tampon d'écriture du simulateur garde l'état d'avant ce pas : il est
+            // échangé, pas copié, et l'export a donc un pas de retard
+            m_snapshotWriter->submit(m_simulator.steps() - 1, m_simulator.previousState());
+        }
+
+        publishSnapshot(dt, stepTime);
+    }
+
+    // Copie l'état courant dans le tampon d'écriture puis le publie. Les positions
+    // précédentes doivent déjà y être (sinon elles sont prises égales aux courantes).
+    void publishSnapshot(float dt, double stepTime)
+    {
+        const BoidSoA& boids    = m_simulator.boids();
+        BoidSnapshot&  snapshot = m_snapshots.writeBuffer();
+
+        snapshot.px.assign(boids.px.begin(), boids.px.end());
+        snapshot.py.assign(boids.py.begin(), boids.py.end());
+        snapshot.pz.assign(boids.pz.begin(), boids.pz.end());
+        if (snapshot.previousPx.size() != boids.size()) {
+            snapshot.previousPx = snapshot.px;
+            snapshot.previousPy = snapshot.py;
+            snapshot.previousPz = snapshot.pz;
+        }
+        snapshot.markovState.assign(boids.markovState.begin(), boids.markovState.end());
+        snapshot.isFemale.assign(boids.isFemale.begin(), boids.isFemale.end());
+        snapshot.speciesStart.resize(m_simulator.flock().speciesCount() + 1);
+        for (std::size_t species = 0; species < snapshot.speciesStart.size(); ++species) {
+            snapshot.speciesStart[species] = m_simulator.flock().speciesBegin(species);
+        }
+
+        snapshot.step         = m_stepCount++;
+        snapshot.stepTime     = stepTime;
+        snapshot.stepDuration = dt;
+        snapshot.switchState  = m_switchState;
+        snapshot.switchEvents = m_switchEvents;
+        m_snapshots.publish();
+    }
+
+    FlockSimulator&     m_simulator;
+    ResizeFn            m_resizeFlock;
+    SimulationRecorder* m_recorder       = nullptr;
+    SnapshotWriter*     m_snapshotWriter = nullptr;
+    std::thread         m_thread;
+    Clock::time_point   m_epoch = Clock::now();
+
+    TripleBuffer<SimulationInputs> m_inputs;
+    TripleBuffer<BoidSnapshot>     m_snapshots;
+
+    std::atomic<bool>          m_stop{false};
+    std::atomic<float>         m_stepRate{60.0f};
+    std::atomic<int>           m_maxCatchUpSteps{4};
+    std::atomic<std::uint64_t> m_droppedSteps{0};
+    std::atomic<float>         m_lastStepMilliseconds{0.0f};
+
+    // Utilisés uniquement par le thread de simulation
+    std::uint64_t m_stepCount    = 0;
+    std::uint64_t m_switchEvents = 0;
+    bool          m_switchState  = true;
+};
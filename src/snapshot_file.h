@@ -0,0 +1,634 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "boid_soa.h"
+#include "lz_block.h"
+#include "mapped_file.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+// Export de l'état du troupeau, pas après pas, pour l'analyser hors de l'application.
+// Le fichier est rangé en colonnes (px, py, ..., markovState) découpées en blocs de
+// BLOCK_VALUES valeurs. Dans chaque bloc, une frame qui n'est pas une image clé est
+// remplacée par son XOR avec la frame précédente du fichier, puis les octets sont
+// regroupés par rang (tous les octets de poids fort, puis les suivants...) : d'un pas à
+// l'autre, les octets de poids fort ne changent presque pas et le XOR donne de longues
+// suites de zéros, que la compression LZ (lz_block.h) réduit à presque rien.
+// Un index des frames termine le fichier : un lecteur va directement au pas voulu, en
+// repartant de l'image clé précédente (au plus keyframeInterval - 1 frames à décoder).
+enum class SnapshotColumn : std::uint32_t { PositionX, PositionY, PositionZ, VelocityX, VelocityY, VelocityZ, MarkovState, IsFemale };
+
+struct SnapshotColumnInfo {
+    const char*   name;
+    std::uint32_t elementSize;
+};
+
+inline constexpr SnapshotColumnInfo SNAPSHOT_COLUMNS[] = {
+    {"px", 4}, {"py", 4}, {"pz", 4}, {"vx", 4}, {"vy", 4}, {"vz", 4}, {"markovState", 4}, {"isFemale", 1},
+};
+constexpr std::size_t SNAPSHOT_COLUMN_COUNT = std::size(SNAPSHOT_COLUMNS);
+
+struct SnapshotFileHeader {
+    static constexpr char          MAGIC[8]     = {'F', 'L', 'O', 'C', 'K', 'S', 'N', 'P'};
+    static constexpr std::uint32_t VERSION      = 1;
+    static constexpr std::uint32_t BLOCK_VALUES = 16384; // Un bloc de floats occupe 64 Kio, la taille maximale d'un bloc LZ
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t columnCount;
+    std::uint32_t blockValues;
+    std::uint32_t keyframeInterval;
+};
+
+struct SnapshotFrameHeader {
+    std::uint64_t step;
+    std::uint32_t boidCount;
+    std::uint32_t keyframe;     // 0 : XOR avec la frame précédente du fichier
+    std::uint64_t payloadBytes; // Blocs qui suivent, colonne par colonne
+};
+
+// Chaque bloc est précédé de sa taille sur 32 bits ; le bit de poids fort indique un
+// bloc stocké sans compression (données incompressibles ou compression désactivée)
+constexpr std::uint32_t SNAPSHOT_RAW_BLOCK = 0x80000000u;
+
+struct SnapshotIndexEntry {
+    std::uint64_t step;
+    std::uint64_t offset; // Position de l'en-tête de la frame
+};
+
+struct SnapshotFooter {
+    static constexpr char MAGIC[8] = {'F', 'S', 'N', 'P', 'I', 'N', 'D', 'X'};
+
+    std::uint64_t indexOffset;
+    std::uint64_t frameCount;
+    char          magic[8];
+};
+
+// État des boids à un pas, colonne par colonne
+struct SnapshotFrame {
+    std::uint64_t                                                step      = 0;
+    std::uint32_t                                                boidCount = 0;
+    std::array<std::vector<std::uint8_t>, SNAPSHOT_COLUMN_COUNT> columns;
+
+    void resize(std::uint32_t count)
+    {
+        boidCount = count;
+        for (std::size_t c = 0; c < SNAPSHOT_COLUMN_COUNT; ++c) {
+            columns[c].resize(std::size_t{count} * SNAPSHOT_COLUMNS[c].elementSize);
+        }
+    }
+
+    void assign(std::uint64_t stepIndex, const BoidSoA& boids)
+    {
+        step = stepIndex;
+        resize(static_cast<std::uint32_t>(boids.size()));
+        auto copy = [&](SnapshotColumn column, const auto& values) {
+            std::memcpy(columns[static_cast<std::size_t>(column)].data(), values.data(), values.size() * sizeof(values[0]));
+        };
+        copy(SnapshotColumn::PositionX, boids.px);
+        copy(SnapshotColumn::PositionY, boids.py);
+        copy(SnapshotColumn::PositionZ, boids.pz);
+        copy(SnapshotColumn::VelocityX, boids.vx);
+        copy(SnapshotColumn::VelocityY, boids.vy);
+        copy(SnapshotColumn::VelocityZ, boids.vz);
+        copy(SnapshotColumn::MarkovState, boids.markovState);
+        copy(SnapshotColumn::IsFemale, boids.isFemale);
+    }
+
+    // Valeurs d'une colonne (T doit avoir la taille de ses éléments)
+    template<typename T>
+    const T* column(SnapshotColumn column) const
+    {
+        return reinterpret_cast<const T*>(columns[static_cast<std::size_t>(column)].data());
+    }
+};
+
+namespace detail {
+
+// Bloc de values valeurs de ElementSize octets : XOR avec previous (s'il y en a un) puis
+// regroupement des octets par rang dans planes. Chaque valeur est lue d'un coup, en
+// petit-boutiste comme sur toutes les plateformes visées.
+template<typename Word>
+void splitBytePlanes(const std::uint8_t* current, const std::uint8_t* previous, std::size_t values, std::uint8_t* planes)
+{
+    std::size_t i = 0;
+#if SIMD_HAS_SSE2
+    if constexpr (sizeof(Word) == 4) {
+        // 16 valeurs à la fois : octet de rang b isolé dans chaque mot, puis mots resserrés en octets
+        const __m128i low = _mm_set1_epi32(0xFF);
+        for (; i + 16 <= values; i += 16) {
+            __m128i words[4];
+            for (int k = 0; k < 4; ++k) {
+                words[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + (i + 4 * k) * 4));
+                if (previous != nullptr) {
+                    words[k] = _mm_xor_si128(words[k], _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + (i + 4 * k) * 4)));
+                }
+            }
+            for (int b = 0; b < 4; ++b) {
+                __m128i bytes[4];
+                for (int k = 0; k < 4; ++k) {
+                    bytes[k] = _mm_and_si128(_mm_srli_epi32(words[k], 8 * b), low);
+                }
+                __m128i plane = _mm_packus_epi16(_mm_packs_epi32(bytes[0], bytes[1]), _mm_packs_epi32(bytes[2], bytes[3]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(planes + b * values + i), plane);
+            }
+        }
+    }
+#endif
+    for (; i < values; ++i) {
+        Word word, before = 0;
+        std::memcpy(&word, current + i * sizeof(Word), sizeof(Word));
+        if (previous != nullptr) {
+            std::memcpy(&before, previous + i * sizeof(Word), sizeof(Word));
+        }
+        word ^= before;
+        for (std::size_t b = 0; b < sizeof(Word); ++b) {
+            planes[b * values + i] = static_cast<std::uint8_t>(word >> (8 * b));
+        }
+    }
+}
+
+// Inverse de splitBytePlanes : frame contient la frame précédente quand delta est vrai
+template<typename Word>
+void mergeBytePlanes(const std::uint8_t* planes, std::size_t values, bool delta, std::uint8_t* frame)
+{
+    std::size_t i = 0;
+#if SIMD_HAS_SSE2
+    if constexpr (sizeof(Word) == 4) {
+        // Entrelacer les rangs deux à deux (octets puis paires d'octets) redonne les mots
+        for (; i + 16 <= values; i += 16) {
+            __m128i p[4];
+            for (int b = 0; b < 4; ++b) {
+                p[b] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes + b * values + i));
+            }
+            __m128i low01  = _mm_unpacklo_epi8(p[0], p[1]);
+            __m128i high01 = _mm_unpackhi_epi8(p[0], p[1]);
+            __m128i low23  = _mm_unpacklo_epi8(p[2], p[3]);
+            __m128i high23 = _mm_unpackhi_epi8(p[2], p[3]);
+            __m128i words[4] = {_mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23), _mm_unpacklo_epi16(high01, high23),
+                                _mm_unpackhi_epi16(high01, high23)};
+            for (int k = 0; k < 4; ++k) {
+                auto* out = reinterpret_cast<__m128i*>(frame + (i + 4 * k) * 4);
+                _mm_storeu_si128(out, delta ? _mm_xor_si128(words[k], _mm_loadu_si128(out)) : words[k]);
+            }
+        }
+    }
+#endif
+    for (; i < values; ++i) {
+        Word word = 0, before = 0;
+        for (std::size_t b = 0; b < sizeof(Word); ++b) {
+            word |= static_cast<Word>(static_cast<Word>(planes[b * values + i]) << (8 * b));
+        }
+        if (delta) {
+            std::memcpy(&before, frame + i * sizeof(Word), sizeof(Word));
+        }
+        word ^= before;
+        std::memcpy(frame + i * sizeof(Word), &word, sizeof(Word));
+    }
+}
+
+// Les colonnes n'ont que des éléments de 4 ou 1 octets
+inline void splitBytePlanes(const std::uint8_t* current, const std::uint8_t* previous, std::size_t values, std::size_t elementSize, std::uint8_t* planes)
+{
+    elementSize == 4 ? splitBytePlanes<std::uint32_t>(current, previous, values, planes) : splitBytePlanes<std::uint8_t>(current, previous, values, planes);
+}
+
+inline void mergeBytePlanes(const std::uint8_t* planes, std::size_t values, std::size_t elementSize, bool delta, std::uint8_t* frame)
+{
+    elementSize == 4 ? mergeBytePlanes<std::uint32_t>(planes, values, delta, frame) : mergeBytePlanes<std::uint8_t>(planes, values, delta, frame);
+}
+
+} // namespace detail
+
+struct SnapshotOptions {
+    bool          compress         = true;
+    bool          delta            = true; // Sinon chaque frame est une image clé
+    std::uint32_t keyframeInterval = 32;
+    unsigned      encoderThreads   = 4; // Threads qui compressent les blocs, y compris celui de l'écriture
+};
+
+// Écrit les frames sur son propre thread. La simulation échange son tampon de pas contre
+// un tampon libre du thread d'écriture, sans rien copier ; pendant qu'une frame est
+// encodée, un second tampon reçoit la suivante. Si celui-ci est encore occupé, le pas
+// n'est pas exporté plutôt que de faire attendre la simulation.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter() { close(); }
+
+    SnapshotWriter(const SnapshotWriter&)            = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open(const std::string& path, const SnapshotOptions& options = {})
+    {
+        close();
+        m_file = std::fopen(path.c_str(), "wb");
+        if (m_file == nullptr) {
+            return false;
+        }
+        std::setvbuf(m_file, nullptr, _IOFBF, 1 << 20);
+        m_options                  = options;
+        m_options.keyframeInterval = std::max(1u, options.keyframeInterval);
+        m_failed                   = false;
+        m_index.clear();
+        m_offset        = 0;
+        m_rawBytes      = 0;
+        m_submitted     = 0;
+        m_dropped       = 0;
+        m_written       = 0;
+        m_previousValid = false;
+
+        SnapshotFileHeader header{};
+        std::memcpy(header.magic, SnapshotFileHeader::MAGIC, sizeof(header.magic));
+        header.version          = SnapshotFileHeader::VERSION;
+        header.columnCount      = SNAPSHOT_COLUMN_COUNT;
+        header.blockValues      = SnapshotFileHeader::BLOCK_VALUES;
+        header.keyframeInterval = m_options.keyframeInterval;
+        write(&header, sizeof(header));
+
+        m_encoders = std::make_unique<ThreadPool>(std::max(1u, options.encoderThreads));
+        m_state    = IDLE;
+        m_thread   = std::thread([this] { run(); });
+        return !m_failed;
+    }
+
+    bool isOpen() const { return m_file != nullptr; }
+
+    // Thread de simulation : ne bloque jamais et ne copie rien. state est échangé contre
+    // un tampon libre (son contenu est quelconque, de taille quelconque) ; si aucun ne
+    // l'est, state reste intact et la fonction renvoie false.
+    bool submit(std::uint64_t step, BoidStepBuffer& state)
+    {
+        if (m_file == nullptr) {
+            return false;
+        }
+        if (m_state.load(std::memory_order_acquire) != IDLE) {
+            ++m_dropped;
+            return false;
+        }
+        m_pending.swap(state);
+        m_pendingStep = step;
+        ++m_submitted;
+        m_state.store(PENDING, std::memory_order_release);
+        m_state.notify_one();
+        return true;
+    }
+
+    // Attend que toutes les frames soumises soient écrites
+    void flush()
+    {
+        for (std::uint64_t written = m_written.load(); written != m_submitted; written = m_written.load()) {
+            m_written.wait(written);
+        }
+    }
+
+    // Écrit l'index et ferme le fichier. Renvoie false si une écriture a échoué.
+    bool close()
+    {
+        if (m_file == nullptr) {
+            return !m_failed;
+        }
+        flush();
+        m_state.store(STOP, std::memory_order_release);
+        m_state.notify_one();
+        m_thread.join();
+        m_encoders.reset();
+
+        SnapshotFooter footer{};
+        footer.indexOffset = m_offset;
+        footer.frameCount  = m_index.size();
+        std::memcpy(footer.magic, SnapshotFooter::MAGIC, sizeof(footer.magic));
+        write(m_index.data(), m_index.size() * sizeof(SnapshotIndexEntry));
+        write(&footer, sizeof(footer));
+        m_failed = (std::fclose(m_file) != 0) || m_failed;
+        m_file   = nullptr;
+        return !m_failed;
+    }
+
+    // Statistiques (lues après flush ou close pour des valeurs exactes)
+    std::uint64_t writtenFrames() const { return m_written; }
+    std::uint64_t droppedFrames() const { return m_dropped; }
+    std::uint64_t bytesWritten() const { return m_offset; }
+    std::uint64_t rawBytes() const { return m_rawBytes; } // Taille des colonnes non compressées
+
+private:
+    static constexpr std::uint32_t IDLE    = 0; // m_pending est libre
+    static constexpr std::uint32_t PENDING = 1; // m_pending attend le thread d'écriture
+    static constexpr std::uint32_t STOP    = 2;
+
+    void run()
+    {
+        while (true) {
+            m_state.wait(IDLE, std::memory_order_acquire);
+            // Prendre la frame en attente et rendre à la simulation le tampon de la
+            // précédente, déjà encodée : elle peut soumettre la suivante pendant l'encodage
+            m_frame.swap(m_pending);
+            const std::uint64_t step     = m_pendingStep;
+            std::uint32_t       expected = PENDING;
+            if (!m_state.compare_exchange_strong(expected, IDLE, std::memory_order_acq_rel)) {
+                return; // STOP
+            }
+            writeFrame(step, m_frame);
+            m_written.fetch_add(1, std::memory_order_release);
+            m_written.notify_all();
+        }
+    }
+
+    // Octets de la colonne column d'un tampon de pas
+    static const std::uint8_t* columnBytes(const BoidStepBuffer& state, std::size_t column)
+    {
+        switch (static_cast<SnapshotColumn>(column)) {
+        case SnapshotColumn::PositionX: return reinterpret_cast<const std::uint8_t*>(state.px.data());
+        case SnapshotColumn::PositionY: return reinterpret_cast<const std::uint8_t*>(state.py.data());
+        case SnapshotColumn::PositionZ: return reinterpret_cast<const std::uint8_t*>(state.pz.data());
+        case SnapshotColumn::VelocityX: return reinterpret_cast<const std::uint8_t*>(state.vx.data());
+        case SnapshotColumn::VelocityY: return reinterpret_cast<const std::uint8_t*>(state.vy.data());
+        case SnapshotColumn::VelocityZ: return reinterpret_cast<const std::uint8_t*>(state.vz.data());
+        case SnapshotColumn::MarkovState: return reinterpret_cast<const std::uint8_t*>(state.markovState.data());
+        case SnapshotColumn::IsFemale: return state.isFemale.data();
+        }
+        return nullptr;
+    }
+
+    void writeFrame(std::uint64_t step, BoidStepBuffer& frame)
+    {
+        const std::size_t values    = frame.size();
+        const std::size_t perColumn = (values + SnapshotFileHeader::BLOCK_VALUES - 1) / SnapshotFileHeader::BLOCK_VALUES;
+        const bool keyframe = !m_options.delta || !m_previousValid || m_previous.size() != frame.size()
+                              || m_index.size() % m_options.keyframeInterval == 0;
+
+        // Encodage des blocs en parallèle, écriture dans l'ordre
+        m_blocks.resize(perColumn * SNAPSHOT_COLUMN_COUNT);
+        m_encoders->parallelFor(m_blocks.size(), 1, [&](std::size_t begin, std::size_t end) {
+            thread_local std::vector<std::uint8_t> planes;
+            for (std::size_t block = begin; block < end; ++block) {
+                const std::size_t column      = block / perColumn;
+                const std::size_t first       = (block % perColumn) * SnapshotFileHeader::BLOCK_VALUES;
+                const std::size_t count       = std::min<std::size_t>(SnapshotFileHeader::BLOCK_VALUES, values - first);
+                const std::size_t elementSize = SNAPSHOT_COLUMNS[column].elementSize;
+                const std::size_t bytes       = count * elementSize;
+                const std::uint8_t* current   = columnBytes(frame, column) + first * elementSize;
+                const std::uint8_t* previous  = keyframe ? nullptr : columnBytes(m_previous, column) + first * elementSize;
+
+                std::vector<std::uint8_t>& out = m_blocks[block];
+                out.resize(sizeof(std::uint32_t) + std::max(bytes, lz::compressBound(bytes)));
+                planes.resize(bytes);
+                detail::splitBytePlanes(current, previous, count, elementSize, planes.data());
+                std::size_t compressed = m_options.compress ? lz::compress(planes.data(), bytes, out.data() + sizeof(std::uint32_t), out.size() - sizeof(std::uint32_t)) : 0;
+                std::uint32_t size = static_cast<std::uint32_t>(compressed);
+                if (compressed == 0 || compressed >= bytes) {
+                    std::memcpy(out.data() + sizeof(std::uint32_t), planes.data(), bytes);
+                    size = static_cast<std::uint32_t>(bytes) | SNAPSHOT_RAW_BLOCK;
+                }
+                std::memcpy(out.data(), &size, sizeof(size));
+                out.resize(sizeof(std::uint32_t) + (size & ~SNAPSHOT_RAW_BLOCK));
+            }
+        });
+
+        SnapshotFrameHeader header{};
+        header.step      = step;
+        header.boidCount = static_cast<std::uint32_t>(values);
+        header.keyframe  = keyframe ? 1 : 0;
+        for (const auto& block : m_blocks) {
+            header.payloadBytes += block.size();
+        }
+        m_index.push_back({step, m_offset});
+        write(&header, sizeof(header));
+        for (const auto& block : m_blocks) {
+            write(block.data(), block.size());
+        }
+        for (const auto& column : SNAPSHOT_COLUMNS) {
+            m_rawBytes += values * column.elementSize;
+        }
+
+        // Référence de la frame suivante : échanger les tampons évite une copie, m_frame
+        // repart vers la simulation, qui le réécrit entièrement
+        if (m_options.delta) {
+            m_previous.swap(frame);
+            m_previousValid = true;
+        }
+    }
+
+    void write(const void* data, std::size_t size)
+    {
+        if (size > 0 && std::fwrite(data, 1, size, m_file) != size) {
+            m_failed = true;
+        }
+        m_offset += size;
+    }
+
+    std::FILE*                  m_file = nullptr;
+    SnapshotOptions             m_options;
+    bool                        m_failed = false;
+    std::unique_ptr<ThreadPool> m_encoders;
+    std::thread                 m_thread;
+    std::atomic<std::uint32_t>  m_state{IDLE};
+
+    // Partagés avec la simulation : m_pending et m_pendingStep passent au thread
+    // d'écriture avec PENDING, et reviennent à la simulation avec IDLE
+    BoidStepBuffer             m_pending;
+    std::uint64_t              m_pendingStep = 0;
+    std::uint64_t              m_submitted   = 0;
+    std::uint64_t              m_dropped     = 0;
+    std::atomic<std::uint64_t> m_written{0};
+
+    // Utilisés uniquement par le thread d'écriture (puis par close)
+    BoidStepBuffer                         m_frame;
+    BoidStepBuffer                         m_previous;
+    bool                                   m_previousValid = false;
+    std::vector<std::vector<std::uint8_t>> m_blocks;
+    std::vector<SnapshotIndexEntry>        m_index;
+    std::uint64_t                          m_offset   = 0;
+    std::uint64_t                          m_rawBytes = 0;
+};
+
+// Lecture d'un fichier d'export projeté en mémoire. Un fichier sans index (écriture
+// interrompue) reste lisible : l'index est alors reconstruit en parcourant les frames.
+class SnapshotReader {
+public:
+    static constexpr std::size_t NO_FRAME = std::numeric_limits<std::size_t>::max();
+
+    // Renvoie false si le fichier est absent ou d'une autre version
+    bool open(const char* path)
+    {
+        m_index.clear();
+        m_currentIndex = NO_FRAME;
+        m_indexed      = false;
+        if (!m_file.open(path) || m_file.size() < sizeof(SnapshotFileHeader)) {
+            return false;
+        }
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, SnapshotFileHeader::MAGIC, sizeof(m_header.magic)) != 0
+            || m_header.version != SnapshotFileHeader::VERSION || m_header.columnCount != SNAPSHOT_COLUMN_COUNT
+            || m_header.blockValues == 0) {
+            m_file.close();
+            return false;
+        }
+        if (!readIndex()) {
+            scanFrames();
+        }
+        return true;
+    }
+
+    const SnapshotFileHeader& header() const { return m_header; }
+    bool                      indexed() const { return m_indexed; } // Index lu en fin de fichier
+    std::size_t               frameCount() const { return m_index.size(); }
+    std::uint64_t             stepAt(std::size_t index) const { return m_index[index].step; }
+    std::size_t               fileSize() const { return m_file.size(); }
+
+    // Dernière frame dont le pas est <= step (NO_FRAME s'il n'y en a pas)
+    std::size_t findStep(std::uint64_t step) const
+    {
+        auto it = std::upper_bound(m_index.begin(), m_index.end(), step, [](std::uint64_t s, const SnapshotIndexEntry& entry) { return s < entry.step; });
+        return it == m_index.begin() ? NO_FRAME : static_cast<std::size_t>(it - m_index.begin()) - 1;
+    }
+
+    // Décode la frame index, valide jusqu'à la lecture suivante (nullptr si le fichier est
+    // corrompu). Lire les frames dans l'ordre ne décode chacune qu'une fois.
+    const SnapshotFrame* read(std::size_t index)
+    {
+        if (index >= m_index.size()) {
+            return nullptr;
+        }
+        if (m_currentIndex == index) {
+            return &m_current;
+        }
+        // Remonter jusqu'à l'image clé, ou jusqu'à la frame déjà décodée si elle est sur le chemin
+        std::size_t start = index;
+        while (true) {
+            SnapshotFrameHeader header;
+            if (!frameHeader(start, header)) {
+                return nullptr;
+            }
+            if (header.keyframe != 0 || start == 0 || start - 1 == m_currentIndex) {
+                break;
+            }
+            --start;
+        }
+        for (std::size_t i = start; i <= index; ++i) {
+            if (!decodeFrame(i)) {
+                m_currentIndex = NO_FRAME;
+                return nullptr;
+            }
+            m_currentIndex = i;
+        }
+        return &m_current;
+    }
+
+private:
+    // Les frames se suivent sans alignement : l'en-tête est recopié
+    bool frameHeader(std::size_t index, SnapshotFrameHeader& header) const
+    {
+        std::uint64_t offset = m_index[index].offset;
+        if (offset > m_file.size() || m_file.size() - offset < sizeof(SnapshotFrameHeader)) {
+            return false;
+        }
+        std::memcpy(&header, m_file.data() + offset, sizeof(header));
+        return header.payloadBytes <= m_file.size() - offset - sizeof(header);
+    }
+
+    bool readIndex()
+    {
+        if (m_file.size() < sizeof(SnapshotFileHeader) + sizeof(SnapshotFooter)) {
+            return false;
+        }
+        SnapshotFooter footer;
+        std::memcpy(&footer, m_file.data() + m_file.size() - sizeof(footer), sizeof(footer));
+        if (std::memcmp(footer.magic, SnapshotFooter::MAGIC, sizeof(footer.magic)) != 0 || footer.indexOffset > m_file.size()
+            || footer.frameCount != (m_file.size() - sizeof(footer) - footer.indexOffset) / sizeof(SnapshotIndexEntry)) {
+            return false;
+        }
+        m_index.resize(footer.frameCount);
+        std::memcpy(m_index.data(), m_file.data() + footer.indexOffset, m_index.size() * sizeof(SnapshotIndexEntry));
+        m_indexed = true;
+        return true;
+    }
+
+    // Frames complètes à la suite de l'en-tête du fichier
+    void scanFrames()
+    {
+        std::uint64_t offset = sizeof(SnapshotFileHeader);
+        while (m_file.size() - offset >= sizeof(SnapshotFrameHeader)) {
+            SnapshotFrameHeader header;
+            std::memcpy(&header, m_file.data() + offset, sizeof(header));
+            if (header.payloadBytes > m_file.size() - offset - sizeof(header)) {
+                break;
+            }
+            m_index.push_back({header.step, offset});
+            offset += sizeof(header) + header.payloadBytes;
+        }
+    }
+
+    // Décode la frame index dans m_current, qui contient la frame index - 1 si ce n'est
+    // pas une image clé
+    bool decodeFrame(std::size_t index)
+    {
+        SnapshotFrameHeader header;
+        if (!frameHeader(index, header)) {
+            return false;
+        }
+        const bool delta = header.keyframe == 0;
+        if (delta && (m_currentIndex != index - 1 || m_current.boidCount != header.boidCount)) {
+            return false;
+        }
+        m_current.step = header.step;
+        m_current.resize(header.boidCount);
+
+        const std::uint8_t* data      = reinterpret_cast<const std::uint8_t*>(m_file.data() + m_index[index].offset + sizeof(header));
+        const std::uint8_t* end       = data + header.payloadBytes;
+        const std::size_t   values    = header.boidCount;
+        const std::size_t   blockSize = m_header.blockValues;
+        for (std::size_t column = 0; column < SNAPSHOT_COLUMN_COUNT; ++column) {
+            const std::size_t elementSize = SNAPSHOT_COLUMNS[column].elementSize;
+            for (std::size_t first = 0; first < values; first += blockSize) {
+                const std::size_t count = std::min(blockSize, values - first);
+                const std::size_t bytes = count * elementSize;
+                std::uint32_t     size;
+                if (end - data < static_cast<std::ptrdiff_t>(sizeof(size))) {
+                    return false;
+                }
+                std::memcpy(&size, data, sizeof(size));
+                data += sizeof(size);
+                const std::size_t stored = size & ~SNAPSHOT_RAW_BLOCK;
+                if (stored > static_cast<std::size_t>(end - data)) {
+                    return false;
+                }
+                const std::uint8_t* planes = data;
+                if (size & SNAPSHOT_RAW_BLOCK) {
+                    if (stored != bytes) {
+                        return false;
+                    }
+                } else {
+                    m_planes.resize(bytes);
+                    if (!lz::decompress(data, stored, m_planes.data(), bytes)) {
+                        return false;
+                    }
+                    planes = m_planes.data();
+                }
+                detail::mergeBytePlanes(planes, count, elementSize, delta, m_current.columns[column].data() + first * elementSize);
+                data += stored;
+            }
+        }
+        return data == end;
+    }
+
+    MappedFile                      m_file;
+    SnapshotFileHeader              m_header{};
+    std::vector<SnapshotIndexEntry> m_index;
+    bool                            m_indexed = false;
+    SnapshotFrame                   m_current;
+    std::size_t                     m_currentIndex = NO_FRAME; // Frame contenue dans m_current
+    std::vector<std::uint8_t>       m_planes;
+};
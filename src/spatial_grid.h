@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "steering_kernels.h"
+
+// Grille uniforme couvrant le cube englobant du dôme [-halfExtent, halfExtent]^3.
+// Elle est reconstruite à chaque frame par un tri par comptage (O(N + cellules)) :
+// les indices des boids sont rangés cellule par cellule, ce qui permet de ne
+// parcourir que les cellules voisines lors de la recherche de voisins. La grille peut
+// avoir plusieurs couches (une par espèce) : les boids sont alors rangés couche par
+// couche, puis cellule par cellule dans chaque couche.
+class SpatialGrid {
+public:
+    // Nombre maximal de cellules par axe, pour borner la mémoire quand le rayon est petit
+    static constexpr int MAX_RESOLUTION = 64;
+
+    // Reconstruit la grille à partir de `count` positions données par positionOf(i)
+    template<typename PositionFn>
+    void build(std::size_t count, float halfExtent, float cellSize, PositionFn&& positionOf)
+    {
+        build(count, halfExtent, cellSize, 1, positionOf, [](std::size_t) { return 0; });
+    }
+
+    // Même chose sur `layers` couches, le boid i étant rangé dans la couche layerOf(i)
+    template<typename PositionFn, typename LayerFn>
+    void build(std::size_t count, float halfExtent, float cellSize, std::size_t layers, PositionFn&& positionOf, LayerFn&& layerOf)
+    {
+        m_origin = -halfExtent;
+        m_resolution = std::clamp(static_cast<int>(2.0f * halfExtent / cellSize), 1, MAX_RESOLUTION);
+        m_cellSize = 2.0f * halfExtent / static_cast<float>(m_resolution);
+        m_invCellSize = 1.0f / m_cellSize;
+
+        m_layerCells         = static_cast<std::size_t>(m_resolution) * m_resolution * m_resolution;
+        m_layers             = std::max<std::size_t>(1, layers);
+        std::size_t numCells = m_layers * m_layerCells;
+        m_cellStart.assign(numCells + 1, 0);
+        m_cellOf.resize(count);
+        m_indices.resize(count);
+
+        // 1. Compter le nombre de boids par cellule
+        for (std::size_t i = 0; i < count; ++i) {
+            m_cellOf[i] = static_cast<std::uint32_t>(static_cast<std::size_t>(layerOf(i)) * m_layerCells + cellIndex(positionOf(i)));
+            ++m_cellStart[m_cellOf[i] + 1];
+        }
+
+        // 2. Somme préfixe : début de chaque cellule dans m_indices
+        for (std::size_t c = 0; c < numCells; ++c) {
+            m_cellStart[c + 1] += m_cellStart[c];
+        }
+
+        // 3. Ranger les indices (l'ordre d'origine est conservé dans chaque cellule)
+        m_cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (std::size_t i = 0; i < count; ++i) {
+            m_indices[m_cursor[m_cellOf[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    // Appelle fn(j) pour chaque boid j rangé dans une cellule touchant la boule (position, radius),
+    // dans toutes les couches. C'est à l'appelant de filtrer sur la distance exacte.
+    template<typename Fn>
+    void forEachCandidate(const glm::vec3& position, float radius, Fn&& fn) const
+    {
+        glm::ivec3 minCell = cellCoords(position - glm::vec3(radius));
+        glm::ivec3 maxCell = cellCoords(position + glm::vec3(radius));
+
+        for (std::size_t layer = 0; layer < m_layers; ++layer) {
+            for (int z = minCell.z; z <= maxCell.z; ++z) {
+                for (int y = minCell.y; y <= maxCell.y; ++y) {
+                    for (int x = minCell.x; x <= maxCell.x; ++x) {
+                        std::size_t cell = layer * m_layerCells + flatten(x, y, z);
+                        for (std::uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                            fn(m_indices[k]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int         resolution() const { return m_resolution; }
+    std::size_t layers() const { return m_layers; }
+
+    // Indices des boids dans l'ordre de la grille (couche par couche, cellule par cellule)
+    const std::vector<std::uint32_t>& sortedIndices() const { return m_indices; }
+
+    std::size_t memoryBytes() const
+    {
+        return (m_cellStart.capacity() + m_cursor.capacity() + m_cellOf.capacity() + m_indices.capacity()) * sizeof(std::uint32_t);
+    }
+
+    // Vue brute pour les noyaux SIMD, qui parcourent les rangées de cellules contiguës
+    GridView view() const { return {m_cellStart.data(), m_resolution, m_origin, m_invCellSize, m_layerCells}; }
+
+private:
+    glm::ivec3 cellCoords(const glm::vec3& position) const
+    {
+        // Les boids légèrement hors du dôme sont rattachés aux cellules du bord
+        glm::ivec3 coords = glm::ivec3(glm::floor((position - m_origin) * m_invCellSize));
+        return glm::clamp(coords, glm::ivec3(0), glm::ivec3(m_resolution - 1));
+    }
+
+    std::size_t flatten(int x, int y, int z) const
+    {
+        return (static_cast<std::size_t>(z) * m_resolution + y) * m_resolution + x;
+    }
+
+    std::uint32_t cellIndex(const glm::vec3& position) const
+    {
+        glm::ivec3 c = cellCoords(position);
+        return static_cast<std::uint32_t>(flatten(c.x, c.y, c.z));
+    }
+
+    float m_origin      = 0.0f;
+    float m_cellSize    = 1.0f;
+    float m_invCellSize = 1.0f;
+    int   m_resolution  = 1;
+
+    std::size_t m_layers     = 1;
+    std::size_t m_layerCells = 1; // Cellules par couche
+
+    std::vector<std::uint32_t> m_cellStart; // Début de chaque cellule dans m_indices (taille : cellules + 1)
+    std::vector<std::uint32_t> m_cursor;    // Position d'écriture par cellule pendant le rangement
+    std::vector<std::uint32_t> m_cellOf;    // Cellule de chaque boid
+    std::vector<std::uint32_t> m_indices;   // Indices des boids triés par cellule
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Paramètres d'une espèce de boids. Rayon et poids sont des facteurs appliqués à ceux de
+// FlockParams (les curseurs restent des réglages d'ensemble), et les poids propres à
+// chaque boid s'y appliquent encore.
+struct SpeciesParams {
+    float     interactionRadius = 1.0f;
+    float     separationWeight  = 1.0f;
+    float     alignmentWeight   = 1.0f;
+    float     cohesionWeight    = 1.0f;
+    float     share             = 1.0f; // Part de la population totale (voir resizeFlock)
+    glm::vec3 color{1.0f};
+};
+
+// Table des espèces et matrice d'interaction : interaction(a, b) pondère l'influence des
+// voisins de l'espèce b sur un boid de l'espèce a (séparation, alignement, cohésion).
+// À 0, les voisins de l'espèce b sont ignorés, y compris par la chaîne de Markov.
+class SpeciesTable {
+public:
+    static constexpr std::size_t MAX_SPECIES = 8;
+
+    // Une seule espèce, aux facteurs neutres
+    SpeciesTable()
+        : SpeciesTable(std::vector<SpeciesParams>(1))
+    {}
+
+    // Toutes les espèces interagissent avec un poids de 1 ; au plus MAX_SPECIES, au moins une
+    explicit SpeciesTable(std::vector<SpeciesParams> species)
+        : m_species(std::move(species))
+    {
+        if (m_species.empty()) {
+            m_species.resize(1);
+        }
+        if (m_species.size() > MAX_SPECIES) {
+            m_species.resize(MAX_SPECIES);
+        }
+        m_interactions.assign(m_species.size() * m_species.size(), 1.0f);
+    }
+
+    std::size_t size() const { return m_species.size(); }
+
+    SpeciesParams&       operator[](std::size_t species) { return m_species[species]; }
+    const SpeciesParams& operator[](std::size_t species) const { return m_species[species]; }
+
+    float interaction(std::size_t species, std::size_t other) const { return m_interactions[species * size() + other]; }
+
+    // Poids négatifs ramenés à 0 : les sommes pondérées servent de moyennes
+    void setInteraction(std::size_t species, std::size_t other, float weight) { m_interactions[species * size() + other] = std::max(0.0f, weight); }
+
+    // Ligne de la matrice pour l'espèce species (size() poids)
+    const float* interactions(std::size_t species) const { return m_interactions.data() + species * size(); }
+
+    float maxInteractionRadius() const
+    {
+        float radius = 0.0f;
+        for (const SpeciesParams& species : m_species) {
+            radius = std::max(radius, species.interactionRadius);
+        }
+        return radius;
+    }
+
+private:
+    std::vector<SpeciesParams> m_species;
+    std::vector<float>         m_interactions; // size() x size(), ligne par espèce
+};
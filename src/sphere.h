@@ -2,7 +2,9 @@
 
 #include <vector>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <utility>
 #include "glm/glm.hpp" // Ajout de l'inclusion de la bibliothèque glm
 #include "glm/gtc/constants.hpp" // Ajout de l'inclusion pour glm::pi
 
@@ -60,28 +62,25 @@ class Sphere {
     }
   }
 
-  m_nVertexCount = discLat * discLong * 6;
+  m_Vertices = std::move(data);
+  m_nVertexCount = static_cast<GLsizei>(m_Vertices.size());
 
-  // GLuint idx = 0;
-  // Construit les vertex finaux en regroupant les données en triangles:
-  // Pour une longitude donnée, les deux triangles formant une face sont de la
-  // forme: (i, i + 1, i + discLat + 1), (i, i + discLat + 1, i + discLat) avec
-  // i sur la bande correspondant à la longitude
+  // Construit les indices des triangles : pour une longitude donnée, les deux
+  // triangles formant une face sont de la forme : (i, i + 1, i + discLat + 2),
+  // (i, i + discLat + 2, i + discLat + 1) avec i sur la bande correspondant à la
+  // longitude. Chaque sommet n'est stocké qu'une fois.
+  m_Indices.reserve(static_cast<std::size_t>(discLat) * discLong * 6);
   for (GLsizei j = 0; j < discLong; ++j) {
-    GLsizei offset = j * (discLat + 1);
+    GLuint offset = j * (discLat + 1);
     for (GLsizei i = 0; i < discLat; ++i) {
-      m_Vertices.push_back(data[offset + i]);
-      m_Vertices.push_back(data[offset + (i + 1)]);
-      m_Vertices.push_back(data[offset + discLat + 1 + (i + 1)]);
-      m_Vertices.push_back(data[offset + i]);
-      m_Vertices.push_back(data[offset + discLat + 1 + (i + 1)]);
-      m_Vertices.push_back(data[offset + i + discLat + 1]);
+      m_Indices.push_back(offset + i);
+      m_Indices.push_back(offset + (i + 1));
+      m_Indices.push_back(offset + discLat + 1 + (i + 1));
+      m_Indices.push_back(offset + i);
+      m_Indices.push_back(offset + discLat + 1 + (i + 1));
+      m_Indices.push_back(offset + i + discLat + 1);
     }
   }
-
-  // Attention ! dans cette implantation on duplique beaucoup de sommets. Une
-  // meilleur stratégie est de passer par un Index Buffer Object, que nous
-  // verrons dans les prochains TDs
 }
 
 public:
@@ -98,13 +97,14 @@ public:
   // Renvoit le nombre de vertex
   GLsizei getVertexCount() const { return m_nVertexCount; }
 
-  GLuint getVAO() const {
-        return VAO;
-    }
+  // Renvoit le pointeur vers les indices des triangles
+  const GLuint *getIndexPointer() const { return &m_Indices[0]; }
+
+  // Renvoit le nombre d'indices (3 par triangle)
+  GLsizei getIndexCount() const { return static_cast<GLsizei>(m_Indices.size()); }
 
 private:
   std::vector<ShapeVertex> m_Vertices;
+  std::vector<GLuint> m_Indices;
   GLsizei m_nVertexCount; // Nombre de sommets
-    //GLuint VAO, VBO, EBO;
-    GLuint VAO;
 };
@@ -0,0 +1,52 @@
+#include "steering_kernels.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Le processeur et le système d'exploitation supportent-ils AVX2 ?
+bool cpuSupportsAvx2()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osUsesXsave = (info[2] & (1 << 27)) != 0;
+    bool hasAvx      = (info[2] & (1 << 28)) != 0;
+    if (!osUsesXsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+const SteeringKernels& selectSteeringKernels()
+{
+    if (const SteeringKernels* kernels = avx2SteeringKernels(); kernels != nullptr && cpuSupportsAvx2()) {
+        return *kernels;
+    }
+    if (const SteeringKernels* kernels = sseSteeringKernels(); kernels != nullptr) {
+        return *kernels;
+    }
+    return *scalarSteeringKernels();
+}
+
+} // namespace
+
+const SteeringKernels& steeringKernels()
+{
+    static const SteeringKernels& kernels = selectSteeringKernels();
+    return kernels;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "boid_soa.h"
+#include "glm/glm.hpp"
+#include "spatial_grid.h"
+#include "steering_kernels.h"
+
+// Résultats de la passe de voisinage, dans l'ordre des boids
+struct NeighborAccumulators {
+    std::vector<float> separationX, separationY, separationZ;
+    std::vector<float> alignmentX, alignmentY, alignmentZ;
+    std::vector<float> cohesionX, cohesionY, cohesionZ;
+    std::vector<float> neighborCount;
+    std::vector<float> markovNeighborCount; // Voisins dans le rayon de la chaîne de Markov
+
+    NeighborAccumulators() = default;
+
+    explicit NeighborAccumulators(std::size_t count) { resize(count); }
+
+    void resize(std::size_t count)
+    {
+        for (auto* array : {&separationX, &separationY, &separationZ, &alignmentX, &alignmentY, &alignmentZ, &cohesionX, &cohesionY, &cohesionZ, &neighborCount, &markovNeighborCount}) {
+            array->resize(count);
+        }
+    }
+};
+
+// Copie des données chaudes des boids dans l'ordre de la grille : les boids d'une
+// rangée de cellules voisines sont contigus et peuvent être lus par paquets SIMD
+struct SortedBoids {
+    std::vector<float> x, y, z, vx, vy, vz;
+
+    void resize(std::size_t count)
+    {
+        for (auto* array : {&x, &y, &z, &vx, &vy, &vz}) {
+            array->resize(count);
+        }
+    }
+
+    // Recopie les emplacements triés [begin, end) ; les tableaux doivent déjà être dimensionnés
+    void gather(const BoidSoA& boids, const SpatialGrid& grid, std::size_t begin, std::size_t end)
+    {
+        const std::vector<std::uint32_t>& order = grid.sortedIndices();
+        for (std::size_t s = begin; s < end; ++s) {
+            std::uint32_t i = order[s];
+            x[s]            = boids.px[i];
+            y[s]            = boids.py[i];
+            z[s]            = boids.pz[i];
+            vx[s]           = boids.vx[i];
+            vy[s]           = boids.vy[i];
+            vz[s]           = boids.vz[i];
+        }
+    }
+};
+
+// Paramètres des règles appliquées après la passe de voisinage
+struct SteeringParams {
+    float     alignmentWeight;
+    float     cohesionWeight;
+    float     distanceMinToCamera;
+    float     avoidanceWeight;
+    float     domeRadius;
+    float     deltaTime;
+    glm::vec3 cameraPosition;
+    glm::vec3 surveyorPosition;
+    float     separationWeight = 1.0f; // Facteur de l'espèce traitée
+};
+
+// Une seule espèce, dont les voisins comptent pleinement
+inline constexpr float SINGLE_SPECIES_WEIGHTS[1] = {1.0f};
+
+// Arguments de la passe de voisinage pour les emplacements triés [begin, end), tous de
+// la même espèce. pairWeights donne le poids des voisins de chacune des couches de la grille.
+inline NeighborPassArgs makeNeighborPassArgs(const SortedBoids& sorted, const SpatialGrid& grid, float separationDistance, float interactionRadius, float markovRadius, NeighborAccumulators& out, std::size_t begin, std::size_t end,
+                                             const float* pairWeights = SINGLE_SPECIES_WEIGHTS)
+{
+    NeighborPassArgs args{};
+    args.x                    = sorted.x.data();
+    args.y                    = sorted.y.data();
+    args.z                    = sorted.z.data();
+    args.vx                   = sorted.vx.data();
+    args.vy                   = sorted.vy.data();
+    args.vz                   = sorted.vz.data();
+    args.sortedIndices        = grid.sortedIndices().data();
+    args.grid                 = grid.view();
+    args.begin                = begin;
+    args.end                  = end;
+    args.queryRadius          = std::max({separationDistance, interactionRadius, markovRadius});
+    args.separationDistanceSq = separationDistance * separationDistance;
+    args.interactionRadiusSq  = interactionRadius * interactionRadius;
+    args.markovRadiusSq       = markovRadius * markovRadius;
+    args.pairWeights          = pairWeights;
+    args.speciesCount         = grid.layers();
+    args.separationX          = out.separationX.data();
+    args.separationY          = out.separationY.data();
+    args.separationZ          = out.separationZ.data();
+    args.alignmentX           = out.alignmentX.data();
+    args.alignmentY           = out.alignmentY.data();
+    args.alignmentZ           = out.alignmentZ.data();
+    args.cohesionX            = out.cohesionX.data();
+    args.cohesionY            = out.cohesionY.data();
+    args.cohesionZ            = out.cohesionZ.data();
+    args.neighborCount        = out.neighborCount.data();
+    args.markovNeighborCount  = out.markovNeighborCount.data();
+    return args;
+}
+
+// Arguments de l'intégration des boids [begin, end) : état lu dans `in`, écrit dans
+// les tableaux out* (de même taille)
+inline IntegrateArgs makeIntegrateArgs(const BoidSoA& in, float* outPx, float* outPy, float* outPz, float* outVx, float* outVy, float* outVz, const NeighborAccumulators& sums, const SteeringParams& params, std::size_t begin, std::size_t end)
+{
+    IntegrateArgs args{};
+    args.inPx                = in.px.data() + begin;
+    args.inPy                = in.py.data() + begin;
+    args.inPz                = in.pz.data() + begin;
+    args.inVx                = in.vx.data() + begin;
+    args.inVy                = in.vy.data() + begin;
+    args.inVz                = in.vz.data() + begin;
+    args.outPx               = outPx + begin;
+    args.outPy               = outPy + begin;
+    args.outPz               = outPz + begin;
+    args.outVx               = outVx + begin;
+    args.outVy               = outVy + begin;
+    args.outVz               = outVz + begin;
+    args.count               = end - begin;
+    args.separationX         = sums.separationX.data() + begin;
+    args.separationY         = sums.separationY.data() + begin;
+    args.separationZ         = sums.separationZ.data() + begin;
+    args.alignmentX          = sums.alignmentX.data() + begin;
+    args.alignmentY          = sums.alignmentY.data() + begin;
+    args.alignmentZ          = sums.alignmentZ.data() + begin;
+    args.cohesionX           = sums.cohesionX.data() + begin;
+    args.cohesionY           = sums.cohesionY.data() + begin;
+    args.cohesionZ           = sums.cohesionZ.data() + begin;
+    args.neighborCount       = sums.neighborCount.data() + begin;
+    args.separationWeights   = in.separationWeight.data() + begin;
+    args.alignmentWeights    = in.alignmentWeight.data() + begin;
+    args.cohesionWeights     = in.cohesionWeight.data() + begin;
+    args.separationWeight    = params.separationWeight;
+    args.alignmentWeight     = params.alignmentWeight;
+    args.cohesionWeight      = params.cohesionWeight;
+    args.distanceMinToCamera = params.distanceMinToCamera;
+    args.avoidanceWeight     = params.avoidanceWeight;
+    args.surveyorAvoidance   = params.avoidanceWeight * params.deltaTime;
+    args.deltaTime           = params.deltaTime;
+    args.domeRadius          = params.domeRadius;
+    args.cameraPosition[0]   = params.cameraPosition.x;
+    args.cameraPosition[1]   = params.cameraPosition.y;
+    args.cameraPosition[2]   = params.cameraPosition.z;
+    args.surveyorPosition[0] = params.surveyorPosition.x;
+    args.surveyorPosition[1] = params.surveyorPosition.y;
+    args.surveyorPosition[2] = params.surveyorPosition.z;
+    return args;
+}
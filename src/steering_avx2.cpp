@@ -0,0 +1,24 @@
+// Compilé avec les instructions AVX2 (voir CMakeLists.txt) : ne l'appeler qu'après
+// avoir vérifié que le processeur les supporte (voir steering.cpp).
+#include "steering_kernels.h"
+#include "steering_kernels_impl.h"
+
+#if STEERING_HAS_AVX2
+
+namespace {
+const SteeringKernels avx2Kernels{"AVX2", &accumulateNeighborsKernel<Avx2Batch>, &integrateKernel<Avx2Batch>};
+} // namespace
+
+const SteeringKernels* avx2SteeringKernels()
+{
+    return &avx2Kernels;
+}
+
+#else
+
+const SteeringKernels* avx2SteeringKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Structures simples (sans std::vector ni glm) partagées avec les fichiers de noyaux
+// SIMD. Ces fichiers sont compilés avec des options différentes (voir CMakeLists.txt) :
+// ils ne doivent inclure que ce fichier, steering_kernels_impl.h et steering_rules.h.
+
+// Vue en lecture seule sur une SpatialGrid
+struct GridView {
+    const std::uint32_t* cellStart; // Début de chaque cellule dans l'ordre trié
+    int                  resolution;
+    float                origin;
+    float                invCellSize;
+    std::size_t          layerCells; // Cellules par couche (une couche par espèce)
+};
+
+// Passe de voisinage : accumule séparation, alignement et cohésion de chaque boid, et
+// compte ses voisins dans le rayon de la chaîne de Markov. Les boids traités sont tous
+// de la même espèce ; les voisins sont cherchés dans chaque couche de la grille, leur
+// contribution pondérée par le poids d'interaction de leur espèce.
+struct NeighborPassArgs {
+    // Données chaudes rangées dans l'ordre de la grille
+    const float*         x;
+    const float*         y;
+    const float*         z;
+    const float*         vx;
+    const float*         vy;
+    const float*         vz;
+    const std::uint32_t* sortedIndices; // Emplacement trié -> indice du boid
+    GridView             grid;
+
+    // Tranche d'emplacements triés à traiter : [begin, end)
+    std::size_t begin;
+    std::size_t end;
+
+    float queryRadius;
+    float separationDistanceSq;
+    float interactionRadiusSq;
+    float markovRadiusSq;
+
+    // Poids des voisins de chaque espèce (couche) : 0 pour les ignorer
+    const float* pairWeights;
+    std::size_t  speciesCount;
+
+    // Sorties, dans l'ordre d'origine des boids
+    float* separationX;
+    float* separationY;
+    float* separationZ;
+    float* alignmentX;
+    float* alignmentY;
+    float* alignmentZ;
+    float* cohesionX;
+    float* cohesionY;
+    float* cohesionZ;
+    float* neighborCount;
+    float* markovNeighborCount;
+};
+
+// Application des règles, évitement caméra / arpenteur, intégration et confinement au dôme.
+// L'état est lu dans in* et écrit dans out* (qui peuvent désigner les mêmes tableaux).
+struct IntegrateArgs {
+    const float* inPx;
+    const float* inPy;
+    const float* inPz;
+    const float* inVx;
+    const float* inVy;
+    const float* inVz;
+    float*       outPx;
+    float*       outPy;
+    float*       outPz;
+    float*       outVx;
+    float*       outVy;
+    float*       outVz;
+    std::size_t  count;
+
+    const float* separationX;
+    const float* separationY;
+    const float* separationZ;
+    const float* alignmentX;
+    const float* alignmentY;
+    const float* alignmentZ;
+    const float* cohesionX;
+    const float* cohesionY;
+    const float* cohesionZ;
+    const float* neighborCount;
+
+    // Facteurs propres à chaque boid, appliqués aux poids des règles (1 : poids commun)
+    const float* separationWeights;
+    const float* alignmentWeights;
+    const float* cohesionWeights;
+
+    float separationWeight;
+    float alignmentWeight;
+    float cohesionWeight;
+    float distanceMinToCamera;
+    float avoidanceWeight;
+    float surveyorAvoidance; // avoidanceWeight * deltaTime
+    float deltaTime;
+    float domeRadius;
+    float cameraPosition[3];
+    float surveyorPosition[3];
+};
+
+struct SteeringKernels {
+    const char* name;
+    // Renvoie le nombre de paires (boid, voisin candidat) examinées
+    std::uint64_t (*accumulateNeighbors)(const NeighborPassArgs& args);
+    void (*integrate)(const IntegrateArgs& args);
+};
+
+// Noyaux par jeu d'instructions (nullptr s'ils ne sont pas compilés pour cette cible)
+const SteeringKernels* scalarSteeringKernels();
+const SteeringKernels* sseSteeringKernels();
+const SteeringKernels* avx2SteeringKernels();
+
+// Meilleurs noyaux supportés par le processeur (détection faite une seule fois)
+const SteeringKernels& steeringKernels();
@@ -0,0 +1,180 @@
+#pragma once
+
+// Implantation des noyaux de pilotage, écrite une seule fois sous forme de templates
+// sur un type de paquet (scalaire, SSE2, AVX2) ; les règles elles-mêmes sont dans
+// steering_rules.h. Ce fichier n'est inclus que par
+// steering_scalar.cpp, steering_sse.cpp et steering_avx2.cpp : tout est dans un
+// espace de noms anonyme pour que le code compilé avec AVX2 ne puisse pas être
+// partagé par l'éditeur de liens avec les autres fichiers.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "simd.h"
+#include "steering_kernels.h"
+
+#if defined(__AVX2__)
+#define STEERING_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ---Paquet scalaire (repli portable)---
+
+struct ScalarBatch {
+    using F = float;
+    using M = bool;
+    static constexpr int width = 1;
+
+    static F    load(const float* p) { return *p; }
+    static F    loadPartial(const float* p, std::size_t) { return *p; }
+    static void store(float* p, F v) { *p = v; }
+    static void storePartial(float* p, F v, std::size_t) { *p = v; }
+    static F    set1(float v) { return v; }
+    static M    laneMask(std::size_t n) { return n > 0; }
+    static F    sqrt(F v) { return std::sqrt(v); }
+    static float hsum(F v) { return v; }
+};
+
+inline bool  lt(float a, float b) { return a < b; }
+inline bool  gt(float a, float b) { return a > b; }
+inline float select(bool m, float a, float b) { return m ? a : b; }
+
+#if SIMD_HAS_SSE2
+
+// ---Paquet SSE2 (4 flottants)---
+
+struct F32x4 {
+    __m128 v;
+};
+struct M32x4 {
+    __m128 v;
+};
+
+inline F32x4 operator+(F32x4 a, F32x4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F32x4 operator-(F32x4 a, F32x4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline F32x4 operator*(F32x4 a, F32x4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F32x4 operator/(F32x4 a, F32x4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline M32x4 operator&(M32x4 a, M32x4 b) { return {_mm_and_ps(a.v, b.v)}; }
+inline M32x4 lt(F32x4 a, F32x4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline M32x4 gt(F32x4 a, F32x4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline F32x4 select(M32x4 m, F32x4 a, F32x4 b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+
+struct SseBatch {
+    using F = F32x4;
+    using M = M32x4;
+    static constexpr int width = 4;
+
+    static F    load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static void store(float* p, F v) { _mm_storeu_ps(p, v.v); }
+    static F    set1(float v) { return {_mm_set1_ps(v)}; }
+    static F    sqrt(F v) { return {_mm_sqrt_ps(v.v)}; }
+
+    static F loadPartial(const float* p, std::size_t n)
+    {
+        alignas(16) float lanes[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (std::size_t k = 0; k < n; ++k) {
+            lanes[k] = p[k];
+        }
+        return {_mm_load_ps(lanes)};
+    }
+
+    static void storePartial(float* p, F v, std::size_t n)
+    {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v.v);
+        for (std::size_t k = 0; k < n; ++k) {
+            p[k] = lanes[k];
+        }
+    }
+
+    static M laneMask(std::size_t n)
+    {
+        __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+        return {_mm_castsi128_ps(_mm_cmplt_epi32(lane, _mm_set1_epi32(static_cast<int>(n))))};
+    }
+
+    static float hsum(F v)
+    {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v.v);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+#endif
+
+#if STEERING_HAS_AVX2
+
+// ---Paquet AVX2 (8 flottants)---
+
+struct F32x8 {
+    __m256 v;
+};
+struct M32x8 {
+    __m256 v;
+};
+
+inline F32x8 operator+(F32x8 a, F32x8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline F32x8 operator-(F32x8 a, F32x8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline F32x8 operator*(F32x8 a, F32x8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline F32x8 operator/(F32x8 a, F32x8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline M32x8 operator&(M32x8 a, M32x8 b) { return {_mm256_and_ps(a.v, b.v)}; }
+inline M32x8 lt(F32x8 a, F32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline M32x8 gt(F32x8 a, F32x8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline F32x8 select(M32x8 m, F32x8 a, F32x8 b) { return {_mm256_blendv_ps(b.v, a.v, m.v)}; }
+
+struct Avx2Batch {
+    using F = F32x8;
+    using M = M32x8;
+    static constexpr int width = 8;
+
+    static F    load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static void store(float* p, F v) { _mm256_storeu_ps(p, v.v); }
+    static F    set1(float v) { return {_mm256_set1_ps(v)}; }
+    static F    sqrt(F v) { return {_mm256_sqrt_ps(v.v)}; }
+
+    static __m256i laneMaskBits(std::size_t n)
+    {
+        __m256i lane = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), lane);
+    }
+
+    static F    loadPartial(const float* p, std::size_t n) { return {_mm256_maskload_ps(p, laneMaskBits(n))}; }
+    static void storePartial(float* p, F v, std::size_t n) { _mm256_maskstore_ps(p, laneMaskBits(n), v.v); }
+    static M    laneMask(std::size_t n) { return {_mm256_castsi256_ps(laneMaskBits(n))}; }
+
+    static float hsum(F v)
+    {
+        __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(v.v), _mm256_extractf128_ps(v.v, 1));
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, sum4);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+#endif
+
+} // namespace
+
+// ---Noyaux---
+
+#include "steering_rules.h"
+
+namespace {
+
+// Passes du troupeau, instanciées pour chaque type de paquet
+template<typename B>
+std::uint64_t accumulateNeighborsKernel(const NeighborPassArgs& a)
+{
+    return neighborPass<B>(a, FlockRules{});
+}
+
+template<typename B>
+void integrateKernel(const IntegrateArgs& a)
+{
+    integratePass<B>(a, FlockRules{});
+}
+
+} // namespace
@@ -0,0 +1,407 @@
+#pragma once
+
+// Règles de pilotage sous forme de types « politiques », assemblées à la compilation par
+// les deux passes de steering_kernels_impl.h. Comme lui, ce fichier n'est inclus que par
+// les fichiers de noyaux, après la définition des paquets (ScalarBatch, SseBatch…), et
+// tout est dans un espace de noms anonyme.
+//
+// Une règle dérive de SteeringRule et redéfinit ce dont elle a besoin :
+//  - Sums<B> : ses accumulateurs pour la passe de voisinage. Construits pour chaque boid,
+//    nourris par add() à chaque paquet de voisins puis écrits par store() ;
+//  - apply() : son effet sur un paquet de boids pendant l'intégration.
+// Les passes appellent les étapes de toutes les règles de la liste dans une seule boucle :
+// ajouter une règle n'ajoute ni parcours des voisins ni appel indirect, et les étapes
+// vides disparaissent à la compilation.
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include "steering_kernels.h"
+
+namespace {
+
+// Un paquet de voisins du boid courant, et les grandeurs partagées par toutes les règles
+template<typename B>
+struct NeighborBatch {
+    typename B::F x, y, z;
+    typename B::F vx, vy, vz;
+    typename B::F dx, dy, dz; // Voisin - boid
+    typename B::F d2;
+    typename B::M other;  // Voisins réels, hors le boid lui-même
+    typename B::F weight; // Poids d'interaction de l'espèce des voisins
+};
+
+// Un paquet de boids pendant l'intégration, lu dans les tableaux in* de IntegrateArgs
+template<typename B>
+struct BoidBatch {
+    using F = typename B::F;
+    using M = typename B::M;
+
+    const IntegrateArgs& args;
+    std::size_t          i; // Premier boid du paquet
+    std::size_t          n; // Boids restants à partir de i
+    bool                 full;
+
+    F px, py, pz;
+    F vx, vy, vz;
+    M hasNeighbors; // Au moins un voisin dans le rayon d'interaction
+    F invCount;     // 1 / nombre de ces voisins (1 s'il n'y en a pas)
+
+    BoidBatch(const IntegrateArgs& a, std::size_t first)
+        : args(a), i(first), n(a.count - first), full(n >= static_cast<std::size_t>(B::width))
+    {
+        px = load(a.inPx), py = load(a.inPy), pz = load(a.inPz);
+        vx = load(a.inVx), vy = load(a.inVy), vz = load(a.inVz);
+        const F count = load(a.neighborCount);
+        hasNeighbors  = gt(count, B::set1(0.0f));
+        invCount      = B::set1(1.0f) / select(hasNeighbors, count, B::set1(1.0f));
+    }
+
+    F load(const float* p) const { return full ? B::load(p + i) : B::loadPartial(p + i, n); }
+
+    void store(float* p, F v) const
+    {
+        if (full) {
+            B::store(p + i, v);
+        } else {
+            B::storePartial(p + i, v, n);
+        }
+    }
+
+    void storeState() const
+    {
+        store(args.outPx, px), store(args.outPy, py), store(args.outPz, pz);
+        store(args.outVx, vx), store(args.outVy, vy), store(args.outVz, vz);
+    }
+};
+
+// Règle sans effet : base de toutes les règles
+struct SteeringRule {
+    template<typename B>
+    struct Sums {
+        explicit Sums(const NeighborPassArgs&) {}
+        void add(const NeighborBatch<B>&) {}
+        void store(const NeighborPassArgs&, std::uint32_t) const {}
+    };
+
+    template<typename B>
+    static void apply(BoidBatch<B>&)
+    {}
+};
+
+// ---Règles---
+
+// Séparation : -normalize(d) / |d| = -d / |d|² pour chaque voisin plus proche que
+// separationDistance, puis poids de l'espèce et facteur du boid
+struct Separation : SteeringRule {
+    template<typename B>
+    struct Sums {
+        using F = typename B::F;
+        F zero, one, distanceSq;
+        F x, y, z;
+
+        explicit Sums(const NeighborPassArgs& a)
+            : zero(B::set1(0.0f)), one(B::set1(1.0f)), distanceSq(B::set1(a.separationDistanceSq)), x(zero), y(zero), z(zero)
+        {}
+
+        void add(const NeighborBatch<B>& nb)
+        {
+            const auto mask = nb.other & lt(nb.d2, distanceSq);
+            const F    inv  = one / select(mask, nb.d2, one);
+            x               = x - select(mask, nb.dx * inv * nb.weight, zero);
+            y               = y - select(mask, nb.dy * inv * nb.weight, zero);
+            z               = z - select(mask, nb.dz * inv * nb.weight, zero);
+        }
+
+        void store(const NeighborPassArgs& a, std::uint32_t i) const
+        {
+            a.separationX[i] = B::hsum(x);
+            a.separationY[i] = B::hsum(y);
+            a.separationZ[i] = B::hsum(z);
+        }
+    };
+
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const auto weight = B::set1(b.args.separationWeight) * b.load(b.args.separationWeights);
+        b.vx              = b.vx + b.load(b.args.separationX) * weight;
+        b.vy              = b.vy + b.load(b.args.separationY) * weight;
+        b.vz              = b.vz + b.load(b.args.separationZ) * weight;
+    }
+};
+
+// Nombre de voisins dans le rayon d'interaction (pondéré par espèce), qui moyenne
+// alignement et cohésion
+struct InteractionCount : SteeringRule {
+    template<typename B>
+    struct Sums {
+        using F = typename B::F;
+        F zero, radiusSq;
+        F count;
+
+        explicit Sums(const NeighborPassArgs& a)
+            : zero(B::set1(0.0f)), radiusSq(B::set1(a.interactionRadiusSq)), count(zero)
+        {}
+
+        void add(const NeighborBatch<B>& nb) { count = count + select(nb.other & lt(nb.d2, radiusSq), nb.weight, zero); }
+
+        void store(const NeighborPassArgs& a, std::uint32_t i) const { a.neighborCount[i] = B::hsum(count); }
+    };
+};
+
+// Alignement : la vitesse tend vers la vitesse moyenne (pondérée) des voisins d'interaction
+struct Alignment : SteeringRule {
+    template<typename B>
+    struct Sums {
+        using F = typename B::F;
+        F zero, radiusSq;
+        F x, y, z;
+
+        explicit Sums(const NeighborPassArgs& a)
+            : zero(B::set1(0.0f)), radiusSq(B::set1(a.interactionRadiusSq)), x(zero), y(zero), z(zero)
+        {}
+
+        void add(const NeighborBatch<B>& nb)
+        {
+            const auto mask = nb.other & lt(nb.d2, radiusSq);
+            x               = x + select(mask, nb.vx * nb.weight, zero);
+            y               = y + select(mask, nb.vy * nb.weight, zero);
+            z               = z + select(mask, nb.vz * nb.weight, zero);
+        }
+
+        void store(const NeighborPassArgs& a, std::uint32_t i) const
+        {
+            a.alignmentX[i] = B::hsum(x);
+            a.alignmentY[i] = B::hsum(y);
+            a.alignmentZ[i] = B::hsum(z);
+        }
+    };
+
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const auto weight = B::set1(b.args.alignmentWeight) * b.load(b.args.alignmentWeights);
+        b.vx              = select(b.hasNeighbors, b.vx + (b.load(b.args.alignmentX) * b.invCount - b.vx) * weight, b.vx);
+        b.vy              = select(b.hasNeighbors, b.vy + (b.load(b.args.alignmentY) * b.invCount - b.vy) * weight, b.vy);
+        b.vz              = select(b.hasNeighbors, b.vz + (b.load(b.args.alignmentZ) * b.invCount - b.vz) * weight, b.vz);
+    }
+};
+
+// Cohésion : la vitesse s'oriente vers le centre (pondéré) des voisins d'interaction
+struct Cohesion : SteeringRule {
+    template<typename B>
+    struct Sums {
+        using F = typename B::F;
+        F zero, radiusSq;
+        F x, y, z;
+
+        explicit Sums(const NeighborPassArgs& a)
+            : zero(B::set1(0.0f)), radiusSq(B::set1(a.interactionRadiusSq)), x(zero), y(zero), z(zero)
+        {}
+
+        void add(const NeighborBatch<B>& nb)
+        {
+            const auto mask = nb.other & lt(nb.d2, radiusSq);
+            x               = x + select(mask, nb.x * nb.weight, zero);
+            y               = y + select(mask, nb.y * nb.weight, zero);
+            z               = z + select(mask, nb.z * nb.weight, zero);
+        }
+
+        void store(const NeighborPassArgs& a, std::uint32_t i) const
+        {
+            a.cohesionX[i] = B::hsum(x);
+            a.cohesionY[i] = B::hsum(y);
+            a.cohesionZ[i] = B::hsum(z);
+        }
+    };
+
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const auto weight = B::set1(b.args.cohesionWeight) * b.load(b.args.cohesionWeights);
+        const auto cx     = b.load(b.args.cohesionX) * b.invCount - b.px;
+        const auto cy     = b.load(b.args.cohesionY) * b.invCount - b.py;
+        const auto cz     = b.load(b.args.cohesionZ) * b.invCount - b.pz;
+        const auto length = B::sqrt(cx * cx + cy * cy + cz * cz);
+        b.vx              = select(b.hasNeighbors, b.vx + cx / length * weight, b.vx);
+        b.vy              = select(b.hasNeighbors, b.vy + cy / length * weight, b.vy);
+        b.vz              = select(b.hasNeighbors, b.vz + cz / length * weight, b.vz);
+    }
+};
+
+// Voisins comptés par la chaîne de Markov, sans pondération (aucun effet sur le mouvement)
+struct MarkovCount : SteeringRule {
+    template<typename B>
+    struct Sums {
+        using F = typename B::F;
+        F zero, one, radiusSq;
+        F count;
+
+        explicit Sums(const NeighborPassArgs& a)
+            : zero(B::set1(0.0f)), one(B::set1(1.0f)), radiusSq(B::set1(a.markovRadiusSq)), count(zero)
+        {}
+
+        void add(const NeighborBatch<B>& nb) { count = count + select(nb.other & lt(nb.d2, radiusSq), one, zero); }
+
+        void store(const NeighborPassArgs& a, std::uint32_t i) const { a.markovNeighborCount[i] = B::hsum(count); }
+    };
+};
+
+// Évitement de la caméra, en deçà de distanceMinToCamera
+struct CameraAvoidance : SteeringRule {
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const IntegrateArgs& a        = b.args;
+        const auto           dx       = B::set1(a.cameraPosition[0]) - b.px;
+        const auto           dy       = B::set1(a.cameraPosition[1]) - b.py;
+        const auto           dz       = B::set1(a.cameraPosition[2]) - b.pz;
+        const auto           distance = B::sqrt(dx * dx + dy * dy + dz * dz);
+        const auto           near     = lt(distance, B::set1(a.distanceMinToCamera));
+        const auto           weight   = B::set1(a.avoidanceWeight);
+        b.vx                          = select(near, b.vx + dx / distance * weight, b.vx);
+        b.vy                          = select(near, b.vy + dy / distance * weight, b.vy);
+        b.vz                          = select(near, b.vz + dz / distance * weight, b.vz);
+    }
+};
+
+// Évitement de l'arpenteur, à toute distance
+struct SurveyorAvoidance : SteeringRule {
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const IntegrateArgs& a        = b.args;
+        const auto           dx       = b.px - B::set1(a.surveyorPosition[0]);
+        const auto           dy       = b.py - B::set1(a.surveyorPosition[1]);
+        const auto           dz       = b.pz - B::set1(a.surveyorPosition[2]);
+        const auto           distance = B::sqrt(dx * dx + dy * dy + dz * dz);
+        const auto           weight   = B::set1(a.surveyorAvoidance);
+        b.vx                          = b.vx + dx / distance * weight;
+        b.vy                          = b.vy + dy / distance * weight;
+        b.vz                          = b.vz + dz / distance * weight;
+    }
+};
+
+// Intégration d'Euler
+struct EulerStep : SteeringRule {
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const auto dt = B::set1(b.args.deltaTime);
+        b.px          = b.px + b.vx * dt;
+        b.py          = b.py + b.vy * dt;
+        b.pz          = b.pz + b.vz * dt;
+    }
+};
+
+// Garder les boids dans le dôme
+struct DomeClamp : SteeringRule {
+    template<typename B>
+    static void apply(BoidBatch<B>& b)
+    {
+        const auto radius   = B::set1(b.args.domeRadius);
+        const auto distance = B::sqrt(b.px * b.px + b.py * b.py + b.pz * b.pz);
+        const auto outside  = gt(distance, radius);
+        b.px                = select(outside, b.px / distance * radius, b.px);
+        b.py                = select(outside, b.py / distance * radius, b.py);
+        b.pz                = select(outside, b.pz / distance * radius, b.pz);
+    }
+};
+
+// ---Passes---
+
+template<typename... Rules>
+struct RuleList {};
+
+// Règles du troupeau, dans l'ordre où elles modifient la vitesse puis la position
+using FlockRules = RuleList<Separation, InteractionCount, Alignment, Cohesion, MarkovCount, CameraAvoidance, SurveyorAvoidance, EulerStep, DomeClamp>;
+
+inline int clampCell(int c, int resolution)
+{
+    return c < 0 ? 0 : (c >= resolution ? resolution - 1 : c);
+}
+
+inline int cellCoord(float v, const GridView& grid)
+{
+    float scaled = (v - grid.origin) * grid.invCellSize;
+    int   c      = static_cast<int>(scaled);
+    if (scaled < static_cast<float>(c)) {
+        --c; // floor pour les valeurs négatives
+    }
+    return clampCell(c, grid.resolution);
+}
+
+// Pour chaque boid, parcourt les boids des rangées de cellules voisines (contiguës
+// dans l'ordre trié) par paquets de B::width, couche par couche, et les donne à toutes
+// les règles. Le boid lui-même est exclu par d² > 0 ; les couches de poids nul sont sautées.
+// Renvoie le nombre de paires candidates examinées (une addition par rangée).
+template<typename B, typename... Rules>
+std::uint64_t neighborPass(const NeighborPassArgs& a, RuleList<Rules...>)
+{
+    using F = typename B::F;
+
+    const F       zero       = B::set1(0.0f);
+    const int     res        = a.grid.resolution;
+    std::uint64_t candidates = 0;
+
+    for (std::size_t s = a.begin; s < a.end; ++s) {
+        const float xi = a.x[s], yi = a.y[s], zi = a.z[s];
+        const F     bx = B::set1(xi), by = B::set1(yi), bz = B::set1(zi);
+
+        std::tuple<typename Rules::template Sums<B>...> sums{typename Rules::template Sums<B>(a)...};
+
+        const int minX = cellCoord(xi - a.queryRadius, a.grid), maxX = cellCoord(xi + a.queryRadius, a.grid);
+        const int minY = cellCoord(yi - a.queryRadius, a.grid), maxY = cellCoord(yi + a.queryRadius, a.grid);
+        const int minZ = cellCoord(zi - a.queryRadius, a.grid), maxZ = cellCoord(zi + a.queryRadius, a.grid);
+
+        for (std::size_t species = 0; species < a.speciesCount; ++species) {
+            if (a.pairWeights[species] == 0.0f) {
+                continue;
+            }
+            const F           weight = B::set1(a.pairWeights[species]);
+            const std::size_t layer  = species * a.grid.layerCells;
+            for (int cz = minZ; cz <= maxZ; ++cz) {
+                for (int cy = minY; cy <= maxY; ++cy) {
+                    const std::size_t row   = layer + (static_cast<std::size_t>(cz) * res + cy) * res;
+                    const std::size_t begin = a.grid.cellStart[row + minX];
+                    const std::size_t end   = a.grid.cellStart[row + maxX + 1];
+                    candidates += end - begin;
+
+                    for (std::size_t j = begin; j < end; j += B::width) {
+                        const std::size_t n    = end - j;
+                        const bool        full = n >= static_cast<std::size_t>(B::width);
+                        auto load = [&](const float* p) { return full ? B::load(p + j) : B::loadPartial(p + j, n); };
+
+                        NeighborBatch<B> nb;
+                        nb.x = load(a.x), nb.y = load(a.y), nb.z = load(a.z);
+                        nb.vx = load(a.vx), nb.vy = load(a.vy), nb.vz = load(a.vz);
+                        nb.dx = nb.x - bx, nb.dy = nb.y - by, nb.dz = nb.z - bz;
+                        nb.d2     = nb.dx * nb.dx + nb.dy * nb.dy + nb.dz * nb.dz;
+                        nb.other  = B::laneMask(n) & gt(nb.d2, zero);
+                        nb.weight = weight;
+
+                        std::apply([&](auto&... rule) { (rule.add(nb), ...); }, sums);
+                    }
+                }
+            }
+        }
+
+        const std::uint32_t i = a.sortedIndices[s];
+        std::apply([&](const auto&... rule) { (rule.store(a, i), ...); }, sums);
+    }
+    return candidates;
+}
+
+// Applique les règles à B::width boids à la fois (dans l'ordre d'origine)
+template<typename B, typename... Rules>
+void integratePass(const IntegrateArgs& a, RuleList<Rules...>)
+{
+    for (std::size_t i = 0; i < a.count; i += B::width) {
+        BoidBatch<B> batch(a, i);
+        (Rules::apply(batch), ...);
+        batch.storeState();
+    }
+}
+
+} // namespace
@@ -0,0 +1,11 @@
+#include "steering_kernels.h"
+#include "steering_kernels_impl.h"
+
+namespace {
+const SteeringKernels scalarKernels{"Scalar", &accumulateNeighborsKernel<ScalarBatch>, &integrateKernel<ScalarBatch>};
+} // namespace
+
+const SteeringKernels* scalarSteeringKernels()
+{
+    return &scalarKernels;
+}
@@ -0,0 +1,22 @@
+#include "steering_kernels.h"
+#include "steering_kernels_impl.h"
+
+#if SIMD_HAS_SSE2
+
+namespace {
+const SteeringKernels sseKernels{"SSE2", &accumulateNeighborsKernel<SseBatch>, &integrateKernel<SseBatch>};
+} // namespace
+
+const SteeringKernels* sseSteeringKernels()
+{
+    return &sseKernels;
+}
+
+#else
+
+const SteeringKernels* sseSteeringKernels()
+{
+    return nullptr;
+}
+
+#endif
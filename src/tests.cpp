@@ -1,9 +1,1353 @@
 #include "doctest/doctest.h"
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asset_loader.h"
+#include "boid_pool.h"
+#include "bvh.h"
+#include "event_scheduler.h"
+#include "flock_simulator.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include "instance_buffer.h"
+#include "instance_transforms.h"
+#include "lod_selection.h"
+#include "mesh_cache.h"
+#include "p6/p6.h"
+#include "profiler.h"
+#include "random.h"
+#include "render_queue.h"
+#include "shader_program.h"
+#include "simulation_log.h"
+#include "snapshot_file.h"
+#include "spatial_grid.h"
+#include "sphere.h"
+#include "steering.h"
+#include "triple_buffer.h"
+
 // This is just an example of how to use Doctest in order to write tests.
 // To learn more about Doctest, see https://github.com/doctest/doctest/blob/master/doc/markdown/tutorial.md
 TEST_CASE("Addition is commutative")
 {
     CHECK(1 + 2 == 2 + 1);
     CHECK(4 + 7 == 7 + 4);
-}
\ No newline at end of file
+}
+
+TEST_CASE("SpatialGrid visits every neighbour found by brute force")
+{
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> coord(-2.0f, 2.0f);
+    std::vector<glm::vec3>                positions(500);
+    for (auto& p : positions) {
+        p = glm::vec3(coord(rng), coord(rng), coord(rng));
+    }
+
+    const float radius = 0.7f;
+    SpatialGrid grid;
+    grid.build(positions.size(), 2.0f, radius, [&](std::size_t i) { return positions[i]; });
+
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        std::set<std::uint32_t> candidates;
+        grid.forEachCandidate(positions[i], radius, [&](std::uint32_t j) { candidates.insert(j); });
+        for (std::size_t j = 0; j < positions.size(); ++j) {
+            if (glm::length(positions[j] - positions[i]) < radius) {
+                CHECK(candidates.count(static_cast<std::uint32_t>(j)) == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Every steering kernel matches the reference boid rules")
+{
+    std::mt19937                          rng(7);
+    std::uniform_real_distribution<float> coord(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> speed(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> weight(0.0f, 2.0f);
+    BoidSoA                               boids;
+    for (int i = 0; i < 301; ++i) {
+        Boid boid{};
+        boid.position = glm::vec3(coord(rng), coord(rng), coord(rng));
+        boid.velocity = glm::vec3(speed(rng), speed(rng), speed(rng));
+        if (i % 3 == 0) {
+            boid.separationWeight = weight(rng);
+            boid.alignmentWeight  = weight(rng);
+            boid.cohesionWeight   = weight(rng);
+        }
+        boids.pushBack(boid);
+    }
+
+    const float    separationDistance = 0.3f;
+    const float    interactionRadius  = 0.8f;
+    const float    markovRadius       = 1.0f;
+    SteeringParams params{0.1f, 0.1f, 0.2f, 0.2f, 2.0f, 0.016f, glm::vec3(0.0f, 1.0f, 2.0f), glm::vec3(0.0f, -2.75f, 1.0f)};
+
+    // Règles de référence, écrites boid par boid
+    BoidSoA            expected = boids;
+    std::vector<float> expectedMarkovCount(boids.size(), 0.0f);
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        glm::vec3 p = boids.position(i), v = boids.velocity(i);
+        glm::vec3 separation(0.0f), alignment(0.0f), cohesion(0.0f);
+        int       count = 0;
+        for (std::size_t j = 0; j < boids.size(); ++j) {
+            float distance = glm::length(boids.position(j) - p);
+            if (j == i) {
+                continue;
+            }
+            if (distance < separationDistance) {
+                separation -= glm::normalize(boids.position(j) - p) / distance;
+            }
+            if (distance < interactionRadius) {
+                alignment += boids.velocity(j);
+                cohesion += boids.position(j);
+                ++count;
+            }
+            if (distance < markovRadius) {
+                expectedMarkovCount[i] += 1.0f;
+            }
+        }
+        v += separation * boids.separationWeight[i];
+        if (count > 0) {
+            v += (alignment / static_cast<float>(count) - v) * params.alignmentWeight * boids.alignmentWeight[i];
+            glm::vec3 center = cohesion / static_cast<float>(count);
+            v += (center - p) / glm::length(center - p) * params.cohesionWeight * boids.cohesionWeight[i];
+        }
+        glm::vec3 toCamera = params.cameraPosition - p;
+        if (glm::length(toCamera) < params.distanceMinToCamera) {
+            v += glm::normalize(toCamera) * params.avoidanceWeight;
+        }
+        v += glm::normalize(p - params.surveyorPosition) * params.avoidanceWeight * params.deltaTime;
+        p += v * params.deltaTime;
+        if (glm::length(p) > params.domeRadius) {
+            p = glm::normalize(p) * params.domeRadius;
+        }
+        expected.setPosition(i, p);
+        expected.setVelocity(i, v);
+    }
+
+    for (const SteeringKernels* kernels : {scalarSteeringKernels(), sseSteeringKernels(), avx2SteeringKernels()}) {
+        if (kernels == nullptr || (kernels == avx2SteeringKernels() && &steeringKernels() != kernels)) {
+            continue; // Non compilé, ou non supporté par ce processeur
+        }
+        BoidSoA     actual = boids;
+        SpatialGrid grid;
+        SortedBoids sorted;
+        grid.build(actual.size(), 2.0f, interactionRadius, [&](std::size_t i) { return actual.position(i); });
+        sorted.resize(actual.size());
+        sorted.gather(actual, grid, 0, actual.size());
+
+        NeighborAccumulators sums(actual.size());
+        kernels->accumulateNeighbors(makeNeighborPassArgs(sorted, grid, separationDistance, interactionRadius, markovRadius, sums, 0, actual.size()));
+        kernels->integrate(makeIntegrateArgs(actual, actual.px.data(), actual.py.data(), actual.pz.data(), actual.vx.data(), actual.vy.data(), actual.vz.data(), sums, params, 0, actual.size()));
+
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            CHECK(glm::length(actual.position(i) - expected.position(i)) < 1e-3f);
+            CHECK(glm::length(actual.velocity(i) - expected.velocity(i)) < 1e-3f);
+            CHECK(sums.markovNeighborCount[i] == expectedMarkovCount[i]);
+        }
+    }
+}
+
+TEST_CASE("FlockSimulator gives the same result whatever the number of threads")
+{
+    auto simulate = [](unsigned threadCount) {
+        seedRandom(1234);
+        ThreadPool     pool(threadCount);
+        FlockSimulator simulator(pool);
+        simulator.params().separationDistance = 0.3f;
+        simulator.params().interactionRadius  = 0.5f;
+        for (int i = 0; i < 2000; ++i) {
+            Boid boid{};
+            boid.position   = glm::vec3(linearRand(-2.0f, 2.0f), linearRand(-2.0f, 2.0f), linearRand(-2.0f, 2.0f));
+            boid.velocity   = customSphericalRand(2.5f);
+            boid.markovTime = generateStateChangeTime(5);
+            simulator.spawn(boid);
+        }
+        for (int step = 0; step < 10; ++step) {
+            simulator.step(1.0f / 60.0f);
+        }
+        return simulator.boids();
+    };
+
+    BoidSoA single = simulate(1);
+    BoidSoA multi  = simulate(4);
+    CHECK(single.px == multi.px);
+    CHECK(single.py == multi.py);
+    CHECK(single.pz == multi.pz);
+    CHECK(single.vx == multi.vx);
+    CHECK(single.vy == multi.vy);
+    CHECK(single.vz == multi.vz);
+    CHECK(single.markovState == multi.markovState);
+    CHECK(single.markovTime == multi.markovTime);
+}
+
+TEST_CASE("FlockSimulator updates the Markov state of a boid only when its transition is due")
+{
+    seedRandom(99);
+    ThreadPool     pool(2);
+    FlockSimulator simulator(pool);
+    for (int i = 0; i < 500; ++i) {
+        Boid boid{};
+        boid.position    = glm::vec3(linearRand(-3.0f, 3.0f), linearRand(-3.0f, 3.0f), linearRand(-3.0f, 3.0f));
+        boid.velocity    = customSphericalRand(0.5f);
+        boid.markovState = 1;
+        boid.markovTime  = i % 2 == 0 ? 0.001f : 1000.0f; // Seuls les boids pairs changent d'état au premier pas
+        boid.lifespan    = 1000.0f;                       // Pas de réapparition pendant le test
+        simulator.spawn(boid);
+    }
+
+    // Les états sont calculés sur les positions du début du pas
+    const BoidSoA before = simulator.boids();
+    simulator.step(1.0f / 60.0f);
+    int cleared = 0;
+    for (std::size_t i = 0; i < before.size(); ++i) {
+        if (i % 2 != 0) {
+            CHECK(simulator.boids().markovState[i] == 1);
+            continue;
+        }
+        int count = 0;
+        for (std::size_t j = 0; j < before.size(); ++j) {
+            if (j != i && glm::distance(before.position(i), before.position(j)) < simulator.params().markovRadius) {
+                ++count;
+            }
+        }
+        CHECK(simulator.boids().markovState[i] == (count > simulator.params().markovThreshold ? 1 : 0));
+        cleared += simulator.boids().markovState[i] == 0 ? 1 : 0;
+    }
+    CHECK(cleared > 0);
+}
+
+TEST_CASE("EventScheduler hands out due events in time order")
+{
+    struct Event {
+        float time;
+        int   id;
+    };
+    std::mt19937                          rng(3);
+    std::uniform_real_distribution<float> time(0.0f, 10.0f);
+    EventScheduler<Event>                 scheduler;
+    for (int i = 0; i < 500; ++i) {
+        scheduler.push({time(rng), i});
+    }
+
+    std::vector<float> fired;
+    scheduler.popDue(5.0f, [&](const Event& event) {
+        fired.push_back(event.time);
+        if (event.id % 10 == 0) {
+            scheduler.push({event.time + 0.25f, -1}); // Encore échu si event.time <= 4.75
+        }
+    });
+    CHECK(std::is_sorted(fired.begin(), fired.end()));
+    CHECK(!fired.empty());
+    CHECK(fired.back() <= 5.0f);
+    REQUIRE(!scheduler.empty());
+    CHECK(scheduler.top().time > 5.0f);
+    CHECK(scheduler.popDue(20.0f, [](const Event&) {}) + fired.size() > 500);
+    CHECK(scheduler.empty());
+
+    // Après un retrait en masse, le tas rend encore les événements restants dans l'ordre
+    for (int i = 0; i < 500; ++i) {
+        scheduler.push({time(rng), i});
+    }
+    CHECK(scheduler.removeIf([](const Event& event) { return event.id % 3 != 0; }) == 333);
+    REQUIRE(scheduler.size() == 167);
+    fired.clear();
+    scheduler.popDue(10.0f, [&](const Event& event) {
+        CHECK(event.id % 3 == 0);
+        fired.push_back(event.time);
+    });
+    CHECK(fired.size() == 167);
+    CHECK(std::is_sorted(fired.begin(), fired.end()));
+}
+
+TEST_CASE("FlockSimulator respawns expired boids and drops the events of removed ones")
+{
+    ThreadPool     pool(1);
+    FlockSimulator simulator(pool);
+    simulator.setSeed(11);
+    for (int i = 0; i < 4; ++i) {
+        Boid boid{};
+        boid.position   = glm::vec3(0.1f * i, 0.0f, 0.0f);
+        boid.velocity   = glm::vec3(0.5f, 0.0f, 0.0f);
+        boid.isFemale   = true;
+        boid.markovTime = 1000.0f;
+        boid.lifespan   = i == 0 ? 0.05f : (i == 2 ? 0.3f : 1000.0f);
+        simulator.spawn(boid);
+    }
+
+    const float dt = 1.0f / 60.0f;
+    simulator.step(dt);
+    CHECK(simulator.boids().lifespan[0] == 0.05f);
+    while (simulator.time() < 0.1f) {
+        simulator.step(dt);
+    }
+    // Le boid 0 est réapparu avec une nouvelle durée de vie, les autres n'ont pas changé
+    CHECK(simulator.boids().lifespan[0] != 0.05f);
+    CHECK(simulator.boids().lifespan[1] == 1000.0f);
+
+    // Retirer le boid 2 avant sa fin de vie puis ajouter un boid, qui reprend son
+    // emplacement : la fin de vie programmée pour le mort ne doit pas le toucher
+    BoidHandle dead = simulator.flock().handleAt(2);
+    CHECK(simulator.kill(dead));
+    Boid late{};
+    late.markovTime = 0.1f;
+    late.lifespan   = 1000.0f;
+    double     arrival = simulator.time();
+    BoidHandle handle  = simulator.spawn(late);
+    CHECK(handle.slot == dead.slot);
+    std::size_t index = simulator.flock().indexOf(handle);
+    // Les délais d'un nouveau boid partent de son apparition
+    CHECK(simulator.boids().markovTime[index] == doctest::Approx(arrival + 0.1f));
+    while (simulator.time() < 0.4f) {
+        simulator.step(dt);
+    }
+    index = simulator.flock().indexOf(handle);
+    CHECK(simulator.boids().markovTime[index] > arrival + 0.1f);
+    CHECK(simulator.boids().lifespan[index] == 1000.0f);
+}
+
+TEST_CASE("FlockSimulator keeps the state from before its last step in an exchangeable buffer")
+{
+    ThreadPool     pool(2);
+    FlockSimulator simulator(pool);
+    simulator.setSeed(5);
+    simulator.params().meanLifespan = 0.05f; // Des fins de vie à presque chaque pas
+    for (int i = 0; i < 500; ++i) {
+        simulator.spawn(simulator.randomBoid(0.5f));
+    }
+
+    BoidStepBuffer before;
+    BoidStepBuffer exported;
+    for (int step = 0; step < 10; ++step) {
+        before.assign(simulator.boids());
+        simulator.step(1.0f / 60.0f);
+        BoidStepBuffer& previous = simulator.previousState();
+        CHECK(previous.px == before.px);
+        CHECK(previous.vz == before.vz);
+        CHECK(previous.markovState == before.markovState);
+        CHECK(previous.isFemale == before.isFemale);
+        // Comme SnapshotWriter::submit : un tampon quelconque prend sa place
+        previous.swap(exported);
+        CHECK(exported.px == before.px);
+    }
+}
+
+TEST_CASE("BoidPool keeps handles stable across swap removals and reuses slots")
+{
+    BoidPool pool;
+    pool.reserve(8);
+    std::vector<BoidHandle> handles;
+    for (int i = 0; i < 5; ++i) {
+        Boid boid{};
+        boid.position = glm::vec3(static_cast<float>(i), 0.0f, 0.0f);
+        handles.push_back(pool.spawn(boid));
+    }
+
+    CHECK(pool.kill(handles[1]));
+    CHECK_FALSE(pool.kill(handles[1]));
+    CHECK_FALSE(pool.alive(handles[1]));
+    CHECK(pool.size() == 4);
+    // Le dernier boid a pris la place du mort, sa poignée le suit
+    CHECK(pool.indexOf(handles[4]) == 1);
+    CHECK(pool.boids().px[pool.indexOf(handles[4])] == 4.0f);
+    for (int i : {0, 2, 3, 4}) {
+        CHECK(pool.boids().px[pool.indexOf(handles[i])] == static_cast<float>(i));
+        CHECK(pool.handleAt(pool.indexOf(handles[i])) == handles[i]);
+    }
+
+    // L'emplacement libéré est réutilisé avec une nouvelle génération
+    BoidHandle reborn = pool.spawn(Boid{});
+    CHECK(reborn.slot == handles[1].slot);
+    CHECK(reborn.generation != handles[1].generation);
+    CHECK_FALSE(pool.alive(handles[1]));
+    CHECK(pool.alive(reborn));
+}
+
+TEST_CASE("BoidPool keeps each species contiguous through random spawns and kills")
+{
+    BoidPool pool;
+    REQUIRE(pool.setSpeciesCount(3));
+    struct Alive {
+        BoidHandle    handle;
+        float         tag;
+        std::uint8_t  species;
+    };
+    std::vector<Alive> alive;
+    CounterRng         rng(5, 0);
+    for (int operation = 0; operation < 2000; ++operation) {
+        if (alive.empty() || rng.nextUint() % 3 != 0) {
+            Boid boid{};
+            boid.species    = static_cast<std::uint8_t>(rng.nextUint() % 3);
+            boid.position.x = static_cast<float>(operation);
+            alive.push_back({pool.spawn(boid), boid.position.x, boid.species});
+        } else {
+            std::size_t victim = rng.nextUint() % alive.size();
+            CHECK(pool.kill(alive[victim].handle));
+            alive[victim] = alive.back();
+            alive.pop_back();
+        }
+    }
+    CHECK_FALSE(pool.setSpeciesCount(2)); // Pas de changement tant qu'il reste des boids
+
+    REQUIRE(pool.size() == alive.size());
+    CHECK(pool.speciesBegin(0) == 0);
+    CHECK(pool.speciesEnd(2) == pool.size());
+    for (std::size_t species = 0; species < 3; ++species) {
+        CHECK(pool.speciesBegin(species) <= pool.speciesEnd(species));
+        for (std::size_t i = pool.speciesBegin(species); i < pool.speciesEnd(species); ++i) {
+            CHECK(pool.boids().species[i] == species);
+        }
+    }
+    for (const Alive& boid : alive) {
+        REQUIRE(pool.alive(boid.handle));
+        std::size_t index = pool.indexOf(boid.handle);
+        CHECK(pool.handleAt(index) == boid.handle);
+        CHECK(pool.boids().px[index] == boid.tag);
+        CHECK(pool.boids().species[index] == boid.species);
+    }
+}
+
+TEST_CASE("A species that ignores another moves exactly as if it were alone")
+{
+    auto boidAt = [](CounterRng& rng, std::uint8_t species) {
+        Boid boid{};
+        boid.position   = glm::vec3(rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f));
+        boid.velocity   = rng.onSphere(1.0f);
+        boid.markovTime = 1000.0f;
+        boid.lifespan   = 1000.0f;
+        boid.species    = species;
+        return boid;
+    };
+
+    ThreadPool     pool(2);
+    FlockSimulator alone(pool);
+    FlockSimulator ignoring(pool);
+    FlockSimulator coupled(pool);
+    SpeciesParams  other;
+    other.interactionRadius = 0.5f;
+    other.alignmentWeight   = 3.0f;
+    SpeciesTable species({SpeciesParams{}, other});
+    REQUIRE(coupled.setSpecies(species));
+    species.setInteraction(0, 1, 0.0f);
+    REQUIRE(ignoring.setSpecies(species));
+
+    CounterRng rngs[] = {CounterRng(3, 0), CounterRng(3, 0), CounterRng(3, 0)};
+    for (int i = 0; i < 300; ++i) {
+        alone.spawn(boidAt(rngs[0], 0));
+        ignoring.spawn(boidAt(rngs[1], 0));
+        coupled.spawn(boidAt(rngs[2], 0));
+    }
+    for (int i = 0; i < 300; ++i) {
+        ignoring.spawn(boidAt(rngs[1], 1));
+        coupled.spawn(boidAt(rngs[2], 1));
+    }
+
+    for (int step = 0; step < 30; ++step) {
+        for (FlockSimulator* simulator : {&alone, &ignoring, &coupled}) {
+            simulator->step(1.0f / 60.0f);
+        }
+    }
+    REQUIRE(ignoring.flock().speciesEnd(0) == alone.boids().size());
+    auto sameAsAlone = [&](const FlockSimulator& simulator) {
+        for (std::size_t i = 0; i < alone.boids().size(); ++i) {
+            if (alone.boids().position(i) != simulator.boids().position(i) || alone.boids().velocity(i) != simulator.boids().velocity(i)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    CHECK(sameAsAlone(ignoring));
+    CHECK_FALSE(sameAsAlone(coupled)); // Avec le poids par défaut, l'autre espèce compte
+}
+
+TEST_CASE("A recorded run replays to the same checksums and a divergence is caught")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "simulation_log_test.flocklog").string();
+
+    // Partie enregistrée comme par SimulationThread, avec des réglages qui changent en
+    // cours de route ; dropBoidAt retire un boid hors journal (résultat qui diverge)
+    auto record = [&](std::uint64_t dropBoidAt) {
+        ThreadPool         pool(2);
+        FlockSimulator     simulator(pool);
+        SimulationRecorder recorder;
+        simulator.setSeed(77);
+        REQUIRE(recorder.open(path, simulator, 10));
+
+        SimulationInputs inputs;
+        inputs.numBoids            = 300;
+        inputs.speedBoids          = 2.5f;
+        inputs.params.autoMode     = true;
+        inputs.params.meanLifespan = 0.5f;
+        for (std::uint64_t step = 0; step < 60; ++step) {
+            if (step == 20) {
+                inputs.numBoids                = 200;
+                inputs.params.alignmentWeight  = 0.4f;
+                inputs.params.surveyorPosition = glm::vec3(0.5f, -1.0f, 0.0f);
+            }
+            const float dt = step % 3 == 0 ? 1.0f / 50.0f : 1.0f / 60.0f;
+            recorder.recordStep(inputs, dt);
+            simulator.params() = inputs.params;
+            resizeFlock(simulator, inputs);
+            if (step == dropBoidAt) {
+                simulator.kill(simulator.flock().handleAt(0));
+            }
+            simulator.step(dt);
+            recorder.recordState(simulator);
+        }
+        CHECK(recorder.close());
+        return stateChecksum(simulator);
+    };
+
+    std::uint64_t recorded = record(ReplayResult::NO_DIVERGENCE);
+    CHECK(std::filesystem::file_size(path) < 60 * 5 + 6 * 17 + 2 * 21 * 4 + sizeof(SimulationLogHeader)); // En-tête, pas, empreintes et deux jeux d'entrées
+
+    for (unsigned threadCount : {1u, 4u}) {
+        SimulationLogReader reader;
+        REQUIRE(reader.open(path.c_str()));
+        CHECK(reader.header().seed == 77);
+        ThreadPool     pool(threadCount);
+        FlockSimulator simulator(pool);
+        ReplayResult   result = replaySimulation(reader, simulator);
+        CHECK(result.ok());
+        CHECK(result.steps == 60);
+        CHECK(result.checksums == 6);
+        CHECK(simulator.boids().size() == 200);
+        CHECK(stateChecksum(simulator) == recorded);
+    }
+
+    record(35);
+    {
+        SimulationLogReader reader;
+        REQUIRE(reader.open(path.c_str()));
+        ThreadPool     pool(2);
+        FlockSimulator simulator(pool);
+        ReplayResult   result = replaySimulation(reader, simulator);
+        CHECK_FALSE(result.ok());
+        CHECK(result.firstDivergence == 40);
+        CHECK(result.mismatches == 3);
+    }
+
+    // Journal coupé au milieu d'un enregistrement
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+    {
+        SimulationLogReader reader;
+        REQUIRE(reader.open(path.c_str()));
+        ThreadPool     pool(1);
+        FlockSimulator simulator(pool);
+        CHECK(replaySimulation(reader, simulator).truncated);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("LZ blocks round-trip compressible and incompressible data")
+{
+    CounterRng rng(5, 0);
+    for (std::size_t size : {std::size_t{0}, std::size_t{7}, std::size_t{100}, std::size_t{5000}, lz::MAX_BLOCK_SIZE}) {
+        for (int pattern = 0; pattern < 3; ++pattern) {
+            std::vector<std::uint8_t> data(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                data[i] = pattern == 0 ? static_cast<std::uint8_t>(rng.nextUint()) : pattern == 1 ? 0 : static_cast<std::uint8_t>(i % 13 < 4 ? rng.nextUint() : i % 7);
+            }
+            std::vector<std::uint8_t> compressed(lz::compressBound(size));
+            std::vector<std::uint8_t> decompressed(size);
+            std::size_t               compressedSize = lz::compress(data.data(), size, compressed.data(), compressed.size());
+            REQUIRE(compressedSize > 0);
+            CHECK(lz::decompress(compressed.data(), compressedSize, decompressed.data(), size));
+            CHECK(decompressed == data);
+            if (pattern == 1 && size > 100) {
+                CHECK(compressedSize < size / 50);
+            }
+        }
+    }
+}
+
+TEST_CASE("Snapshot files seek to any step and survive a missing index")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "snapshot_test.flocksnap").string();
+
+    // Troupeau en mouvement, dont une partie disparaît au pas 10 (image clé forcée)
+    CounterRng rng(3, 0);
+    BoidSoA    boids;
+    for (int i = 0; i < 20000; ++i) {
+        Boid boid{};
+        boid.position    = glm::vec3(rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f));
+        boid.velocity    = rng.onSphere(2.5f);
+        boid.isFemale    = i % 3 == 0;
+        boid.markovState = i % 5 == 0 ? 1 : 0;
+        boids.pushBack(boid);
+    }
+    std::vector<SnapshotFrame> expected(20);
+    {
+        SnapshotOptions options;
+        options.keyframeInterval = 4;
+        SnapshotWriter writer;
+        REQUIRE(writer.open(path, options));
+        for (std::uint64_t step = 0; step < expected.size(); ++step) {
+            if (step == 10) {
+                for (int i = 0; i < 3000; ++i) {
+                    boids.swapRemove(boids.size() - 1);
+                }
+            }
+            for (std::size_t i = 0; i < boids.size(); ++i) {
+                boids.px[i] += boids.vx[i] / 60.0f;
+                boids.markovState[i] ^= (i + step) % 7 == 0 ? 1 : 0;
+            }
+            expected[step].assign(step * 2, boids);
+            BoidStepBuffer state;
+            state.assign(boids);
+            REQUIRE(writer.submit(step * 2, state));
+            writer.flush();
+        }
+        CHECK(writer.close());
+        CHECK(writer.writtenFrames() == expected.size());
+        CHECK(writer.bytesWritten() < writer.rawBytes() / 2);
+    }
+
+    auto checkFrames = [&](SnapshotReader& reader, std::initializer_list<std::size_t> order) {
+        for (std::size_t index : order) {
+            const SnapshotFrame* frame = reader.read(index);
+            REQUIRE(frame != nullptr);
+            CHECK(frame->step == expected[index].step);
+            CHECK(frame->boidCount == expected[index].boidCount);
+            CHECK(frame->columns == expected[index].columns);
+        }
+    };
+    {
+        SnapshotReader reader;
+        REQUIRE(reader.open(path.c_str()));
+        CHECK(reader.indexed());
+        REQUIRE(reader.frameCount() == expected.size());
+        CHECK(reader.findStep(27) == 13);
+        CHECK(reader.findStep(26) == 13);
+        CHECK(reader.findStep(1000) == expected.size() - 1);
+        checkFrames(reader, {13, 2, 3, 19, 0, 11, 10, 14});
+    }
+
+    // Sans l'index (écriture interrompue), les frames complètes restent lisibles
+    const auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - sizeof(SnapshotFooter) - expected.size() * sizeof(SnapshotIndexEntry) - 100);
+    {
+        SnapshotReader reader;
+        REQUIRE(reader.open(path.c_str()));
+        CHECK_FALSE(reader.indexed());
+        CHECK(reader.frameCount() == expected.size() - 1);
+        checkFrames(reader, {17, 5});
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Philox matches the reference vectors and batch fills match single draws")
+{
+    const std::uint32_t counters[3][4] = {{0, 0, 0, 0}, {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+    const std::uint64_t keys[3]        = {0, 0xffffffffffffffffull, 0x299f31d0a4093822ull};
+    const std::uint32_t expected[3][4] = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+                                          {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+                                          {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+    for (int t = 0; t < 3; ++t) {
+        std::uint32_t out[4];
+        philox::block(counters[t], keys[t], out);
+        for (int w = 0; w < 4; ++w) {
+            CHECK(out[w] == expected[t][w]);
+        }
+    }
+
+    // Un remplissage par lots donne les tirages un par un, même commencé en milieu de bloc
+    CounterRng single(42, 7, 3);
+    CounterRng batch(42, 7, 3);
+    std::vector<float> values(101);
+    CHECK(batch.uniform(-1.0f, 2.0f) == single.uniform(-1.0f, 2.0f));
+    batch.fillUniform(values.data(), values.size(), -1.0f, 2.0f);
+    for (float value : values) {
+        CHECK(std::abs(value - single.uniform(-1.0f, 2.0f)) < 1e-6f);
+        CHECK(value >= -1.0f);
+        CHECK(value < 2.0f);
+    }
+    CHECK(batch.nextUint() == single.nextUint());
+
+    // Des tranches remplies séparément après seek() reproduisent le remplissage complet
+    std::vector<float> whole(1000), pieces(1000);
+    CounterRng(5, 1).fillUniform(whole.data(), whole.size());
+    const std::size_t  bounds[] = {0, 250, 333, 999, 1000};
+    for (std::size_t k = 0; k + 1 < std::size(bounds); ++k) {
+        CounterRng slice(5, 1);
+        slice.seek(bounds[k]);
+        slice.fillUniform(pieces.data() + bounds[k], bounds[k + 1] - bounds[k]);
+    }
+    CHECK(pieces == whole);
+
+    // Moyenne de la loi exponentielle et points sur la sphère
+    std::vector<float> durations(20000);
+    CounterRng(9, 2).fillExponential(durations.data(), durations.size(), 4.0f);
+    double mean = 0.0;
+    for (float duration : durations) {
+        mean += duration / static_cast<double>(durations.size());
+    }
+    CHECK(std::abs(mean - 0.25) < 0.01);
+
+    std::vector<float> x(64), y(64), z(64);
+    CounterRng(9, 3).fillOnSphere(x.data(), y.data(), z.data(), x.size(), 2.0f);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        CHECK(std::abs(glm::length(glm::vec3(x[i], y[i], z[i])) - 2.0f) < 1e-4f);
+    }
+}
+
+TEST_CASE("TripleBuffer always hands the reader the latest complete value")
+{
+    struct Pair {
+        int first  = 0;
+        int second = 0;
+    };
+    TripleBuffer<Pair> buffer;
+    CHECK_FALSE(buffer.hasNewData());
+
+    buffer.writeBuffer() = {1, 1};
+    buffer.publish();
+    buffer.writeBuffer() = {2, 2};
+    buffer.publish();
+    CHECK(buffer.hasNewData());
+    CHECK(buffer.read().first == 2);
+    CHECK_FALSE(buffer.hasNewData());
+    CHECK(buffer.read().first == 2);
+
+    // Écrivain et lecteur concurrents : jamais de valeur déchirée ni de retour en arrière
+    constexpr int count = 100000;
+    std::thread   writer([&] {
+        for (int i = 3; i <= count; ++i) {
+            buffer.writeBuffer() = {i, i};
+            buffer.publish();
+        }
+    });
+    int  last = 2;
+    bool consistent = true;
+    while (last < count) {
+        const Pair& value = buffer.read();
+        consistent = consistent && value.first == value.second && value.first >= last;
+        last = value.first;
+    }
+    writer.join();
+    CHECK(consistent);
+}
+
+TEST_CASE("InstanceData matches the matrices previously computed per ghost")
+{
+    glm::vec3    position(0.5f, -1.0f, 2.0f);
+    InstanceData instance = InstanceData::fromTranslationScale(position, 0.05f, glm::vec3(1.0f));
+
+    glm::mat4 expectedModel  = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(0.05f));
+    glm::mat3 expectedNormal = glm::transpose(glm::inverse(glm::mat3(expectedModel)));
+    for (int column = 0; column < 4; ++column) {
+        CHECK(glm::length(instance.modelMatrix[column] - expectedModel[column]) < 1e-5f);
+    }
+    for (int column = 0; column < 3; ++column) {
+        CHECK(glm::length(instance.normalMatrix[column] - expectedNormal[column]) < 1e-3f);
+    }
+
+    glm::mat3    rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f))));
+    InstanceData rotated  = InstanceData::fromTranslationRotationScale(position, rotation, 0.3f, glm::vec3(1.0f));
+    expectedModel         = glm::translate(glm::mat4(1.0f), position) * glm::mat4(rotation) * glm::scale(glm::mat4(1.0f), glm::vec3(0.3f));
+    expectedNormal        = glm::transpose(glm::inverse(glm::mat3(expectedModel)));
+    for (int column = 0; column < 4; ++column) {
+        CHECK(glm::length(rotated.modelMatrix[column] - expectedModel[column]) < 1e-5f);
+    }
+    for (int column = 0; column < 3; ++column) {
+        CHECK(glm::length(rotated.normalMatrix[column] - expectedNormal[column]) < 1e-4f);
+    }
+}
+
+TEST_CASE("Batched instance builder writes the same instances as fromTranslationScale")
+{
+    constexpr std::size_t      COUNT = 11; // Deux lots de quatre et un reste
+    std::vector<float>         x(COUNT), y(COUNT), z(COUNT);
+    std::vector<glm::vec3>     colors(COUNT);
+    std::vector<std::uint32_t> ids(COUNT);
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        x[i]      = static_cast<float>(i);
+        y[i]      = -2.0f * static_cast<float>(i);
+        z[i]      = 0.5f + static_cast<float>(i);
+        colors[i] = glm::vec3(1.0f, 0.1f * static_cast<float>(i), 0.5f);
+        ids[i]    = static_cast<std::uint32_t>((i * 7) % COUNT);
+    }
+
+    const std::uint32_t* orders[] = {nullptr, ids.data()};
+    for (const std::uint32_t* order : orders) {
+        std::vector<InstanceData> instances(COUNT);
+        buildTranslationScaleInstances({x.data(), y.data(), z.data()}, colors.data(), order, COUNT, 0.05f, instances.data());
+        for (std::size_t k = 0; k < COUNT; ++k) {
+            std::size_t  id       = order != nullptr ? order[k] : k;
+            InstanceData expected = InstanceData::fromTranslationScale(glm::vec3(x[id], y[id], z[id]), 0.05f, colors[id]);
+            CHECK(std::memcmp(&instances[k], &expected, sizeof(InstanceData)) == 0);
+        }
+    }
+}
+
+TEST_CASE("hashBytes carries every input bit into the low half of the hash")
+{
+    std::string         bytes(67, 'a'); // Huit mots et trois octets isolés
+    const std::uint64_t base = hashBytes(bytes);
+    for (std::size_t bit = 0; bit < bytes.size() * 8; ++bit) {
+        std::string flipped = bytes;
+        flipped[bit / 8]    = static_cast<char>(flipped[bit / 8] ^ (1 << (bit % 8)));
+        CHECK(((hashBytes(flipped) ^ base) & 0xffffffffu) != 0);
+    }
+}
+
+TEST_CASE("Mesh cache round-trips a parsed OBJ and rejects stale content")
+{
+    const char* obj = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                      "vt 0 0\nvt 1 1\nvn 0 0 1\n"
+                      "usemtl rouge\nf 1/1/1 2/1/1 3/2/1 4/2/1\n";
+    const char* mtl = "newmtl rouge\nKd 1 0 0\n";
+
+    MeshData mesh;
+    REQUIRE(parseObj(obj, mtl, mesh));
+    CHECK(mesh.vertices.size() == 4);
+    CHECK(mesh.indices.size() == 6); // Quadrilatère découpé en deux triangles
+    REQUIRE(mesh.materials.size() == 1);
+    CHECK(mesh.materials[0].indexCount == 6);
+    CHECK(mesh.boundsMax == glm::vec3(1.0f, 1.0f, 0.0f));
+    buildLodChain(mesh);
+    REQUIRE(mesh.lods.size() == 1); // Trop petit pour être simplifié
+
+    std::string   path = (std::filesystem::temp_directory_path() / "mesh_cache_test.meshcache").string();
+    std::uint64_t hash = meshSourceHash(obj, mtl);
+    REQUIRE(writeMeshCache(path, mesh, hash));
+
+    MeshView view;
+    {
+        MappedFile file(path.c_str());
+        REQUIRE(readMeshCache(file, hash, view));
+        CHECK(view.vertexCount == mesh.vertices.size());
+        CHECK(std::equal(mesh.indices.begin(), mesh.indices.end(), view.indices));
+        CHECK(view.vertices[2].position == mesh.vertices[2].position);
+        CHECK(view.materials[0].nameView() == "rouge");
+        CHECK(view.materials[0].diffuse == glm::vec3(1.0f, 0.0f, 0.0f));
+        REQUIRE(view.lodCount == 1);
+        CHECK(view.lod(0).indexCount == 6);
+        CHECK_FALSE(readMeshCache(file, meshSourceHash("v 0 0 0\n", mtl), view));
+    }
+
+    // Cache abîmé : un indice vers un sommet qui n'existe pas est refusé
+    MeshData corrupt = mesh;
+    corrupt.indices[4] = 4;
+    REQUIRE(writeMeshCache(path, corrupt, hash));
+    {
+        MappedFile file(path.c_str());
+        CHECK_FALSE(readMeshCache(file, hash, view));
+    }
+    corrupt = mesh;
+    corrupt.materials[0].indexCount = 7;
+    REQUIRE(writeMeshCache(path, corrupt, hash));
+    {
+        MappedFile file(path.c_str());
+        CHECK_FALSE(readMeshCache(file, hash, view));
+    }
+    std::filesystem::remove(path);
+
+    // Au chargement, le cache abîmé est remplacé par un cache valide
+    std::string objPath = (std::filesystem::temp_directory_path() / "mesh_cache_test.obj").string();
+    std::ofstream(objPath) << obj;
+    corrupt.indices[0] = 100;
+    REQUIRE(writeMeshCache(objPath + ".meshcache", corrupt, meshSourceHash(obj, "")));
+    {
+        LoadedMesh loaded;
+        REQUIRE(loaded.load(objPath.c_str(), ""));
+        CHECK_FALSE(loaded.fromCache());
+    }
+    {
+        LoadedMesh loaded;
+        REQUIRE(loaded.load(objPath.c_str(), ""));
+        CHECK(loaded.fromCache());
+        CHECK(loaded.view().indices[0] < loaded.view().vertexCount);
+    }
+    std::filesystem::remove(objPath);
+    std::filesystem::remove(objPath + ".meshcache");
+}
+
+TEST_CASE("OBJ parser handles every face form")
+{
+    MeshData mesh;
+
+    SUBCASE("v, v/vt, v//vn and v/vt/vn")
+    {
+        const char* obj = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.5 0.25\nvn 0 0 1\n"
+                          "f 1 2 3\nf 1/1 2/1 3/1\nf 1//1 2//1 3//1\nf 1/1/1 2/1/1 3/1/1\n";
+        REQUIRE(parseObj(obj, "", mesh));
+        CHECK(mesh.indices.size() == 12);
+        CHECK(mesh.vertices.size() == 12); // Quatre triplets différents par position
+        CHECK(mesh.vertices[mesh.indices[3]].texCoords == glm::vec2(0.5f, 0.25f));
+        CHECK(mesh.vertices[mesh.indices[6]].normal == glm::vec3(0.0f, 0.0f, 1.0f));
+        CHECK(mesh.vertices[mesh.indices[0]].normal == glm::vec3(0.0f));
+    }
+
+    SUBCASE("Negative indices are relative to the end")
+    {
+        const char* obj = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf -3//-1 -2//-1 -1//-1\n";
+        REQUIRE(parseObj(obj, "", mesh));
+        CHECK(mesh.indices == std::vector<std::uint32_t>{0, 1, 2});
+        CHECK(mesh.vertices[2].position == glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    SUBCASE("Polygons are fan-triangulated and shared corners deduplicated")
+    {
+        const char* obj = "v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0\r\nv -1 0.5 0\r\n"
+                          "f 1 2 3 4 5\r\nf 1 3 4\r\n";
+        REQUIRE(parseObj(obj, "", mesh));
+        CHECK(mesh.indices == std::vector<std::uint32_t>{0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 2, 3});
+        CHECK(mesh.vertices.size() == 5);
+        CHECK(mesh.vertices[4].position == glm::vec3(-1.0f, 0.5f, 0.0f));
+    }
+
+    SUBCASE("A short line never reads into the next one")
+    {
+        const char* obj = "v 1 2\nv 0 1 0\nv 1 1 1\nf 1 2\nf 1 2 3"; // Pas de fin de ligne finale
+        REQUIRE(parseObj(obj, "", mesh));
+        CHECK(mesh.indices == std::vector<std::uint32_t>{0, 1, 2});
+        CHECK(mesh.vertices[0].position == glm::vec3(1.0f, 2.0f, 0.0f));
+        CHECK(mesh.vertices[1].position == glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    SUBCASE("Malformed faces and comments are skipped")
+    {
+        const char* obj = "# commentaire\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 9\nf 1/x 2 3\nf 0 1 2\nf +1.5e0 2 3\n";
+        CHECK_FALSE(parseObj(obj, "", mesh));
+        CHECK(mesh.vertices.empty());
+    }
+
+    SUBCASE("Materials get contiguous index ranges")
+    {
+        const char* obj = "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+                          "usemtl a\nf 1 2 3\nusemtl b\nf 3 2 1\nusemtl a\nf 2 3 1\n";
+        const char* mtl = "newmtl a\nKd 0.5 1e-1 +1\nmap_Kd -s 2 2 1 texture a.png\nnewmtl b\n";
+        REQUIRE(parseObj(obj, mtl, mesh));
+        REQUIRE(mesh.materials.size() == 2);
+        CHECK(mesh.materials[0].firstIndex == 0);
+        CHECK(mesh.materials[0].indexCount == 6);
+        CHECK(mesh.materials[1].firstIndex == 6);
+        CHECK(mesh.materials[1].indexCount == 3);
+        CHECK(mesh.materials[0].diffuse == glm::vec3(0.5f, 0.1f, 1.0f));
+        CHECK(mesh.materials[0].textureScale == glm::vec3(2.0f, 2.0f, 1.0f));
+        CHECK(mesh.materials[0].texturePathView() == "texture a.png");
+    }
+}
+
+TEST_CASE("AssetLoader delivers every requested mesh, including failures")
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string           objPath   = (directory / "asset_loader_test.obj").string();
+    std::ofstream(objPath) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+
+    AssetLoader loader({{objPath, ""}, {(directory / "missing.obj").string(), ""}, {objPath, ""}}, 2);
+    std::vector<int> delivered(3, 0);
+    while (loader.remaining() > 0) {
+        loader.uploadReady(0.0, [&](const AssetLoader::LoadedAsset& asset) {
+            ++delivered[asset.id];
+            CHECK(asset.ok == (asset.id != 1));
+            if (asset.ok) {
+                CHECK(asset.mesh.view().indexCount == 3);
+            }
+        });
+        std::this_thread::yield();
+    }
+    CHECK(delivered == std::vector<int>{1, 1, 1});
+    // Le pool de chargement s'arrête de lui-même une fois les fichiers lus
+    while (loader.loading()) {
+        std::this_thread::yield();
+    }
+    std::filesystem::remove(objPath);
+    std::filesystem::remove(objPath + ".meshcache");
+}
+
+TEST_CASE("VertexAnimation shares the first frame topology and stores only moving vertices per frame")
+{
+    // Deuxième frame : sommets dans un autre ordre, celui en (0, 1, 0) déplacé et un sommet en plus
+    MeshData first;
+    MeshData second;
+    REQUIRE(parseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\n", "", first));
+    REQUIRE(parseObj("v 5 5 5\nv 1 0 0\nv 0 1.5 0\nv 0 0 0\nvn 0 0 1\nf 1//1 2//1 3//1\nf 4//1 2//1 3//1\n", "", second));
+    MeshView frames[] = {first.view(), second.view(), first.view()};
+
+    VertexAnimation animation;
+    REQUIRE(buildVertexAnimation(frames, 3, animation));
+    CHECK(animation.indices == first.indices);
+    CHECK(animation.vertexCount() == 3);
+    CHECK(animation.staticCount == 2);
+    CHECK(animation.movingCount == 1);
+    CHECK(animation.texels.size() == 2 + 3 * 1);
+
+    float     tolerance = glm::length(animation.boundsMax - animation.boundsMin) / 65535.0f;
+    glm::vec3 moved[]   = {glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, 1.5f, 0)};
+    for (std::size_t frame = 0; frame < 3; ++frame) {
+        for (std::size_t vertex = 0; vertex < 3; ++vertex) {
+            glm::vec3 position = frame == 1 ? moved[vertex] : first.vertices[vertex].position;
+            CHECK(glm::length(animation.position(vertex, frame) - position) <= tolerance);
+            CHECK(glm::dot(animation.normal(vertex, frame), glm::vec3(0.0f, 0.0f, 1.0f)) > 0.999f);
+        }
+    }
+
+    // Encodage octaédrique des normales, y compris dans l'hémisphère z < 0
+    for (glm::vec3 normal : {glm::vec3(1, 0, 0), glm::vec3(0, -1, 0), glm::vec3(0.3f, -0.5f, -0.8f), glm::vec3(-0.6f, 0.6f, 0.5f)}) {
+        normal = glm::normalize(normal);
+        CHECK(glm::dot(vat::decodeNormal(vat::encodeNormal(normal)), normal) > 0.999f);
+    }
+}
+
+TEST_CASE("AssetLoader builds an animation once all of its frames are loaded")
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string           frame1    = (directory / "asset_loader_frame1.obj").string();
+    std::string           frame2    = (directory / "asset_loader_frame2.obj").string();
+    std::ofstream(frame1) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    std::ofstream(frame2) << "v 0 0 0\nv 1 0 0\nv 0 2 0\nf 1 2 3\n";
+
+    AssetLoader loader({}, {{{{frame1, ""}, {frame2, ""}}}, {{{frame1, ""}, {(directory / "missing.obj").string(), ""}}}}, 2);
+    std::vector<int> delivered(2, 0);
+    while (loader.remaining() > 0) {
+        loader.uploadReady(0.0, [&](const AssetLoader::LoadedAsset& asset) {
+            ++delivered[asset.id];
+            CHECK(asset.ok == (asset.id == 0));
+            if (asset.ok) {
+                CHECK(asset.animation.frameCount == 2);
+                CHECK(asset.animation.movingCount == 1);
+            }
+        });
+        std::this_thread::yield();
+    }
+    CHECK(delivered == std::vector<int>{1, 1});
+    for (const std::string& path : {frame1, frame2}) {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".meshcache");
+    }
+}
+
+TEST_CASE("QEM simplification builds a valid LOD chain sharing the original vertices")
+{
+    // Sphère UV : triangles nombreux, arêtes de couture où les sommets sont dupliqués
+    MeshData mesh;
+    const int rings = 24, sectors = 48;
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= sectors; ++s) {
+            float     theta = glm::radians(180.0f * r / rings), phi = glm::radians(360.0f * s / sectors);
+            glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            mesh.vertices.push_back({normal, normal, glm::vec2(float(s) / sectors, float(r) / rings)});
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < sectors; ++s) {
+            std::uint32_t a = r * (sectors + 1) + s, b = a + sectors + 1;
+            for (std::uint32_t index : {a, a + 1, b, a + 1, b + 1, b}) {
+                mesh.indices.push_back(index);
+            }
+        }
+    }
+    mesh.computeBounds();
+    std::size_t fullCount = mesh.indices.size();
+
+    buildLodChain(mesh);
+    REQUIRE(mesh.lods.size() >= 4);
+    CHECK(mesh.lods[0].indexCount == fullCount);
+    for (std::size_t level = 1; level < mesh.lods.size(); ++level) {
+        const MeshLod& lod = mesh.lods[level];
+        CHECK(lod.indexCount <= mesh.lods[level - 1].indexCount / 2 + 3);
+        CHECK(lod.error >= mesh.lods[level - 1].error);
+        REQUIRE(lod.firstIndex + lod.indexCount <= mesh.indices.size());
+        for (std::uint32_t t = lod.firstIndex; t < lod.firstIndex + lod.indexCount; t += 3) {
+            const std::uint32_t* tri = &mesh.indices[t];
+            REQUIRE(std::max({tri[0], tri[1], tri[2]}) < mesh.vertices.size());
+            glm::vec3 a = mesh.vertices[tri[0]].position, b = mesh.vertices[tri[1]].position, c = mesh.vertices[tri[2]].position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            CHECK(glm::length(normal) > 0.0f);                     // Pas de triangle dégénéré
+            CHECK(glm::dot(normal, (a + b + c) / 3.0f) > 0.0f);  // Orienté vers l'extérieur, comme la sphère
+            CHECK(glm::length(a) == doctest::Approx(1.0f).epsilon(1e-5)); // Sommets d'origine
+        }
+    }
+    // Un tiers des triangles garde une sphère reconnaissable
+    CHECK(mesh.lods[2].error < 0.1f);
+}
+
+TEST_CASE("LodSelection coarsens distant instances and respects the triangle budget")
+{
+    std::vector<MeshLod> lods = {{0, 3000, 0.0f}, {3000, 1500, 0.01f}, {4500, 300, 0.1f}};
+    LodSelection         selection;
+    selection.pixelsPerUnit = 100.0f;
+    selection.pixelError    = 1.0f;
+
+    CHECK(selection.select(lods, 1.0f, 0.5f) == 0);  // 0.01 unité = 2 pixels
+    CHECK(selection.select(lods, 1.0f, 1.0f) == 1);  // 0.01 unité = 1 pixel
+    CHECK(selection.select(lods, 1.0f, 10.0f) == 2); // 0.1 unité = 1 pixel
+    CHECK(selection.select(lods, 2.0f, 10.0f) == 1); // Modèle deux fois plus grand
+
+    std::vector<float>        distances = {0.5f, 0.5f, 0.5f, 0.5f, 5.0f, 5.0f};
+    std::vector<std::uint8_t> levels;
+    FrameArena                arena;
+    auto                      distanceOf = [&](std::size_t i) { return distances[i]; };
+    selection.triangleBudget             = 100000;
+    CHECK(selection.selectInstances(lods, 1.0f, distances.size(), distanceOf, levels, arena) == 4 * 1000 + 2 * 500);
+    CHECK(levels == std::vector<std::uint8_t>{0, 0, 0, 0, 1, 1});
+
+    selection.triangleBudget = 2500;
+    std::size_t triangles    = selection.selectInstances(lods, 1.0f, distances.size(), distanceOf, levels, arena);
+    CHECK(triangles <= 2500);
+    CHECK(levels[0] >= levels[5] - 1); // Les plus proches ne sont pas plus grossiers que les plus lointains
+    CHECK(levels[4] == 2);
+
+    // 10 000 fantômes au budget par défaut : la chaîne du fantôme (45 312 triangles divisés
+    // par deux à chaque niveau) tient dans le budget une fois assez longue ; coupée à 1 416
+    // triangles, les plus lointains sont écartés plutôt que de dépasser le budget
+    LodSelection defaults;
+    defaults.pixelsPerUnit = 100.0f;
+    std::vector<MeshLod> ghostLods;
+    for (std::uint32_t level = 0, triangles = 45312; level < 10; ++level, triangles /= 2) {
+        ghostLods.push_back({0, triangles * 3, 0.001f * static_cast<float>(1u << level)});
+    }
+    std::vector<float> crowd(10000);
+    for (std::size_t i = 0; i < crowd.size(); ++i) {
+        crowd[i] = 1.0f + 0.01f * static_cast<float>(i);
+    }
+    auto crowdDistance = [&](std::size_t i) { return crowd[i]; };
+    CHECK(defaults.selectInstances(ghostLods, 0.05f, crowd.size(), crowdDistance, levels, arena) <= defaults.triangleBudget);
+    CHECK(std::count(levels.begin(), levels.end(), LodSelection::SKIPPED) == 0);
+
+    ghostLods.resize(6);
+    CHECK(defaults.selectInstances(ghostLods, 0.05f, crowd.size(), crowdDistance, levels, arena) <= defaults.triangleBudget);
+    auto firstSkipped = std::find(levels.begin(), levels.end(), LodSelection::SKIPPED);
+    REQUIRE(firstSkipped != levels.end());
+    CHECK(std::all_of(firstSkipped, levels.end(), [](std::uint8_t level) { return level == LodSelection::SKIPPED; })); // Les plus lointains
+    CHECK(static_cast<std::size_t>(firstSkipped - levels.begin()) == defaults.triangleBudget / 1416);
+}
+
+TEST_CASE("Sphere is indexed, each vertex stored once")
+{
+    Sphere sphere(2.0f, 32, 16);
+    CHECK(sphere.getVertexCount() == 33 * 17);
+    REQUIRE(sphere.getIndexCount() == 32 * 16 * 6);
+    for (GLsizei i = 0; i < sphere.getIndexCount(); ++i) {
+        REQUIRE(sphere.getIndexPointer()[i] < static_cast<GLuint>(sphere.getVertexCount()));
+    }
+    for (GLsizei i = 0; i < sphere.getVertexCount(); ++i) {
+        CHECK(glm::length(sphere.getDataPointer()[i].position) == doctest::Approx(2.0f));
+    }
+    // Premier quadrilatère de la bande du pôle sud : (i, i + 1, i + discLat + 2), (i, i + discLat + 2, i + discLat + 1)
+    std::vector<GLuint> firstQuad(sphere.getIndexPointer(), sphere.getIndexPointer() + 6);
+    CHECK(firstQuad == std::vector<GLuint>{0, 1, 34, 0, 34, 33});
+}
+
+TEST_CASE("Uniform names hash the same at compile time and at link-time reflection")
+{
+    static_assert("uModelMatrix"_uniform == uniformId("uModelMatrix"));
+    // Le nom relevé à l'exécution (glGetActiveUniform) donne le même identifiant
+    std::string reflected = "uModelMatrix";
+    CHECK(uniformId(reflected) == "uModelMatrix"_uniform);
+
+    // Aucune collision entre les uniformes des shaders du projet
+    std::set<UniformId> ids{"uModelMatrix"_uniform, "uColor"_uniform, "boidPosition"_uniform, "uDomeColor"_uniform,
+                            "uAnimationTexels"_uniform, "uFrameCount"_uniform, "uStaticCount"_uniform, "uMovingCount"_uniform,
+                            "uBoundsMin"_uniform, "uBoundsExtent"_uniform, "uElapsedTime"_uniform, "uAnimationDuration"_uniform,
+                            "Camera"_uniform};
+    CHECK(ids.size() == 13);
+}
+
+namespace {
+struct FakeProgram {
+    GLuint name;
+    GLuint id() const { return name; }
+};
+
+// Backend sans OpenGL : note chaque commande soumise
+struct RecordingBackend {
+    std::vector<std::string> commands;
+
+    void setBlend(bool enabled) { commands.push_back(enabled ? "blend on" : "blend off"); }
+    void useProgram(const FakeProgram& program) { commands.push_back("program " + std::to_string(program.id())); }
+    void bindVertexArray(GLuint vao) { commands.push_back("vao " + std::to_string(vao)); }
+    void bindTexture(GLenum, GLuint texture) { commands.push_back("texture " + std::to_string(texture)); }
+    void setObjectUniforms(const FakeProgram&, const glm::mat4&, const glm::vec4& color) { commands.push_back("uniforms " + std::to_string(color.r)); }
+    void draw(const DrawPacket<FakeProgram>& packet)
+    {
+        commands.push_back("draw " + std::to_string(packet.firstIndex) + (packet.instanceCount > 0 ? " x" + std::to_string(packet.instanceCount) : ""));
+    }
+};
+} // namespace
+
+TEST_CASE("RenderQueue sorts opaque packets by state, then transparent ones back to front, skipping redundant binds")
+{
+    FakeProgram plain{1};
+    FakeProgram instanced{2};
+    auto packet = [](const FakeProgram& program, GLuint vao, float depth, GLuint firstIndex) {
+        DrawPacket<FakeProgram> p;
+        p.program    = &program;
+        p.vao        = vao;
+        p.depth      = depth;
+        p.firstIndex = firstIndex;
+        p.indexCount = 3;
+        return p;
+    };
+
+    RenderQueue<FakeProgram> queue;
+    auto dome        = packet(plain, 7, 1.0f, 100);
+    dome.transparent = true;
+    dome.hasObjectUniforms = true;
+    dome.color = glm::vec4(0.0f, 0.0f, 1.0f, 0.5f);
+    queue.push(dome); // Transparent enregistré en premier : dessiné en dernier
+    queue.push(packet(plain, 3, 5.0f, 10));
+    auto ghosts          = packet(instanced, 4, 2.0f, 20);
+    ghosts.instanceCount = 8;
+    queue.push(ghosts);
+    auto farGlass        = packet(plain, 7, 3.0f, 200);
+    farGlass.transparent = true;
+    queue.push(farGlass);
+    auto surveyor              = packet(plain, 3, 1.0f, 30);
+    surveyor.hasObjectUniforms = true;
+    surveyor.color             = glm::vec4(1.0f);
+    queue.push(surveyor);
+    auto animated          = packet(plain, 3, 0.5f, 40);
+    animated.textureTarget = GL_TEXTURE_BUFFER;
+    animated.texture       = 9;
+    queue.push(animated);
+
+    RecordingBackend backend;
+    queue.submit(backend);
+    CHECK(backend.commands == std::vector<std::string>{
+                                  "blend off", "program 1", "vao 3", "texture 0",
+                                  "uniforms 1.000000", "draw 30", "draw 10", // Même état : de l'avant vers l'arrière
+                                  "texture 9", "draw 40",
+                                  "program 2", "vao 4", "texture 0", "draw 20 x8",
+                                  "blend on", "program 1", "vao 7", "draw 200", // Le plus lointain d'abord
+                                  "uniforms 0.000000", "draw 100",
+                                  "blend off", "vao 0"});
+    CHECK(queue.size() == 0);
+
+    // Une file vide ne touche à aucun état
+    RecordingBackend idle;
+    queue.submit(idle);
+    CHECK(idle.commands.empty());
+}
+
+TEST_CASE("BVH culling finds exactly the spheres a brute-force frustum test keeps, after refits and rebuilds")
+{
+    // Pyramide en forme de boîte : |x| <= 2, |y| <= 1, |z| <= 1
+    glm::mat4 viewProjection(1.0f);
+    viewProjection[0][0] = 0.5f;
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+    CHECK(frustum.intersectsSphere(glm::vec3(1.9f, 0.0f, 0.0f), 0.0f));
+    CHECK_FALSE(frustum.intersectsSphere(glm::vec3(2.2f, 0.0f, 0.0f), 0.1f));
+    CHECK(frustum.intersectsSphere(glm::vec3(2.2f, 0.0f, 0.0f), 0.3f));
+    CHECK(frustum.classifyBox(glm::vec3(-0.5f), glm::vec3(0.5f)) == Frustum::Containment::Inside);
+    CHECK(frustum.classifyBox(glm::vec3(0.5f), glm::vec3(1.5f)) == Frustum::Containment::Intersects);
+    CHECK(frustum.classifyBox(glm::vec3(3.0f), glm::vec3(4.0f)) == Frustum::Containment::Outside);
+
+    std::mt19937                          rng(7);
+    std::uniform_real_distribution<float> coord(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 0.2f);
+    std::vector<glm::vec4>                spheres(3001); // Pas un multiple de 4 : la fin des feuilles passe par le test scalaire
+    for (glm::vec4& sphere : spheres) {
+        sphere = glm::vec4(coord(rng), coord(rng), coord(rng), radius(rng));
+    }
+
+    auto bruteForce = [&]() {
+        std::vector<std::uint32_t> visible;
+        for (std::uint32_t i = 0; i < spheres.size(); ++i) {
+            if (frustum.intersectsSphere(glm::vec3(spheres[i]), spheres[i].w)) {
+                visible.push_back(i);
+            }
+        }
+        return visible;
+    };
+    auto culled = [&](const BoundingVolumeHierarchy& hierarchy) {
+        std::vector<std::uint32_t> visible;
+        hierarchy.cull(frustum, visible);
+        std::sort(visible.begin(), visible.end());
+        return visible;
+    };
+
+    BoundingVolumeHierarchy hierarchy;
+    hierarchy.update(spheres);
+    REQUIRE(hierarchy.size() == spheres.size());
+    std::vector<std::uint32_t> expected = bruteForce();
+    CHECK(!expected.empty());
+    CHECK(expected.size() < spheres.size() / 2);
+    CHECK(culled(hierarchy) == expected);
+
+    // Petits déplacements : l'arbre est seulement réajusté
+    std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+    for (int frame = 0; frame < 5; ++frame) {
+        for (glm::vec4& sphere : spheres) {
+            sphere += glm::vec4(step(rng), step(rng), step(rng), 0.0f);
+        }
+        hierarchy.update(spheres);
+        CHECK(culled(hierarchy) == bruteForce());
+    }
+
+    // Objets mélangés : l'arbre dégradé est remplacé au fil des appels, et le découpage
+    // reste exact pendant la construction du nouveau
+    std::shuffle(spheres.begin(), spheres.end(), rng);
+    hierarchy.update(spheres);
+    CHECK(hierarchy.rebuilding());
+    CHECK(culled(hierarchy) == bruteForce());
+    int updates = 0;
+    while (hierarchy.rebuilding() && updates < 64) {
+        for (glm::vec4& sphere : spheres) {
+            sphere += glm::vec4(step(rng), step(rng), step(rng), 0.0f);
+        }
+        hierarchy.update(spheres);
+        CHECK(culled(hierarchy) == bruteForce());
+        ++updates;
+    }
+    CHECK(updates > 1);
+    CHECK_FALSE(hierarchy.rebuilding());
+
+    // Changement du nombre d'objets : reconstruction
+    spheres.resize(17);
+    hierarchy.update(spheres);
+    CHECK(hierarchy.size() == 17);
+    CHECK(culled(hierarchy) == bruteForce());
+}
+
+TEST_CASE("Profiler records nested scopes per thread and exports a Chrome trace")
+{
+    Profiler& instance = profiler();
+    std::int64_t from = instance.now();
+    {
+        PROFILE_SCOPE("Ignored while disabled");
+    }
+
+    instance.setEnabled(true);
+    {
+        PROFILE_SCOPE("Outer");
+        {
+            PROFILE_SCOPE("Inner");
+        }
+    }
+    std::thread worker([] {
+        profiler().setThreadName("Test worker");
+        PROFILE_SCOPE("Worker scope");
+    });
+    worker.join();
+    instance.setEnabled(false);
+    std::int64_t to = instance.now() + 1;
+
+    std::vector<std::string> names;
+    for (const Profiler::ThreadEvents& thread : instance.collect(from, to)) {
+        for (const ProfileEvent& event : thread.events) {
+            names.push_back(thread.name + "/" + event.name + "@" + std::to_string(event.depth));
+            CHECK(event.start <= event.end);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    REQUIRE(names.size() == 3);
+    CHECK(names[0] == "Test worker/Worker scope@0");
+    CHECK(names[1].ends_with("/Inner@1"));
+    CHECK(names[2].ends_with("/Outer@0"));
+    CHECK(Profiler::threadDepth() == 0);
+
+    std::ostringstream trace;
+    instance.writeChromeTrace(trace);
+    CHECK(trace.str().starts_with("{\"traceEvents\":["));
+    CHECK(trace.str().find("\"name\":\"Worker scope\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(trace.str().find("\"args\":{\"name\":\"Test worker\"}") != std::string::npos);
+}
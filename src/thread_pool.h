@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool de threads à vol de tâches : chaque thread a sa propre file de tranches de
+// travail, dépile les siennes par la fin et vole celles des autres par le début
+// quand il n'a plus rien à faire. Le thread appelant de parallelFor participe aussi.
+class ThreadPool {
+public:
+    // threadCount inclut le thread appelant : 1 signifie tout exécuter sur place
+    explicit ThreadPool(unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned i = 0; i < threadCount; ++i) {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (unsigned i = 1; i < threadCount; ++i) {
+            m_threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(m_queues.size()); }
+
+    // Appelle fn(begin, end) sur des tranches d'au plus grainSize éléments couvrant
+    // [0, count), puis attend que toutes soient terminées
+    template<typename Fn>
+    void parallelFor(std::size_t count, std::size_t grainSize, Fn&& fn)
+    {
+        if (count == 0) {
+            return;
+        }
+        grainSize = std::max<std::size_t>(1, grainSize);
+        std::size_t chunks = (count + grainSize - 1) / grainSize;
+        if (chunks == 1 || threadCount() == 1) {
+            fn(std::size_t{0}, count);
+            return;
+        }
+
+        std::atomic<std::size_t> remaining{chunks};
+        Task                     task{};
+        task.run = [](void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<std::remove_reference_t<Fn>*>(context))(begin, end);
+        };
+        task.context   = &fn;
+        task.remaining = &remaining;
+
+        // Répartir les tranches entre les files (le thread appelant utilise la file 0)
+        for (std::size_t c = 0; c < chunks; ++c) {
+            task.begin = c * grainSize;
+            task.end   = std::min(count, task.begin + grainSize);
+            if (!m_queues[c % threadCount()]->push(task)) {
+                runTask(task); // File pleine : exécuter sur place
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        // Participer jusqu'à ce que toutes les tranches soient prises, puis attendre
+        // celles qui sont encore en cours sur les autres threads : quelques tours actifs
+        // pour les tranches courtes, puis endormi jusqu'à la fin d'une dernière tranche
+        Task     next;
+        unsigned idle = 0;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (findTask(0, next)) {
+                runTask(next);
+                idle = 0;
+            }
+            else if (++idle < SPIN_COUNT) {
+                std::this_thread::yield();
+            }
+            else {
+                // Lu avant de revérifier remaining : une fin survenue entre-temps l'a changé
+                // et wait rend la main aussitôt
+                std::uint32_t completed = m_completed.load(std::memory_order_acquire);
+                if (remaining.load(std::memory_order_acquire) > 0) {
+                    m_completed.wait(completed, std::memory_order_acquire);
+                }
+            }
+        }
+    }
+
+private:
+    struct Task {
+        void (*run)(void* context, std::size_t begin, std::size_t end);
+        void*                     context;
+        std::size_t               begin;
+        std::size_t               end;
+        std::atomic<std::size_t>* remaining;
+    };
+
+    // File circulaire de capacité fixe : aucune allocation pendant parallelFor
+    struct WorkQueue {
+        static constexpr std::size_t CAPACITY = 4096;
+
+        std::mutex        mutex;
+        std::vector<Task> tasks = std::vector<Task>(CAPACITY);
+        std::size_t       head  = 0; // Prochaine tâche à voler
+        std::size_t       size  = 0;
+
+        bool push(const Task& task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size == CAPACITY) {
+                return false;
+            }
+            tasks[(head + size) % CAPACITY] = task;
+            ++size;
+            return true;
+        }
+
+        // Le propriétaire prend la tâche la plus récente
+        bool popBack(Task& task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size == 0) {
+                return false;
+            }
+            --size;
+            task = tasks[(head + size) % CAPACITY];
+            return true;
+        }
+
+        // Les voleurs prennent la plus ancienne
+        bool stealFront(Task& task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size == 0) {
+                return false;
+            }
+            task = tasks[head];
+            head = (head + 1) % CAPACITY;
+            --size;
+            return true;
+        }
+    };
+
+    // Tours d'attente active de parallelFor avant de s'endormir
+    static constexpr unsigned SPIN_COUNT = 64;
+
+    void runTask(const Task& task)
+    {
+        task.run(task.context, task.begin, task.end);
+        // Après la dernière tranche, l'appelant peut rendre la main et détruire remaining :
+        // le réveil passe par m_completed, qui appartient au pool
+        if (task.remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_completed.fetch_add(1, std::memory_order_release);
+            m_completed.notify_all();
+        }
+    }
+
+    bool findTask(unsigned self, Task& task)
+    {
+        if (m_queues[self]->popBack(task)) {
+            return true;
+        }
+        for (unsigned k = 1; k < threadCount(); ++k) {
+            if (m_queues[(self + k) % threadCount()]->stealFront(task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned self)
+    {
+        std::size_t seenGeneration = 0;
+        Task        task;
+        while (true) {
+            while (findTask(self, task)) {
+                runTask(task);
+            }
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread>                m_threads;
+
+    std::mutex              m_wakeMutex;
+    std::condition_variable m_wake;
+    std::size_t             m_generation = 0;
+    bool                    m_stop       = false;
+
+    std::atomic<std::uint32_t> m_completed{0}; // Appels de parallelFor dont la dernière tranche est finie
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+
+// Triple tampon sans verrou entre un unique écrivain et un unique lecteur.
+// L'écrivain remplit writeBuffer() puis publish() ; le lecteur obtient avec read()
+// le dernier tampon publié. Aucun des deux n'attend jamais l'autre : les tampons
+// publiés mais pas encore lus sont simplement remplacés par les plus récents.
+template<typename T>
+class TripleBuffer {
+public:
+    // Tampon réservé à l'écrivain
+    T& writeBuffer() { return m_buffers[m_writeIndex]; }
+
+    // Rend le tampon d'écriture visible pour le lecteur et en récupère un libre
+    void publish()
+    {
+        int previous = m_middle.exchange(m_writeIndex | NEW_DATA, std::memory_order_acq_rel);
+        m_writeIndex = previous & INDEX_MASK;
+    }
+
+    // Le lecteur a-t-il un tampon plus récent à récupérer ?
+    bool hasNewData() const { return (m_middle.load(std::memory_order_acquire) & NEW_DATA) != 0; }
+
+    // Dernier tampon publié, réservé au lecteur jusqu'au prochain appel
+    const T& read()
+    {
+        if (hasNewData()) {
+            int previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+            m_readIndex  = previous & INDEX_MASK;
+        }
+        return m_buffers[m_readIndex];
+    }
+
+private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int NEW_DATA   = 0x4;
+
+    T                m_buffers[3]{};
+    std::atomic<int> m_middle{1}; // Indice du tampon intermédiaire, et drapeau NEW_DATA
+    int              m_writeIndex = 0;
+    int              m_readIndex  = 2;
+};
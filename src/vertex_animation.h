@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "glm/glm.hpp"
+#include "mesh.h"
+#include "spatial_grid.h"
+
+// Animation par sommets (vertex animation texture). Toutes les frames partagent la
+// topologie de la première : indices (avec ses niveaux de détail), matériaux et
+// coordonnées de texture ne sont stockés qu'une fois. Chaque sommet reçoit un emplacement dans la texture
+// d'animation : les sommets immobiles n'y ont qu'un texel, ceux qui bougent en ont un
+// par frame. Un texel tient sur 4 x 16 bits : la position quantifiée dans la boîte
+// englobante de l'animation et la normale en encodage octaédrique (2 x 8 bits).
+struct VertexAnimation {
+    // Texel de la texture d'animation
+    struct Texel {
+        std::uint16_t x, y, z;
+        std::uint16_t normal;
+    };
+
+    std::vector<std::uint32_t> indices; // Tous les niveaux de détail de la première frame
+    std::vector<MeshMaterial>  materials;
+    std::vector<MeshLod>       lods;
+    std::vector<glm::vec2>     texCoords; // Par sommet
+    std::vector<std::uint32_t> slots;     // Par sommet : emplacement dans la texture (voir texelIndex)
+    std::vector<Texel>         texels;    // Sommets immobiles, puis frame par frame les sommets animés
+    std::size_t                frameCount  = 0;
+    std::size_t                staticCount = 0; // Sommets immobiles (les premiers emplacements)
+    std::size_t                movingCount = 0; // Sommets animés (texels par frame)
+    glm::vec3                  boundsMin{0.0f};
+    glm::vec3                  boundsMax{0.0f};
+
+    std::size_t vertexCount() const { return slots.size(); }
+
+    // Indice du texel d'un emplacement pour une frame (même calcul que le vertex shader)
+    std::size_t texelIndex(std::uint32_t slot, std::size_t frame) const
+    {
+        return slot < staticCount ? slot : staticCount + frame * movingCount + (slot - staticCount);
+    }
+
+    glm::vec3 position(std::size_t vertex, std::size_t frame) const;
+    glm::vec3 normal(std::size_t vertex, std::size_t frame) const;
+
+    // Mémoire occupée par les données envoyées au GPU
+    std::size_t byteSize() const
+    {
+        return indices.size() * sizeof(std::uint32_t) + texCoords.size() * sizeof(glm::vec2)
+               + slots.size() * sizeof(std::uint32_t) + texels.size() * sizeof(Texel);
+    }
+};
+
+namespace vat {
+
+inline std::uint16_t quantize(float value, float min, float extent)
+{
+    float t = extent > 0.0f ? (value - min) / extent : 0.0f;
+    return static_cast<std::uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline float dequantize(std::uint16_t value, float min, float extent)
+{
+    return min + static_cast<float>(value) / 65535.0f * extent;
+}
+
+// Encodage octaédrique sur 8 bits par composante (x dans l'octet de poids fort)
+inline std::uint16_t encodeNormal(glm::vec3 n)
+{
+    float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (sum == 0.0f) {
+        n = glm::vec3(0.0f, 0.0f, 1.0f);
+        sum = 1.0f;
+    }
+    float x = n.x / sum;
+    float y = n.y / sum;
+    if (n.z < 0.0f) {
+        float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    auto toByte = [](float v) {
+        return static_cast<std::uint16_t>(std::lround((std::clamp(v, -1.0f, 1.0f) * 0.5f + 0.5f) * 255.0f));
+    };
+    return static_cast<std::uint16_t>(toByte(x) << 8 | toByte(y));
+}
+
+inline glm::vec3 decodeNormal(std::uint16_t packed)
+{
+    float     x = static_cast<float>(packed >> 8) / 127.5f - 1.0f;
+    float     y = static_cast<float>(packed & 0xFF) / 127.5f - 1.0f;
+    glm::vec3 n(x, y, 1.0f - std::abs(x) - std::abs(y));
+    if (n.z < 0.0f) {
+        n.x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        n.y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return glm::normalize(n);
+}
+
+// Pour chaque sommet de `reference`, indice du sommet de `frame` le plus proche ;
+// à égalité de position (arêtes vives), celui dont la normale est la plus proche.
+inline std::vector<std::uint32_t> matchVertices(const MeshView& reference, const MeshView& frame)
+{
+    std::vector<std::uint32_t> matches(reference.vertexCount, 0);
+    if (frame.vertexCount == 0) {
+        return matches;
+    }
+
+    glm::vec3 extent     = glm::max(glm::abs(frame.boundsMin), glm::abs(frame.boundsMax));
+    float     halfExtent = std::max({extent.x, extent.y, extent.z, 1e-3f}) * 1.001f;
+    float     cellSize   = 2.0f * halfExtent / SpatialGrid::MAX_RESOLUTION;
+    SpatialGrid grid;
+    grid.build(frame.vertexCount, halfExtent, cellSize, [&](std::size_t i) { return frame.vertices[i].position; });
+
+    constexpr float SAME_POSITION = 1e-10f; // Écart² en dessous duquel deux positions sont confondues
+    for (std::size_t i = 0; i < reference.vertexCount; ++i) {
+        const MeshVertex& vertex = reference.vertices[i];
+        float             bestDistance2 = std::numeric_limits<float>::max();
+        float             bestAlignment = -2.0f;
+        // Rayon doublé jusqu'à trouver un sommet dans la boule explorée
+        for (float radius = cellSize * 0.5f; bestDistance2 > radius * radius; radius *= 2.0f) {
+            grid.forEachCandidate(vertex.position, radius, [&](std::uint32_t j) {
+                glm::vec3 offset    = frame.vertices[j].position - vertex.position;
+                float     distance2 = glm::dot(offset, offset);
+                float     alignment = glm::dot(frame.vertices[j].normal, vertex.normal);
+                if (distance2 < bestDistance2 - SAME_POSITION
+                    || (distance2 <= bestDistance2 + SAME_POSITION && alignment > bestAlignment)) {
+                    bestDistance2 = std::min(bestDistance2, distance2);
+                    bestAlignment = alignment;
+                    matches[i]    = j;
+                }
+            });
+            if (radius > 4.0f * halfExtent) {
+                break;
+            }
+        }
+    }
+    return matches;
+}
+
+} // namespace vat
+
+inline glm::vec3 VertexAnimation::position(std::size_t vertex, std::size_t frame) const
+{
+    const Texel& texel  = texels[texelIndex(slots[vertex], frame)];
+    glm::vec3    extent = boundsMax - boundsMin;
+    return {vat::dequantize(texel.x, boundsMin.x, extent.x), vat::dequantize(texel.y, boundsMin.y, extent.y),
+            vat::dequantize(texel.z, boundsMin.z, extent.z)};
+}
+
+inline glm::vec3 VertexAnimation::normal(std::size_t vertex, std::size_t frame) const
+{
+    return vat::decodeNormal(texels[texelIndex(slots[vertex], frame)].normal);
+}
+
+// Construit l'animation à partir de ses frames. Les frames exportées n'ayant pas toutes
+// la même topologie, chaque sommet de la première frame suit, dans les suivantes, le
+// sommet le plus proche (voir vat::matchVertices). Renvoie false sans frame.
+inline bool buildVertexAnimation(const MeshView* frames, std::size_t frameCount, VertexAnimation& animation)
+{
+    animation = VertexAnimation{};
+    if (frameCount == 0 || frames[0].vertexCount == 0) {
+        return false;
+    }
+    const MeshView& reference   = frames[0];
+    std::size_t     vertexCount = reference.vertexCount;
+
+    animation.frameCount = frameCount;
+    animation.indices.assign(reference.indices, reference.indices + reference.indexCount);
+    animation.materials.assign(reference.materials, reference.materials + reference.materialCount);
+    animation.lods.assign(reference.lods, reference.lods + reference.lodCount);
+    animation.texCoords.resize(vertexCount);
+    for (std::size_t i = 0; i < vertexCount; ++i) {
+        animation.texCoords[i] = reference.vertices[i].texCoords;
+    }
+
+    // Sommet suivi par chaque sommet de référence, frame par frame
+    std::vector<std::vector<std::uint32_t>> matches(frameCount);
+    animation.boundsMin = reference.boundsMin;
+    animation.boundsMax = reference.boundsMax;
+    for (std::size_t f = 1; f < frameCount; ++f) {
+        matches[f] = vat::matchVertices(reference, frames[f]);
+        animation.boundsMin = glm::min(animation.boundsMin, frames[f].boundsMin);
+        animation.boundsMax = glm::max(animation.boundsMax, frames[f].boundsMax);
+    }
+    auto vertexAt = [&](std::size_t vertex, std::size_t frame) -> const MeshVertex& {
+        return frame == 0 ? reference.vertices[vertex] : frames[frame].vertices[matches[frame][vertex]];
+    };
+
+    glm::vec3 extent = animation.boundsMax - animation.boundsMin;
+    auto      encode = [&](const MeshVertex& vertex) {
+        return VertexAnimation::Texel{vat::quantize(vertex.position.x, animation.boundsMin.x, extent.x),
+                                      vat::quantize(vertex.position.y, animation.boundsMin.y, extent.y),
+                                      vat::quantize(vertex.position.z, animation.boundsMin.z, extent.z),
+                                      vat::encodeNormal(vertex.normal)};
+    };
+    auto sameTexel = [](const VertexAnimation::Texel& a, const VertexAnimation::Texel& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z && a.normal == b.normal;
+    };
+
+    // Un sommet est immobile si son texel est identique dans toutes les frames
+    std::vector<std::uint32_t> moving;
+    std::vector<std::uint32_t> still;
+    for (std::size_t i = 0; i < vertexCount; ++i) {
+        VertexAnimation::Texel first = encode(reference.vertices[i]);
+        bool                   moves = false;
+        for (std::size_t f = 1; f < frameCount && !moves; ++f) {
+            moves = !sameTexel(first, encode(vertexAt(i, f)));
+        }
+        (moves ? moving : still).push_back(static_cast<std::uint32_t>(i));
+    }
+
+    animation.staticCount = still.size();
+    animation.movingCount = moving.size();
+    animation.slots.resize(vertexCount);
+    animation.texels.reserve(still.size() + frameCount * moving.size());
+    for (std::size_t s = 0; s < still.size(); ++s) {
+        animation.slots[still[s]] = static_cast<std::uint32_t>(s);
+        animation.texels.push_back(encode(reference.vertices[still[s]]));
+    }
+    for (std::size_t m = 0; m < moving.size(); ++m) {
+        animation.slots[moving[m]] = static_cast<std::uint32_t>(still.size() + m);
+    }
+    for (std::size_t f = 0; f < frameCount; ++f) {
+        for (std::uint32_t vertex : moving) {
+            animation.texels.push_back(encode(vertexAt(vertex, f)));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#include "heap_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Seul dans son fichier : le compilateur ne voit pas ces remplacements depuis le code qui
+// alloue, et ne les apparie pas aux new et delete de la bibliothèque standard.
+namespace {
+std::atomic<std::size_t> allocations{0};
+}
+
+std::size_t heapAllocations()
+{
+    return allocations.load();
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* data = std::malloc(size == 0 ? 1 : size)) {
+        return data;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete[](void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, std::size_t) noexcept
+{
+    std::free(data);
+}
+
+void operator delete[](void* data, std::size_t) noexcept
+{
+    std::free(data);
+}
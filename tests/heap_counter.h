@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+// Nombre d'appels à operator new depuis le début du programme. Le remplacement global
+// d'operator new (heap_counter.cpp) n'est lié qu'aux tests d'allocation, jamais à
+// l'application.
+std::size_t heapAllocations();
@@ -0,0 +1,106 @@
+// Tests d'allocation sur le tas : un exécutable à part (heap_tests), parce qu'ils comptent
+// les appels à operator new en le remplaçant pour tout le programme
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include <span>
+#include <vector>
+#include "flock_simulator.h"
+#include "frame_arena.h"
+#include "heap_counter.h"
+#include "profiler.h"
+#include "random.h"
+#include "thread_pool.h"
+
+TEST_CASE("Steady-state simulation steps, spawns, kills and frame arenas do not touch the heap")
+{
+    ThreadPool     threads(2);
+    FlockSimulator simulator(threads);
+    simulator.setSeed(3);
+    simulator.params().autoMode = true;
+    simulator.reserve(3000);
+    seedRandom(5);
+    auto makeBoid = [] {
+        Boid boid{};
+        boid.position   = glm::vec3(linearRand(-2.0f, 2.0f), linearRand(-2.0f, 2.0f), linearRand(-2.0f, 2.0f));
+        boid.velocity   = customSphericalRand(1.0f);
+        boid.markovTime = generateStateChangeTime(5);
+        boid.lifespan   = generateExp(1.0f);
+        return boid;
+    };
+    for (int i = 0; i < 2000; ++i) {
+        simulator.spawn(makeBoid());
+    }
+    FrameArena arena(1024);
+    auto frame = [&] {
+        arena.reset();
+        std::span<float> scratch = arena.allocate<float>(simulator.boids().size());
+        scratch[0] = 1.0f;
+        simulator.step(1.0f / 60.0f);
+    };
+    // Échauffement : tampons de travail, file d'événements et arène à leur taille de régime
+    for (int step = 0; step < 30; ++step) {
+        frame();
+    }
+
+    std::size_t before = heapAllocations();
+    for (int step = 0; step < 30; ++step) {
+        frame();
+        // Naissances et morts dans la place réservée
+        simulator.kill(simulator.flock().handleAt(static_cast<std::size_t>(step) * 7 % simulator.boids().size()));
+        simulator.spawn(makeBoid());
+    }
+    std::size_t allocations = heapAllocations() - before;
+    CHECK(allocations == 0);
+    CHECK(arena.capacity() >= 2000 * sizeof(float));
+}
+
+TEST_CASE("Collecting the profiler events every frame reuses the caller's buffers")
+{
+    Profiler instance;
+    instance.setThreadName("Render");
+    std::vector<Profiler::ThreadEvents> threads;
+    auto frame = [&] {
+        std::int64_t from = instance.now();
+        for (int scope = 0; scope < 20; ++scope) {
+            instance.record("Scope", instance.now(), instance.now(), 0);
+        }
+        instance.collect(from, instance.now() + 1, threads);
+    };
+    frame();
+
+    std::size_t before = heapAllocations();
+    for (int i = 0; i < 10; ++i) {
+        frame();
+    }
+    CHECK(heapAllocations() - before == 0);
+    REQUIRE(threads.size() == 1);
+    CHECK(threads[0].name == "Render");
+    CHECK(threads[0].events.size() == 20);
+}
+
+TEST_CASE("Spawn and kill cycles without steps keep the event queue within its reservation")
+{
+    ThreadPool     threads(1);
+    FlockSimulator simulator(threads);
+    simulator.setSeed(9);
+    simulator.reserve(500);
+    for (int i = 0; i < 500; ++i) {
+        simulator.spawn(simulator.randomBoid(1.0f));
+    }
+
+    // Sans pas de simulation, les événements des morts ne sont jamais dépilés : seul le
+    // compactage de la file les retire
+    std::size_t before = heapAllocations();
+    for (int cycle = 0; cycle < 20; ++cycle) {
+        while (simulator.boids().size() > 0) {
+            simulator.kill(simulator.flock().handleAt(simulator.boids().size() - 1));
+        }
+        for (int i = 0; i < 500; ++i) {
+            simulator.spawn(simulator.randomBoid(1.0f));
+        }
+    }
+    CHECK(heapAllocations() - before == 0);
+    simulator.step(1.0f / 60.0f);
+    CHECK(simulator.boids().size() == 500);
+}